@@ -54,6 +54,12 @@ static int arduino_parseextparms(const PROGRAMMER *pgm, const LISTID extparms) {
       continue;
     }
 
+    if(stk500_parse_pipeline(pgm, extended_param, &rv)) {
+      if(rv < 0)
+        break;
+      continue;
+    }
+
     if(str_eq(extended_param, "help")) {
       help = true;
       rv = LIBAVRDUDE_EXIT;
@@ -64,9 +70,10 @@ static int arduino_parseextparms(const PROGRAMMER *pgm, const LISTID extparms) {
       rv = -1;
     }
     msg_error("%s -c %s extended options:\n", progname, pgmid);
-    msg_error("  -x attempts=<n> Specify the number <n> of connection retry attempts\n");
-    msg_error("  -x noautoreset  Don't toggle RTS/DTR lines on port open to prevent a hardware reset\n");
-    msg_error("  -x help         Show this help menu and exit\n");
+    msg_error("  -x attempts=<n>   Specify the number <n> of connection retry attempts\n");
+    msg_error("  -x noautoreset    Don't toggle RTS/DTR lines on port open to prevent a hardware reset\n");
+    msg_error("  -x pipeline[=<n>] Stream up to <n> paged r/w requests before reading responses\n");
+    msg_error("  -x help           Show this help menu and exit\n");
     return rv;
   }
   return rv;
@@ -33,7 +33,7 @@
 
 #include "tpi.h"
 
-FP_UpdateProgress update_progress;
+LIBAVRDUDE_TLS FP_UpdateProgress update_progress;
 
 // TPI: returns nonzero if NVM controller busy, 0 if free
 int avr_tpi_poll_nvmbsy(const PROGRAMMER *pgm) {
@@ -348,7 +348,7 @@ ok:
 /*
  * Read the entirety of the specified memory into the corresponding buffer of
  * the avrpart pointed to by p. If v is non-NULL, verify against v's memory
- * area, only those cells that are tagged TAG_ALLOCATED are verified.
+ * area, only those cells that are tagged as allocated are verified.
  *
  * Return the number of bytes read, or < 0 if an error occurs.
  */
@@ -394,7 +394,7 @@ int avr_read_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, con
 
     // Load bytes
     for(lastaddr = i = 0; i < (unsigned long) mem->size; i++) {
-      if(vmem == NULL || (vmem->tags[i] & TAG_ALLOCATED) != 0) {
+      if(vmem == NULL || avr_tag_get(vmem, i)) {
         if(lastaddr != i) {
           // Need to setup new address
           avr_tpi_setup_rw(pgm, mem, i, TPI_NVMCMD_NO_OPERATION);
@@ -422,40 +422,33 @@ int avr_read_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, con
   if((pgm->paged_load && mem->page_size > 1 && mem->size%mem->page_size == 0) ||
     (is_spm(pgm) && avr_has_paged_access(pgm, p, mem))) {
     // The programmer supports a paged mode read
-    int need_read, failure;
-    unsigned int pageaddr;
+    int failure;
+    unsigned int pageaddr, nbytes;
     unsigned int npages, nread;
+    unsigned int maxbytes = avr_burst_pages(pgm, mem)*mem->page_size;
 
     // Quickly scan number of pages to be written to first
-    for(pageaddr = 0, npages = 0; pageaddr < (unsigned int) mem->size; pageaddr += mem->page_size) {
-      // Check whether this page must be read
-      for(i = pageaddr; i < pageaddr + mem->page_size; i++) {
-        // No verify: read everything; verify: only read needed pages in input file
-        if(vmem == NULL || (mem->tags[i] & TAG_ALLOCATED) != 0) {
-          npages++;
-          break;
-        }
-      }
-    }
+    for(pageaddr = 0, npages = 0; pageaddr < (unsigned int) mem->size; pageaddr += mem->page_size)
+      // No verify: read everything; verify: only read needed pages in input file
+      if(vmem == NULL || avr_tag_any(vmem, pageaddr, mem->page_size))
+        npages++;
 
     for(pageaddr = 0, failure = 0, nread = 0;
       !failure && pageaddr < (unsigned int) mem->size; pageaddr += mem->page_size) {
 
-      // Check whether this page must be read
-      for(i = pageaddr, need_read = 0; i < pageaddr + mem->page_size; i++) {
-        // No verify: read everything; verify: only read needed pages in input file
-        if(vmem == NULL || (vmem->tags[i] & TAG_ALLOCATED) != 0) {
-          need_read = 1;
-          break;
-        }
-      }
-      if(need_read) {
-        rc = pgm->paged_load(pgm, p, mem, mem->page_size, pageaddr, mem->page_size);
+      // Check whether this page must be read; no verify: read everything; verify: only needed pages
+      if(vmem == NULL || avr_tag_any(vmem, pageaddr, mem->page_size)) {
+        // Read adjacent pages that are needed, too, in one go if the programmer can
+        for(nbytes = mem->page_size; nbytes < maxbytes && pageaddr + nbytes < (unsigned int) mem->size &&
+          (vmem == NULL || avr_tag_any(vmem, pageaddr + nbytes, mem->page_size)); nbytes += mem->page_size)
+          continue;
+        rc = pgm->paged_load(pgm, p, mem, mem->page_size, pageaddr, nbytes);
         if(rc < 0)
           // Paged load failed, fall back to byte-at-a-time read below
           failure = 1;
-        nread++;
+        nread += nbytes/mem->page_size;
         report_progress(nread, npages, NULL);
+        pageaddr += nbytes - mem->page_size;
       } else {
         pmsg_debug("%s(): skipping page %u: no interesting data\n", __func__, pageaddr/mem->page_size);
       }
@@ -479,7 +472,7 @@ int avr_read_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, con
   }
 
   for(i = 0; i < (unsigned long) mem->size; i++) {
-    if(vmem == NULL || (vmem->tags[i] & TAG_ALLOCATED) != 0) {
+    if(vmem == NULL || avr_tag_get(vmem, i)) {
       rc = pgm->read_byte(pgm, p, mem, i, mem->buf + i);
       if(rc != LIBAVRDUDE_SUCCESS) {
         pmsg_error("unable to read byte at address 0x%04lx\n", i);
@@ -604,11 +597,20 @@ double avr_timestamp() {
 void init_cx(PROGRAMMER *pgm) {
   if(pgm)
     pgm->flag = 0;              // Clear out remnants of previous session(s)
-  mmt_free(cx);
+  free_cx();
   cx = mmt_malloc(sizeof *cx);  // Allocate and initialise context structure
   (void) avr_ustimestamp();     // Base timestamps from program start
 }
 
+// Free the context pointer cx and what it owns, eg, when a thread ends
+void free_cx(void) {
+  if(cx) {
+    opcode_zap_tables();
+    mmt_free(cx);
+    cx = NULL;
+  }
+}
+
 int avr_read_byte_silent(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
   unsigned long addr, unsigned char *datap) {
 
@@ -905,10 +907,79 @@ int avr_write_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
   return pgm->write_byte(pgm, p, mem, addr, data);
 }
 
+// Is reading a page back much cheaper than writing it, eg, for bootloaders, UPDI, PDI and JTAG?
+static int is_readback_cheap(const PROGRAMMER *pgm, const AVRPART *p) {
+  return is_spm(pgm) || (pgm->prog_modes & p->prog_modes & (PM_UPDI | PM_PDI | PM_JTAG | PM_JTAGmkI | PM_XMEGAJTAG));
+}
+
+/*
+ * Differential programming: untag pages of the memory copy cm below cwsize
+ * that need not be written, ie, all-0xff flash pages if flash is known to be
+ * erased, and otherwise, if reading is cheap, pages that are already on the
+ * device. Decisions are made per effective page of pgsize bytes, ie, the
+ * group of pages that bootloaders erase together on n_page_erase parts, so
+ * that a group is either written in full or not at all. Returns the number of
+ * pages untagged.
+ */
+static int untag_unchanged_pages(const PROGRAMMER *pgm, const AVRPART *p, AVRMEM *cm, int cwsize,
+  int pgsize, int erased) {
+
+  int nskip = 0, pgsz = cm->page_size;
+
+  if(erased) {
+    for(int pageaddr = 0; pageaddr < cwsize; pageaddr += pgsize)
+      if(avr_tag_any(cm, pageaddr, pgsize) && is_memset(cm->buf + pageaddr, 0xff, pgsize)) {
+        pmsg_debug("%s(): skipping page %u: erased\n", __func__, pageaddr/pgsz);
+        avr_tag_range(cm, pageaddr, pgsize, 0);
+        nskip += pgsize/pgsz;
+      }
+    return nskip;
+  }
+
+  if(!is_readback_cheap(pgm, p))
+    return 0;
+
+  // Each paged_load() call reads at most burst bytes, a run of effective pages maxbytes
+  int burst = avr_burst_pages(pgm, cm)*pgsz, maxbytes = burst < pgsize? pgsize: burst/pgsize*pgsize;
+
+  if(maxbytes > cwsize)
+    maxbytes = cwsize;
+  unsigned char *save = mmt_malloc(maxbytes);
+
+  for(int pageaddr = 0, nbytes; pageaddr < cwsize; pageaddr += nbytes) {
+    nbytes = pgsize;
+    if(!avr_tag_any(cm, pageaddr, pgsize))
+      continue;
+    // Read adjacent effective pages to be written, too, in one go if the programmer can
+    while(nbytes < maxbytes && pageaddr + nbytes < cwsize && avr_tag_any(cm, pageaddr + nbytes, pgsize))
+      nbytes += pgsize;
+
+    // The programmer reads into cm->buf: keep the input pages meanwhile
+    memcpy(save, cm->buf + pageaddr, nbytes);
+    int rc = 0;
+
+    for(int n = 0; rc >= 0 && n < nbytes; n += burst)
+      rc = pgm->paged_load(pgm, p, cm, pgsz, pageaddr + n, nbytes - n < burst? nbytes - n: burst);
+
+    for(int n = 0; rc >= 0 && n < nbytes; n += pgsize)
+      if(!memcmp(save + n, cm->buf + pageaddr + n, pgsize)) {
+        pmsg_debug("%s(): skipping page %u: unchanged\n", __func__, (pageaddr + n)/pgsz);
+        avr_tag_range(cm, pageaddr + n, pgsize, 0);
+        nskip += pgsize/pgsz;
+      }
+    memcpy(cm->buf + pageaddr, save, nbytes);
+    if(rc < 0)                  // Cannot read back: write all remaining pages
+      break;
+  }
+  mmt_free(save);
+
+  return nskip;
+}
+
 /*
  * Write the whole memory region of the specified memory from its buffer of the
  * avrpart pointed to by p to the device.  Write up to size bytes from the
- * buffer.  Data is only written if the corresponding tags byte is set. Data
+ * buffer.  Data is only written if the corresponding tag bit is set. Data
  * beyond size bytes are not affected.
  *
  * Return the number of bytes written, or LIBAVRDUDE_GENERAL_FAILURE on error.
@@ -951,9 +1022,15 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
     return wsize;
   }
 
+  // Once written to, flash is no longer known to be erased
+  int erased = cx->avr_erased && mem_is_in_flash(m);
+
+  if(mem_is_in_flash(m))
+    cx->avr_erased = 0;
+
   if(is_tpi(p) && m->page_size > 1 && pgm->cmd_tpi) {
     unsigned int chunk;         // Number of words for each write command
-    unsigned int j, writeable_chunk;
+    unsigned int j;
 
     if(wsize == 1) {
       // Fuse (configuration) memory: only single byte to write
@@ -991,11 +1068,7 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
     // Write words in chunks, low byte first
     for(lastaddr = i = 0; i < (unsigned int) wsize; i += chunk) {
       // Check that at least one byte in this chunk is allocated
-      for(writeable_chunk = j = 0; !writeable_chunk && j < chunk; j++) {
-        writeable_chunk = m->tags[i + j] & TAG_ALLOCATED;
-      }
-
-      if(writeable_chunk) {
+      if(avr_tag_any(m, i, chunk)) {
         if(lastaddr != i) {
           // Need to setup new address
           avr_tpi_setup_rw(pgm, m, i, TPI_NVMCMD_WORD_WRITE);
@@ -1028,8 +1101,8 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
     (is_spm(pgm) && avr_has_paged_access(pgm, p, m))) {
 
     // The programmer supports a paged mode write
-    int need_write, failure, nset;
-    unsigned int pageaddr;
+    int failure;
+    unsigned int pageaddr, nbytes;
     unsigned int npages, nwritten;
 
     /*
@@ -1062,33 +1135,26 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
     }
 
     uint8_t *spc = mmt_malloc(cm->page_size);
+    unsigned int maxbytes = avr_burst_pages(pgm, cm)*cm->page_size;
 
     // Set cwsize as rounded-up wsize
     int cwsize = (wsize + pgsize - 1)/pgsize*pgsize;
 
     for(pageaddr = 0; pageaddr < (unsigned int) cwsize; pageaddr += pgsize) {
-      for(i = pageaddr, nset = 0; i < pageaddr + pgsize; i++)
-        if(cm->tags[i] & TAG_ALLOCATED)
-          nset++;
-
-      if(nset && nset != pgsize) {      // Effective page has holes
+      if(avr_tag_any(cm, pageaddr, pgsize) && !avr_tag_all(cm, pageaddr, pgsize)) {   // Effective page has holes
         for(int np = 0; np < pgsize/cm->page_size; np++) {    // Page by page
           unsigned int beg = pageaddr + np*cm->page_size;
           unsigned int end = beg + cm->page_size;
 
-          for(i = beg; i < end; i++)
-            if(!(cm->tags[i] & TAG_ALLOCATED))
-              break;
-
-          if(i >= end)          // Memory page has no holes
+          if(avr_tag_all(cm, beg, cm->page_size))      // Memory page has no holes
             continue;
 
           // Read flash contents to separate memory spc and fill in holes
           if(avr_read_page_default(pgm, p, cm, beg, spc) >= 0) {
             pmsg_debug("padding %s [0x%04x, 0x%04x]\n", cm->desc, beg, end - 1);
             for(i = beg; i < end; i++)
-              if(!(cm->tags[i] & TAG_ALLOCATED)) {
-                cm->tags[i] |= TAG_ALLOCATED;
+              if(!avr_tag_get(cm, i)) {
+                avr_tag_set(cm, i);
                 cm->buf[i] = spc[i - beg];
               }
           } else {
@@ -1098,36 +1164,39 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
       }
     }
 
-    // Quickly scan number of pages to be written to
-    for(pageaddr = 0, npages = 0; pageaddr < (unsigned int) cwsize; pageaddr += cm->page_size) {
-      for(i = pageaddr; i < pageaddr + cm->page_size; i++)
-        if(cm->tags[i] & TAG_ALLOCATED) {
-          npages++;
-          break;
-        }
+    if(cx->avr_diffprog) {
+      int nskip = untag_unchanged_pages(pgm, p, cm, cwsize, pgsize, erased);
+
+      if(nskip)
+        pmsg_notice("differential programming skips %d %s page%s\n", nskip, cm->desc, str_plural(nskip));
     }
 
+    // Quickly scan number of pages to be written to
+    for(pageaddr = 0, npages = 0; pageaddr < (unsigned int) cwsize; pageaddr += cm->page_size)
+      if(avr_tag_any(cm, pageaddr, cm->page_size))
+        npages++;
+
     for(pageaddr = 0, failure = 0, nwritten = 0;
       !failure && pageaddr < (unsigned int) cwsize; pageaddr += cm->page_size) {
 
       // Check whether this page must be written to
-      for(i = pageaddr, need_write = 0; i < pageaddr + cm->page_size; i++)
-        if((cm->tags[i] & TAG_ALLOCATED) != 0) {
-          need_write = 1;
-          break;
-        }
-
-      if(need_write) {
+      if(avr_tag_any(cm, pageaddr, cm->page_size)) {
         int rc = 0;
 
+        // Write adjacent pages that need writing, too, in one go if the programmer can
+        for(nbytes = cm->page_size; nbytes < maxbytes && pageaddr + nbytes < (unsigned int) cwsize &&
+          avr_tag_any(cm, pageaddr + nbytes, cm->page_size); nbytes += cm->page_size)
+          continue;
         if(auto_erase && pgm->page_erase)
-          rc = pgm->page_erase(pgm, p, cm, pageaddr);
+          for(unsigned int n = 0; rc >= 0 && n < nbytes; n += cm->page_size)
+            rc = pgm->page_erase(pgm, p, cm, pageaddr + n);
         if(rc >= 0)
-          rc = pgm->paged_write(pgm, p, cm, cm->page_size, pageaddr, cm->page_size);
+          rc = pgm->paged_write(pgm, p, cm, cm->page_size, pageaddr, nbytes);
         if(rc < 0)
           failure = 1;          // Paged write failed, fall back to byte-at-a-time write below
-        nwritten++;
+        nwritten += nbytes/cm->page_size;
         report_progress(nwritten, npages, NULL);
+        pageaddr += nbytes - cm->page_size;
       } else {
         pmsg_debug("%s(): skipping page %u: no interesting data\n", __func__, pageaddr/cm->page_size);
       }
@@ -1159,15 +1228,15 @@ int avr_write_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m, int
     /*
      * Find out whether the write action must be invoked for this byte.
      *
-     * For non-paged memory, this means the byte is set to TAG_ALLOCATED.
+     * For non-paged memory, this means the byte is tagged as allocated.
      *
-     * For paged memory, TAG_ALLOCATED also invokes loading the associated
+     * For paged memory, an allocated byte also invokes loading the associated
      * full word, low-byte first, into the device page buffer as required by
      * ISP page programming. This "taints" the page, and upon encountering
      * the last byte of each tainted page, the write operation must also be
      * invoked in order to actually write the page buffer to device memory.
      */
-    int do_write = (paged? m->tags[i & ~1] | m->tags[i | 1]: m->tags[i]) & TAG_ALLOCATED;
+    int do_write = paged? avr_tag_get(m, i & ~1) | avr_tag_get(m, i | 1): avr_tag_get(m, i);
 
     if(paged) {
       page_tainted |= do_write;
@@ -1283,6 +1352,119 @@ int compare_memory_masked(AVRMEM *m, uint8_t b1, uint8_t b2) {
   return (b1 & bitmask) != (b2 & bitmask);
 }
 
+// Mismatch found during verification, see verify_bytes()
+typedef struct {
+  enum { VFY_RO, VFY_RO_SUPPRESS, VFY_ERR, VFY_ERR_SUPPRESS } type;
+  int addr;
+  unsigned char dev, in;
+} Vfy_mismatch;
+
+// Running state of a verification
+typedef struct {
+  int verror, vroerror, maxerrs, ro;
+  int nlog;
+  Vfy_mismatch *log;            // Mismatches to be reported by verify_report()
+} Vfy_state;
+
+static void verify_init(Vfy_state *vs, const AVRMEM *a, int size) {
+  memset(vs, 0, sizeof *vs);
+  vs->maxerrs = verbose >= MSG_DEBUG? size + 1: 10;
+  vs->ro = mem_is_readonly(a);  // Other memories can have known protected zones such as bootloaders
+}
+
+static void verify_log(Vfy_state *vs, int type, int addr, unsigned char dev, unsigned char in) {
+  if(vs->nlog%64 == 0)
+    vs->log = mmt_realloc(vs->log, (vs->nlog + 64)*sizeof *vs->log);
+  vs->log[vs->nlog++] = (Vfy_mismatch) { type, addr, dev, in };
+}
+
+/*
+ * Compare n bytes dev[] read from the device with the input in[] for memory a
+ * from address addr onwards where memory t is tagged as allocated at the same
+ * addresses. Mismatches are logged
+ * for verify_report() so they can be shown after the progress bar. Return -1
+ * if the caller should stop at a mismatch that is neither in a read-only
+ * location nor only in unused bits (unless verbose), and 0 otherwise.
+ */
+static int verify_bytes(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *a, Vfy_state *vs, int addr,
+  const unsigned char *dev, const unsigned char *in, const AVRMEM *t, int n) {
+
+  for(int k = 0; k < n; k++) {
+    if(!avr_tag_get(t, addr + k) || dev[k] == in[k])
+      continue;
+
+    int i = addr + k;
+    uint8_t bitmask = is_isp(p)? get_fuse_bitmask(a): avr_mem_bitmask(p, a, i);
+
+    if(vs->ro || (pgm->readonly && pgm->readonly(pgm, p, a, i))) {
+      if(vs->vroerror < 10)
+        verify_log(vs, VFY_RO, i, dev[k], in[k]);
+      else if(vs->vroerror == 10)
+        verify_log(vs, VFY_RO_SUPPRESS, i, dev[k], in[k]);
+      vs->vroerror++;
+    } else if((dev[k] & bitmask) != (in[k] & bitmask)) {
+      // Mismatch is not just in unused bits
+      if(vs->verror < vs->maxerrs)
+        verify_log(vs, VFY_ERR, i, dev[k], in[k]);
+      else if(vs->verror == vs->maxerrs)
+        verify_log(vs, VFY_ERR_SUPPRESS, i, dev[k], in[k]);
+      vs->verror++;
+      if(verbose < MSG_NOTICE)
+        return -1;
+    } else {
+      // Mismatch is only in unused bits
+      if((dev[k] | bitmask) != 0xff) {
+        // Programmer returned unused bits as 0, must be the part/programmer
+        pmsg_debug("ignoring mismatch in unused bits of %s\n", a->desc);
+        imsg_debug("(device 0x%02x != input 0x%02x); to prevent this warning fix\n", dev[k], in[k]);
+        imsg_debug("the part or programmer definition in the config file\n");
+      } else {
+        // Programmer returned unused bits as 1, must be the user
+        pmsg_debug("ignoring mismatch in unused bits of %s\n", a->desc);
+        imsg_debug("(device 0x%02x != input 0x%02x); to prevent this warning set\n", dev[k], in[k]);
+        imsg_debug("unused bits to 1 when writing (double check with datasheet)\n");
+      }
+    }
+  }
+
+  return 0;
+}
+
+// Show logged mismatches, free the log and return -1 if there were errors, size otherwise
+static int verify_report(Vfy_state *vs, const AVRMEM *a, int size) {
+  for(int k = 0; k < vs->nlog; k++) {
+    Vfy_mismatch *m = vs->log + k;
+
+    switch(m->type) {
+    case VFY_RO:
+      if(quell_progress < 2) {
+        if(k == 0)
+          pmsg_warning("%s verification mismatch%s\n", a->desc,
+            mem_is_in_flash(a)? " in r/o areas, expected for vectors and/or bootloader": "");
+        imsg_warning("  device 0x%02x != input 0x%02x at addr 0x%04x "
+          "(read only location: ignored)\n", m->dev, m->in, m->addr);
+      }
+      break;
+    case VFY_RO_SUPPRESS:
+      if(quell_progress < 2)
+        imsg_warning("  suppressing further mismatches in read-only areas\n");
+      break;
+    case VFY_ERR:
+      if(k == 0)
+        pmsg_warning("%s verification mismatch\n", a->desc);
+      imsg_error("  device 0x%02x != input 0x%02x at addr 0x%04x (error)\n", m->dev, m->in, m->addr);
+      break;
+    case VFY_ERR_SUPPRESS:
+      imsg_warning("  suppressing further verification errors\n");
+    }
+  }
+  mmt_free(vs->log);
+  vs->log = NULL;
+  vs->nlog = 0;
+
+  return vs->verror? -1: size;
+}
+
 /*
  * Verify the memory buffer of p with that of v. The byte range of v may be a
  * subset of p. The byte range of p should cover the whole chip's memory size.
@@ -1299,11 +1481,21 @@ int avr_verify(const PROGRAMMER *pgm, const AVRPART *p, const AVRPART *v, const
   return avr_verify_mem(pgm, p, v, a, size);
 }
 
+// Warn and return the clipped size if size exceeds the memory size
+static int verify_size(const AVRMEM *a, int size) {
+  if(a->size < size) {
+    pmsg_warning("requested verification for %d bytes but\n", size);
+    imsg_warning("%s memory region only contains %d bytes;\n", a->desc, a->size);
+    imsg_warning("only %d bytes will be verified\n", a->size);
+    size = a->size;
+  }
+
+  return size;
+}
+
 int avr_verify_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRPART *v, const AVRMEM *a, int size) {
-  int i;
-  unsigned char *buf1, *buf2;
-  int vsize;
   AVRMEM *b;
+  Vfy_state vs;
 
   pmsg_debug("%s(%s, %s, %s, %s, %s)\n", __func__, pgmid, p->id,
     v? v->id: "NULL", a->desc, str_ccaddress(size, a->size));
@@ -1313,66 +1505,156 @@ int avr_verify_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRPART *v, co
     return -1;
   }
 
-  buf1 = a->buf;
-  buf2 = b->buf;
-  vsize = a->size;
+  size = verify_size(a, size);
+  verify_init(&vs, a, size);
+  verify_bytes(pgm, p, a, &vs, 0, a->buf, b->buf, b, size);
 
-  if(vsize < size) {
-    pmsg_warning("requested verification for %d bytes but\n", size);
-    imsg_warning("%s memory region only contains %d bytes;\n", a->desc, vsize);
-    imsg_warning("only %d bytes will be verified\n", vsize);
-    size = vsize;
-  }
+  return verify_report(&vs, a, size);
+}
 
-  int verror = 0, vroerror = 0, maxerrs = verbose >= MSG_DEBUG? size + 1: 10;
-  int ro = mem_is_readonly(a);  // Other memories can have known protected zones such as bootloaders
-
-  for(i = 0; i < size; i++) {
-    if((b->tags[i] & TAG_ALLOCATED) != 0 && buf1[i] != buf2[i]) {
-      uint8_t bitmask = is_isp(p)? get_fuse_bitmask(a): avr_mem_bitmask(p, a, i);
-
-      if(ro || (pgm->readonly && pgm->readonly(pgm, p, a, i))) {
-        if(quell_progress < 2) {
-          if(vroerror < 10) {
-            if(!(verror + vroerror))
-              pmsg_warning("%s verification mismatch%s\n", a->desc,
-                mem_is_in_flash(a)? " in r/o areas, expected for vectors and/or bootloader": "");
-            imsg_warning("  device 0x%02x != input 0x%02x at addr 0x%04x "
-              "(read only location: ignored)\n", buf1[i], buf2[i], i);
-          } else if(vroerror == 10)
-            imsg_warning("  suppressing further mismatches in read-only areas\n");
-        }
-        vroerror++;
-      } else if((buf1[i] & bitmask) != (buf2[i] & bitmask)) {
-        // Mismatch is not just in unused bits
-        if(verror < maxerrs) {
-          if(!(verror + vroerror))
-            pmsg_warning("%s verification mismatch\n", a->desc);
-          imsg_error("  device 0x%02x != input 0x%02x at addr 0x%04x (error)\n", buf1[i], buf2[i], i);
-        } else if(verror == maxerrs) {
-          imsg_warning("  suppressing further verification errors\n");
+/*
+ * Read from the device those bytes of mem below size that are tagged as
+ * allocated and verify them against mem->buf as they arrive, page by page if
+ * the programmer can read pages, runs of adjacent pages at a time if its
+ * paged_burst allows. This needs neither a copy of the part nor
+ * reading unallocated pages; mem->buf is unchanged afterwards. Unless verbose
+ * stop at the first mismatch that is neither in a read-only location nor only
+ * in unused bits.
+ *
+ * Return the number of bytes verified, LIBAVRDUDE_GENERAL_FAILURE (-1) if
+ * they don't match or another negative LIBAVRDUDE_... code if the memory
+ * could not be read.
+ */
+int avr_read_verify_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, int size) {
+  unsigned char cmd[4], value, *save = NULL;
+  int rc = LIBAVRDUDE_SUCCESS, start = -1, pgsz = mem->page_size;
+  Vfy_state vs;
+
+  pmsg_debug("%s(%s, %s, %s, %s)\n", __func__, pgmid, p->id, mem->desc, str_ccaddress(size, mem->size));
+
+  if(mem->size <= 0)            // Sanity check
+    return LIBAVRDUDE_SOFTFAIL;
+
+  size = verify_size(mem, size);
+  verify_init(&vs, mem, size);
+
+  led_clr(pgm, LED_ERR);
+  led_set(pgm, LED_PGM);
+
+  // Supports paged load thru post-increment
+  if(is_tpi(p) && pgsz > 1 && mem->size%pgsz == 0 && pgm->cmd_tpi != NULL) {
+    while(avr_tpi_poll_nvmbsy(pgm))
+      continue;
+
+    // Setup for read (NOOP)
+    avr_tpi_setup_rw(pgm, mem, 0, TPI_NVMCMD_NO_OPERATION);
+
+    for(int i = 0, lastaddr = 0; i < size; i++) {
+      if(avr_tag_get(mem, i)) {
+        if(lastaddr != i) {     // Need to setup new address
+          avr_tpi_setup_rw(pgm, mem, i, TPI_NVMCMD_NO_OPERATION);
+          lastaddr = i;
         }
-        verror++;
-        if(verbose < MSG_NOTICE)
-          return -1;
-      } else {
-        // Mismatch is only in unused bits
-        if((buf1[i] | bitmask) != 0xff) {
-          // Programmer returned unused bits as 0, must be the part/programmer
-          pmsg_debug("ignoring mismatch in unused bits of %s\n", a->desc);
-          imsg_debug("(device 0x%02x != input 0x%02x); to prevent this warning fix\n", buf1[i], buf2[i]);
-          imsg_debug("the part or programmer definition in the config file\n");
-        } else {
-          // Programmer returned unused bits as 1, must be the user
-          pmsg_debug("ignoring mismatch in unused bits of %s\n", a->desc);
-          imsg_debug("(device 0x%02x != input 0x%02x); to prevent this warning set\n", buf1[i], buf2[i]);
-          imsg_debug("unused bits to 1 when writing (double check with datasheet)\n");
+        cmd[0] = TPI_CMD_SLD_PI;
+        if(pgm->cmd_tpi(pgm, cmd, 1, &value, 1) == -1) {
+          pmsg_error("unable to read address 0x%04x\n", i);
+          rc = LIBAVRDUDE_SOFTFAIL;
+          goto done;
         }
+        lastaddr++;
+        if(verify_bytes(pgm, p, mem, &vs, i, &value, mem->buf + i, mem, 1) < 0)
+          goto done;
       }
+      report_progress(i, size, NULL);
     }
+    goto done;
   }
 
-  return verror? -1: size;
+  // HW programmers need a page size > 1, bootloader typ only offer paged r/w
+  if((pgm->paged_load && pgsz > 1 && mem->size%pgsz == 0) || (is_spm(pgm) && avr_has_paged_access(pgm, p, mem))) {
+    int npages = 0, nread = 0;
+
+    // Pages with at least one allocated byte below size
+    for(int pageaddr = 0; pageaddr < size; pageaddr += pgsz)
+      if(avr_tag_any(mem, pageaddr, pageaddr + pgsz > size? size - pageaddr: pgsz))
+        npages++;
+
+    int maxbytes = avr_burst_pages(pgm, mem)*pgsz;
+
+    if(maxbytes > mem->size)
+      maxbytes = mem->size;
+    save = mmt_malloc(maxbytes);
+    for(int pageaddr = 0, nbytes; pageaddr < size; pageaddr += nbytes) {
+      int n = pageaddr + pgsz > size? size - pageaddr: pgsz;
+
+      nbytes = pgsz;
+      if(!avr_tag_any(mem, pageaddr, n)) {
+        pmsg_debug("%s(): skipping page %u: no interesting data\n", __func__, pageaddr/pgsz);
+        continue;
+      }
+      // Read adjacent pages with data, too, in one go if the programmer can
+      while(nbytes < maxbytes && pageaddr + nbytes < size &&
+        avr_tag_any(mem, pageaddr + nbytes, pageaddr + nbytes + pgsz > size? size - pageaddr - nbytes: pgsz))
+        nbytes += pgsz;
+      n = pageaddr + nbytes > size? size - pageaddr: nbytes;
+
+      // The programmer reads into mem->buf: keep the input pages meanwhile
+      memcpy(save, mem->buf + pageaddr, nbytes);
+      if(pgm->paged_load(pgm, p, mem, pgsz, pageaddr, nbytes) < 0) {
+        memcpy(mem->buf + pageaddr, save, nbytes);
+        start = pageaddr;       // Paged load failed: fall back to byte-at-a-time read from here
+        break;
+      }
+      int stop = verify_bytes(pgm, p, mem, &vs, pageaddr, mem->buf + pageaddr, save, mem, n);
+
+      memcpy(mem->buf + pageaddr, save, nbytes);
+      nread += nbytes/pgsz;
+      report_progress(nread, npages, NULL);
+      if(stop)
+        goto done;
+    }
+    if(start < 0)
+      goto done;
+  }
+
+  if(start <= 0 && mem_is_signature(mem) && pgm->read_sig_bytes) {
+    save = mmt_realloc(save, mem->size);
+    memcpy(save, mem->buf, mem->size);
+    rc = pgm->read_sig_bytes(pgm, p, mem);
+    if(rc >= 0)
+      verify_bytes(pgm, p, mem, &vs, 0, mem->buf, save, mem, size);
+    else if(rc == LIBAVRDUDE_GENERAL_FAILURE)
+      rc = LIBAVRDUDE_SOFTFAIL;
+    memcpy(mem->buf, save, mem->size);
+    goto done;
+  }
+
+  for(int i = start < 0? 0: start; i < size; i++) {
+    if(avr_tag_get(mem, i)) {
+      if((rc = pgm->read_byte(pgm, p, mem, i, &value)) != LIBAVRDUDE_SUCCESS) {
+        pmsg_error("unable to read byte at address 0x%04x\n", i);
+        rc = rc == LIBAVRDUDE_GENERAL_FAILURE? LIBAVRDUDE_NOTSUPPORTED: LIBAVRDUDE_SOFTFAIL;
+        goto done;
+      }
+      if(verify_bytes(pgm, p, mem, &vs, i, &value, mem->buf + i, mem, 1) < 0)
+        goto done;
+    }
+    report_progress(i, size, NULL);
+  }
+
+done:
+  mmt_free(save);
+  led_clr(pgm, LED_PGM);
+  if(rc < 0) {
+    report_progress(1, -1, NULL);
+    if(rc != LIBAVRDUDE_EXIT)
+      led_set(pgm, LED_ERR);
+    mmt_free(vs.log);
+    return rc;
+  }
+  report_progress(1, 1, NULL);  // Finish progress bar before showing mismatches
+
+  return verify_report(&vs, mem, size);
 }
 
 int avr_get_cycle_count(const PROGRAMMER *pgm, const AVRPART *p, int *cycles) {
@@ -1677,7 +1959,12 @@ int avr_mem_might_be_known(const char *str) {
 int avr_chip_erase(const PROGRAMMER *pgm, const AVRPART *p) {
   pmsg_debug("%s(%s, %s)\n", __func__, pgmid, p->id);
 
-  return led_chip_erase(pgm, p);
+  int rc = led_chip_erase(pgm, p);
+
+  // Bootloaders only emulate chip erase and may not erase flash at all
+  cx->avr_erased = rc >= 0 && !is_spm(pgm);
+
+  return rc;
 }
 
 int avr_unlock(const PROGRAMMER *pgm, const AVRPART *p) {
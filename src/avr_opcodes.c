@@ -17,7 +17,9 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 
+#include "avrdude.h"
 #include "libavrdude.h"
 
 /*
@@ -631,23 +633,75 @@ static int bitmask_first_chr(const char *bits, int chr) {
   return ret;
 }
 
+/*
+ * Return the lazily built 64k-entry table that maps each 16-bit opcode to its
+ * first match in avr_opcodes[] that is compatible with avrlevel (or to
+ * MNEMO_NONE). The table is built by enumerating, for each mnemonic from last
+ * to first, all opcodes that match its mask/value pair, so that earlier
+ * entries overwrite later ones and the first match wins. Up to OPC_NTABLES
+ * tables for different avrlevels are kept in the context.
+ */
+static const int16_t *opcode_table(int avrlevel) {
+  int slot;
+
+  for(slot = 0; slot < cx->opc_ntables; slot++)
+    if(cx->opc_level[slot] == avrlevel)
+      return cx->opc_table[slot];
+
+  if(cx->opc_ntables < OPC_NTABLES)
+    slot = cx->opc_ntables++;
+  else {                        // Recycle oldest slot
+    slot = cx->opc_next++ % OPC_NTABLES;
+    mmt_free(cx->opc_table[slot]);
+  }
+
+  int16_t *tab = mmt_malloc(0x10000*sizeof *tab);
+
+  for(int op = 0; op < 0x10000; op++)
+    tab[op] = MNEMO_NONE;
+
+  for(AVR_mnemo i = MNEMO_N - 1; i >= 0; i--) {
+    if(!(avr_opcodes[i].avrlevel & avrlevel))
+      continue;
+
+    int mask = avr_opcodes[i].mask & 0xffff, free = ~mask & 0xffff, value = avr_opcodes[i].value & mask;
+    int rmask = 0, dmask = 0;
+
+    if(avrlevel == PART_AVR_RC && (avr_opcodes[i].type & OTY_REG_MASK) == OTY_RALL) {
+      // Reduced-core ATtiny does not have registers r0, ..., r15
+      rmask = bitmask_first_chr(avr_opcodes[i].bits, 'r');
+      dmask = bitmask_first_chr(avr_opcodes[i].bits, 'd');
+    }
+
+    int f = 0;
+
+    do {                        // Enumerate all subsets f of the don't-care bits
+      int op = value | f;
+
+      if(op16_is_mnemo(op, i))  // Checks the Rd == Rr constraint, too
+        tab[op] = (rmask && !(op & rmask)) || (dmask && !(op & dmask))? MNEMO_NONE: i;
+      f = (f - free) & free;
+    } while(f);
+  }
+
+  cx->opc_level[slot] = avrlevel;
+  cx->opc_table[slot] = tab;
+
+  return tab;
+}
+
+// Free the opcode tables of the current context
+void opcode_zap_tables() {
+  for(int i = 0; i < cx->opc_ntables; i++) {
+    mmt_free(cx->opc_table[i]);
+    cx->opc_table[i] = NULL;
+  }
+  cx->opc_ntables = 0;
+}
+
 // Return first match of opcode that is compatible with avrlevel or MNEMO_NONE
 AVR_mnemo opcode_mnemo(int op, int avrlevel) {
-  for(AVR_mnemo i = 0; i < MNEMO_N; i++)
-    if(avr_opcodes[i].avrlevel & avrlevel)
-      if(op16_is_mnemo(op, i)) {
-        if(avrlevel == PART_AVR_RC && (avr_opcodes[i].type & OTY_REG_MASK) == OTY_RALL) {
-          // Reduced-core ATtiny does not have registers r0, ..., r15
-          int bmask;            // Assert highest bit in 5-bit r/d is set
-
-          if((bmask = bitmask_first_chr(avr_opcodes[i].bits, 'r')) && !(op & bmask))
-            return MNEMO_NONE;
-          if((bmask = bitmask_first_chr(avr_opcodes[i].bits, 'd')) && !(op & bmask))
-            return MNEMO_NONE;
-        }
-        return i;
-      }
-  return MNEMO_NONE;
+  return opcode_table(avrlevel)[op & 0xffff];
 }
 
 // Is 16-bit opcode valid for AVR part with avrlevel architecture?
@@ -29,7 +29,7 @@
 #include "libavrdude.h"
 
 /*
- * Provides an API for cached bytewise access
+ * Provides an API for cached bytewise and range access
  *
  * int avr_read_byte_cached(const PROGRAMMER *pgm, const AVRPART *p, const
  *   AVRMEM *mem, unsigned long addr, unsigned char *value);
@@ -37,6 +37,12 @@
  * int avr_write_byte_cached(const PROGRAMMER *pgm, const AVRPART *p, const
  *  AVRMEM *mem, unsigned long addr, unsigned char data);
  *
+ * int avr_read_range_cached(const PROGRAMMER *pgm, const AVRPART *p, const
+ *  AVRMEM *mem, int addr, int len, unsigned char *buf);
+ *
+ * int avr_write_range_cached(const PROGRAMMER *pgm, const AVRPART *p, const
+ *  AVRMEM *mem, int addr, int len, const unsigned char *data);
+ *
  * int avr_flush_cache(const PROGRAMMER *pgm, const AVRPART *p);
  *
  * int avr_chip_erase_cached(const PROGRAMMER *pgm, const AVRPART *p);
@@ -59,6 +65,15 @@
  * avr_flush_cache() or when attempting to read or write from a location
  * outside the address range of the device memory.
  *
+ * avr_read_range_cached() and avr_write_range_cached() have the same effect
+ * as calling pgm->read_byte_cached() or pgm->write_byte_cached() for each
+ * byte of an interval within the memory, but work on whole pages. Pages not
+ * yet in the cache are fetched with as few multi-page paged_load() calls as
+ * the programmer's paged_burst allows; avr_read_range_cached() also reads
+ * ahead up to as many bytes again as requested, but no more than 256 bytes
+ * (the terminal's default dump length), in the same calls so that paging
+ * through memory with the terminal dump command needs few transactions.
+ *
  * avr_flush_cache() synchronises pending writes to flash, EEPROM, bootrow
  * and usersig with the device. With some programmer and part combinations,
  * flash (and sometimes EEPROM, too) looks like a NOR memory, ie, a write can
@@ -71,7 +86,10 @@
  * pgm->chip_erase() command is issued and both EEPROM and flash are written
  * back to the device. Hence, it can take minutes to ensure that a single
  * previously cleared bit is set and, therefore, this routine should be
- * called sparingly.
+ * called sparingly. avr_write_byte_cached() keeps a bitmap of modified
+ * pages so that avr_flush_cache() only ever compares and writes those;
+ * adjacent modified pages are written in one go if the programmer's
+ * paged_burst capability allows it.
  *
  * avr_chip_erase_cached() erases the chip and discards pending writes() to
  * flash or EEPROM. It presets the flash cache to all 0xff alleviating the
@@ -101,6 +119,9 @@
  * // Does the programmer/memory combo have paged memory access?
  * int avr_has_paged_access(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem);
  *
+ * // How many pages can one paged_write() or paged_load() call take?
+ * int avr_burst_pages(const PROGRAMMER *pgm, const AVRMEM *mem);
+ *
  * // Read the page containing addr from the device into buf
  * int avr_read_page_default(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, int addr, unsigned char *buf);
  *
@@ -110,6 +131,9 @@
  * // Could memory region s1 be the result of a NOR-memory copy of s3 onto s2?
  * int avr_is_and(const unsigned char *s1, const unsigned char *s2, const unsigned char *s3, size_t n);
  *
+ * // CRC-32 of a memory region as computed device-side by pgm->checksum()
+ * uint32_t avr_crc32(uint32_t crc, const unsigned char *buf, size_t len);
+ *
  */
 
 /*
@@ -128,6 +152,14 @@ int avr_has_paged_access(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *
     mem->size > 0 && mem->size%mem->page_size == 0 && mem_is_paged_type(mem) && !(p && avr_mem_exclude(pgm, p, mem));
 }
 
+/*
+ * Number of pages the programmer can write or read with one paged_write() or
+ * paged_load() call as advertised by pgm->paged_burst; at least one
+ */
+int avr_burst_pages(const PROGRAMMER *pgm, const AVRMEM *mem) {
+  return mem->page_size > 1 && pgm->paged_burst > mem->page_size? pgm->paged_burst/mem->page_size: 1;
+}
+
 #define fallback_read_byte (pgm->read_byte != avr_read_byte_cached? led_read_byte: avr_read_byte_default)
 #define fallback_write_byte (pgm->write_byte != avr_write_byte_cached? led_write_byte: avr_write_byte_default)
 
@@ -215,6 +247,66 @@ int avr_is_and(const unsigned char *s1, const unsigned char *s2, const unsigned
   return 1;
 }
 
+/*
+ * CRC-32 (IEEE 802.3, same as zlib's crc32()) of len bytes at buf continuing
+ * from a previous crc, which is 0 initially; programmers that implement
+ * pgm->checksum() return this over the device memory
+ */
+uint32_t avr_crc32(uint32_t crc, const unsigned char *buf, size_t len) {
+  static const uint32_t tab[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+  };
+
+  crc = ~crc;
+  while(len--) {
+    crc ^= *buf++;
+    crc = (crc >> 4) ^ tab[crc & 15];
+    crc = (crc >> 4) ^ tab[crc & 15];
+  }
+
+  return ~crc;
+}
+
+// Dirty-page bitmap: bit pgno is set when page pgno of cont may differ from copy
+static int isDirty(const AVR_Cache *cp, int pgno) {
+  return cp->isdirty[pgno/8] & (1 << pgno%8);
+}
+
+static void setDirty(AVR_Cache *cp, int pgno) {
+  cp->isdirty[pgno/8] |= 1 << pgno%8;
+}
+
+static void clearDirty(AVR_Cache *cp, int pgno) {
+  cp->isdirty[pgno/8] &= ~(1 << pgno%8);
+}
+
+// First dirty page at or after pgno or -1 if there is none
+static int nextDirty(const AVR_Cache *cp, int pgno) {
+  int npages = cp->size/cp->page_size;
+
+  while(pgno < npages)
+    if(!cp->isdirty[pgno/8])    // Skip clean bitmap bytes wholesale
+      pgno = (pgno | 7) + 1;
+    else if(isDirty(cp, pgno))
+      return pgno;
+    else
+      pgno++;
+
+  return -1;
+}
+
+// Does dirty page pgno differ from the device copy? If not, mark it clean
+static int isChanged(AVR_Cache *cp, int pgno) {
+  int n = pgno*cp->page_size;
+
+  if(memcmp(cp->copy + n, cp->cont + n, cp->page_size))
+    return 1;
+  clearDirty(cp, pgno);
+
+  return 0;
+}
+
 static int cacheAddress(int addr, const AVR_Cache *cp, const AVRMEM *mem) {
   int cacheaddr = addr + (int) (mem->offset - cp->offset);
 
@@ -255,6 +347,57 @@ static int loadCachePage(AVR_Cache *cp, const PROGRAMMER *pgm, const AVRPART *p,
   return LIBAVRDUDE_SUCCESS;
 }
 
+/*
+ * Ensure the pages of mem covering [addr, addr+len) are in the cache. Runs of
+ * missing pages are read with one paged_load() call each as far as the
+ * programmer's paged_burst allows; missing pages up to readahead bytes beyond
+ * the interval are fetched in the same call. Falls back to loadCachePage()
+ * page by page for single pages or if a multi-page read fails.
+ */
+static int loadCachePages(AVR_Cache *cp, const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
+  int addr, int len, int readahead) {
+
+  int pgsize = cp->page_size, off = (int) (mem->offset - cp->offset);
+  int maxbytes = avr_burst_pages(pgm, mem)*pgsize, beg = addr & ~(pgsize - 1), end = addr + len;
+  int ahead = end + readahead > mem->size? mem->size: end + readahead;
+
+  for(int base = beg, nbytes; base < end; base += nbytes) {
+    nbytes = pgsize;
+    if(cp->iscached[(base + off)/pgsize])
+      continue;
+    while(nbytes < maxbytes && base + nbytes < ahead && !cp->iscached[(base + off + nbytes)/pgsize])
+      nbytes += pgsize;
+
+    if(nbytes > pgsize) {
+      unsigned char *save = mmt_malloc(nbytes);
+      int rc;
+
+      led_clr(pgm, LED_ERR);
+      led_set(pgm, LED_PGM);
+      // The programmer reads into mem->buf: keep its contents meanwhile
+      memcpy(save, mem->buf + base, nbytes);
+      if((rc = pgm->paged_load(pgm, p, mem, pgsize, base, nbytes)) >= 0) {
+        memcpy(cp->cont + base + off, mem->buf + base, nbytes);
+        memcpy(cp->copy + base + off, mem->buf + base, nbytes);
+        memset(cp->iscached + (base + off)/pgsize, 1, nbytes/pgsize);
+      }
+      memcpy(mem->buf + base, save, nbytes);
+      mmt_free(save);
+      led_clr(pgm, LED_PGM);
+      if(rc >= 0) {
+        report_progress(base + nbytes - beg, end - beg, NULL);
+        continue;
+      }
+    }
+    for(int n = 0; n < nbytes && base + n < end; n += pgsize)
+      if(loadCachePage(cp, pgm, p, mem, base + n, base + n + off, 0) < 0)
+        return LIBAVRDUDE_GENERAL_FAILURE;
+    report_progress(base + nbytes - beg, end - beg, NULL);
+  }
+
+  return LIBAVRDUDE_SUCCESS;
+}
+
 static int initCache(AVR_Cache *cp, const PROGRAMMER *pgm, const AVRPART *p) {
   AVRMEM *basemem = cp == pgm->cp_flash? avr_locate_flash(p): cp == pgm->cp_eeprom? avr_locate_eeprom(p):
     cp == pgm->cp_bootrow? avr_locate_bootrow(p): avr_locate_usersig(p);
@@ -268,6 +411,7 @@ static int initCache(AVR_Cache *cp, const PROGRAMMER *pgm, const AVRPART *p) {
   cp->cont = mmt_malloc(cp->size);
   cp->copy = mmt_malloc(cp->size);
   cp->iscached = mmt_malloc(cp->size/cp->page_size);
+  cp->isdirty = mmt_malloc((cp->size/cp->page_size + 7)/8);
 
   if(is_spm(pgm) && mem_is_in_flash(basemem)) {  // Could be vector bootloader
     // Caching the vector page hands over to the progammer that then can patch the reset vector
@@ -315,6 +459,8 @@ static int writeCachePage(AVR_Cache *cp, const PROGRAMMER *pgm, const AVRPART *p
   }
 
 success:
+  if(!memcmp(cp->copy + base, cp->cont + base, cp->page_size))
+    clearDirty(cp, base/cp->page_size);
   led_clr(pgm, LED_PGM);
   return LIBAVRDUDE_SUCCESS;
 
@@ -324,6 +470,43 @@ error:
   return LIBAVRDUDE_GENERAL_FAILURE;
 }
 
+/*
+ * Write npages consecutive modified pages from base onwards to the device
+ *   - Uses one paged_write() and one paged_load() call for all pages
+ *   - Caller to ensure npages does not exceed avr_burst_pages()
+ *   - Falls back to writing page by page if either call fails
+ */
+static int writeCachePages(AVR_Cache *cp, const PROGRAMMER *pgm, const AVRPART *p,
+  const AVRMEM *mem, int base, int npages, int nlOnErr) {
+
+  if(npages == 1)
+    return writeCachePage(cp, pgm, p, mem, base, nlOnErr);
+
+  int rc, len = npages*cp->page_size;
+  unsigned char *save = mmt_malloc(len);
+
+  led_clr(pgm, LED_ERR);
+  led_set(pgm, LED_PGM);
+  // Part memory buffer mem is unaffected by this (though temporarily changed)
+  memcpy(save, mem->buf + base, len);
+  memcpy(mem->buf + base, cp->cont + base, len);
+  if((rc = pgm->paged_write(pgm, p, mem, cp->page_size, base, len)) >= 0)
+    if((rc = pgm->paged_load(pgm, p, mem, cp->page_size, base, len)) >= 0)
+      memcpy(cp->copy + base, mem->buf + base, len);
+  memcpy(mem->buf + base, save, len);
+  mmt_free(save);
+  led_clr(pgm, LED_PGM);
+
+  for(int n = base; n < base + len; n += cp->page_size)
+    if(rc < 0) {
+      if(writeCachePage(cp, pgm, p, mem, n, nlOnErr) < 0)
+        return LIBAVRDUDE_GENERAL_FAILURE;
+    } else if(!memcmp(cp->copy + n, cp->cont + n, cp->page_size))
+      clearDirty(cp, n/cp->page_size);
+
+  return LIBAVRDUDE_SUCCESS;
+}
+
 // A coarse guess where any bootloader might start (prob underestimates the start)
 static int guessBootStart(const PROGRAMMER *pgm, const AVRPART *p) {
   int bootstart = 0;
@@ -382,13 +565,14 @@ int avr_flush_cache(const PROGRAMMER *pgm, const AVRPART *p) {
     if(!mem || !cp->cont)
       continue;
 
-    for(int pgno = 0, n = 0; n < cp->size; pgno++, n += cp->page_size) {
-      if(cp->iscached[pgno])
-        if(memcmp(cp->copy + n, cp->cont + n, cp->page_size)) {
-          chpages++;
-          if(mems[i].zopaddr == -1 && !avr_is_and(cp->cont + n, cp->copy + n, cp->cont + n, cp->page_size))
-            mems[i].zopaddr = n;
-        }
+    for(int pgno = nextDirty(cp, 0); pgno >= 0; pgno = nextDirty(cp, pgno + 1)) {
+      int n = pgno*cp->page_size;
+
+      if(isChanged(cp, pgno)) {
+        chpages++;
+        if(mems[i].zopaddr == -1 && !avr_is_and(cp->cont + n, cp->copy + n, cp->cont + n, cp->page_size))
+          mems[i].zopaddr = n;
+      }
     }
   }
 
@@ -397,6 +581,7 @@ int avr_flush_cache(const PROGRAMMER *pgm, const AVRPART *p) {
 
   pmsg_info("synching cache to device ... ");
   fflush(stderr);
+  cx->avr_erased = 0;           // Flash pages may be written from here on
 
   // Check whether page erase needed and working and whether chip erase needed
   for(size_t i = 0; i < sizeof mems/sizeof *mems; i++) {
@@ -511,6 +696,11 @@ int avr_flush_cache(const PROGRAMMER *pgm, const AVRPART *p) {
       if(mem_is_usersig(mem))   // CE does not affect usersig/userrow
         continue;
 
+      // Copy is about to change: recheck all cached pages when writing back
+      for(int pgno = 0; pgno < cp->size/cp->page_size; pgno++)
+        if(cp->iscached[pgno])
+          setDirty(cp, pgno);
+
       if(mems[i].isflash) {
         memset(cp->copy, 0xff, cp->size); // Record device memory as erased
         if(is_spm(pgm)) {       // Bootloaders will not overwrite themselves
@@ -553,6 +743,8 @@ int avr_flush_cache(const PROGRAMMER *pgm, const AVRPART *p) {
 
   int nwr = 0;
 
+  cx->avr_erased = 0;           // Chip erase above is followed by writes
+
   // Count number of writes
   for(size_t i = 0; i < sizeof mems/sizeof *mems; i++) {
     AVRMEM *mem = mems[i].mem;
@@ -561,8 +753,8 @@ int avr_flush_cache(const PROGRAMMER *pgm, const AVRPART *p) {
     if(!mem)
       continue;
 
-    for(int pgno = 0, n = 0; n < cp->size; pgno++, n += cp->page_size)
-      if(cp->iscached[pgno] && memcmp(cp->copy + n, cp->cont + n, cp->page_size))
+    for(int pgno = nextDirty(cp, 0); pgno >= 0; pgno = nextDirty(cp, pgno + 1))
+      if(isChanged(cp, pgno))
         nwr++;
   }
 
@@ -576,13 +768,21 @@ int avr_flush_cache(const PROGRAMMER *pgm, const AVRPART *p) {
       if(!mem || !cp->cont)
         continue;
 
-      for(int iwr = 0, pgno = 0, n = 0; n < cp->size; pgno++, n += cp->page_size) {
-        if(cp->iscached[pgno] && memcmp(cp->copy + n, cp->cont + n, cp->page_size)) {
-          if(!chiperase && mems[i].pgerase && pgm->page_erase)
-            led_page_erase(pgm, p, mem, n);
-          if(writeCachePage(cp, pgm, p, mem, n, 1) < 0)
-            return LIBAVRDUDE_GENERAL_FAILURE;
-          if(memcmp(cp->copy + n, cp->cont + n, cp->page_size)) {
+      int npages = cp->size/cp->page_size, maxrun = avr_burst_pages(pgm, mem);
+
+      for(int iwr = 0, pgno = nextDirty(cp, 0); pgno >= 0; pgno = nextDirty(cp, pgno)) {
+        int n = pgno*cp->page_size, run = 1;
+
+        // Coalesce adjacent modified pages into one write
+        while(run < maxrun && pgno + run < npages && isDirty(cp, pgno + run))
+          run++;
+        if(!chiperase && mems[i].pgerase && pgm->page_erase)
+          for(int k = 0; k < run; k++)
+            led_page_erase(pgm, p, mem, n + k*cp->page_size);
+        if(writeCachePages(cp, pgm, p, mem, n, run, 1) < 0)
+          return LIBAVRDUDE_GENERAL_FAILURE;
+        for(int k = 0; k < run; k++, pgno++, n += cp->page_size) {
+          if(isDirty(cp, pgno)) { // Page still differs from device
             report_progress(1, -1, NULL);
             if(quell_progress)
               msg_info("\n");
@@ -685,10 +885,128 @@ int avr_write_byte_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM
     return LIBAVRDUDE_SOFTFAIL;
 
   cp->cont[cacheaddr] = data;
+  setDirty(cp, cacheaddr/cp->page_size);
 
   return LIBAVRDUDE_SUCCESS;
 }
 
+/*
+ * Set *cpp to the cache of mem, initialising it if needed, and check that the
+ * interval [addr, addr+len) maps into it; return the cache address of addr or
+ * a negative value on error
+ */
+static int rangeCache(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, int addr, int len,
+  AVR_Cache **cpp) {
+
+  AVR_Cache *cp = mem_is_eeprom(mem)? pgm->cp_eeprom: mem_is_in_flash(mem)? pgm->cp_flash:
+    mem_is_bootrow(mem)? pgm->cp_bootrow: pgm->cp_usersig;
+
+  if(!cp->cont)                 // Init cache if needed
+    if(initCache(cp, pgm, p) < 0)
+      return LIBAVRDUDE_GENERAL_FAILURE;
+
+  int cacheaddr = cacheAddress(addr, cp, mem);
+
+  if(cacheaddr < 0 || cacheAddress(addr + len - 1, cp, mem) < 0)
+    return LIBAVRDUDE_GENERAL_FAILURE;
+  *cpp = cp;
+
+  return cacheaddr;
+}
+
+/*
+ * Read len bytes of mem from addr onwards into buf via the cache
+ *  - Same effect as pgm->read_byte_cached() for each byte but page by page
+ *  - Reads missing pages and up to min(len, 256) bytes ahead in multi-page paged_load() calls
+ *  - Falls back to pgm->read_byte_cached() byte by byte if it is not the
+ *    default or if there is no paged access to mem
+ *  - The interval [addr, addr+len) must lie within the memory
+ */
+int avr_read_range_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
+  int addr, int len, unsigned char *buf) {
+
+  if(addr < 0 || len < 0 || addr + len > mem->size) {
+    pmsg_error("%s interval [0x%04x, 0x%04x] out of range\n", mem->desc, addr, addr + len - 1);
+    return LIBAVRDUDE_GENERAL_FAILURE;
+  }
+  if(len == 0)
+    return LIBAVRDUDE_SUCCESS;
+
+  if(pgm->read_byte_cached != avr_read_byte_cached || !avr_has_paged_access(pgm, p, mem)) {
+    for(int i = 0; i < len; i++) {
+      int rc = pgm->read_byte_cached(pgm, p, mem, addr + i, buf + i);
+
+      if(rc != LIBAVRDUDE_SUCCESS)
+        return rc;
+      report_progress(i, len, NULL);
+    }
+    return LIBAVRDUDE_SUCCESS;
+  }
+
+  AVR_Cache *cp;
+  int cacheaddr = rangeCache(pgm, p, mem, addr, len, &cp);
+
+  if(cacheaddr < 0 || loadCachePages(cp, pgm, p, mem, addr, len, len < 256? len: 256) < 0)
+    return LIBAVRDUDE_GENERAL_FAILURE;
+  memcpy(buf, cp->cont + cacheaddr, len);
+
+  return LIBAVRDUDE_SUCCESS;
+}
+
+/*
+ * Write len bytes of data to mem from addr onwards via the cache
+ *  - Same effect as pgm->write_byte_cached() for each byte but page by page
+ *  - Reads missing pages in multi-page paged_load() calls
+ *  - Falls back to pgm->write_byte_cached() byte by byte if it is not the
+ *    default or if there is no paged access to mem
+ *  - Leaves bytes alone that the programmer indicates as readonly and returns
+ *    LIBAVRDUDE_SOFTFAIL if there were any that would have changed
+ *  - The interval [addr, addr+len) must lie within the memory
+ */
+int avr_write_range_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
+  int addr, int len, const unsigned char *data) {
+
+  int ret = LIBAVRDUDE_SUCCESS;
+
+  if(addr < 0 || len < 0 || addr + len > mem->size) {
+    pmsg_error("%s interval [0x%04x, 0x%04x] out of range\n", mem->desc, addr, addr + len - 1);
+    return LIBAVRDUDE_GENERAL_FAILURE;
+  }
+  if(len == 0)
+    return LIBAVRDUDE_SUCCESS;
+
+  if(pgm->write_byte_cached != avr_write_byte_cached || !avr_has_paged_access(pgm, p, mem)) {
+    for(int i = 0; i < len; i++) {
+      int rc = pgm->write_byte_cached(pgm, p, mem, addr + i, data[i]);
+
+      if(rc == LIBAVRDUDE_SOFTFAIL)
+        ret = rc;
+      else if(rc != LIBAVRDUDE_SUCCESS)
+        return rc;
+    }
+    return ret;
+  }
+
+  AVR_Cache *cp;
+  int cacheaddr = rangeCache(pgm, p, mem, addr, len, &cp);
+
+  if(cacheaddr < 0 || loadCachePages(cp, pgm, p, mem, addr, len, 0) < 0)
+    return LIBAVRDUDE_GENERAL_FAILURE;
+
+  for(int i = 0; i < len; i++) {
+    if(cp->cont[cacheaddr + i] == data[i])
+      continue;
+    if(pgm->readonly && pgm->readonly(pgm, p, mem, addr + i)) {
+      ret = LIBAVRDUDE_SOFTFAIL;
+      continue;
+    }
+    cp->cont[cacheaddr + i] = data[i];
+    setDirty(cp, (cacheaddr + i)/cp->page_size);
+  }
+
+  return ret;
+}
+
 // Erase the chip and set the cache accordingly
 int avr_chip_erase_cached(const PROGRAMMER *pgm, const AVRPART *p) {
   Cache_desc mems[] = {
@@ -699,8 +1017,10 @@ int avr_chip_erase_cached(const PROGRAMMER *pgm, const AVRPART *p) {
   };
   int rc;
 
+  cx->avr_erased = 0;
   if((rc = led_chip_erase(pgm, p)) < 0)
     return rc;
+  cx->avr_erased = !is_spm(pgm);       // Bootloaders may not erase flash
 
   for(size_t i = 0; i < sizeof mems/sizeof *mems; i++) {
     AVRMEM *mem = mems[i].mem;
@@ -713,6 +1033,9 @@ int avr_chip_erase_cached(const PROGRAMMER *pgm, const AVRPART *p) {
       if(initCache(cp, pgm, p) < 0)
         return LIBAVRDUDE_GENERAL_FAILURE;
 
+    // All branches below either discard pending writes or preset cont and copy alike
+    memset(cp->isdirty, 0, (cp->size/cp->page_size + 7)/8);
+
     if(mems[i].isflash) {
       if(is_spm(pgm)) {         // Reset cache to unknown
         memset(cp->iscached, 0, cp->size/cp->page_size);
@@ -779,6 +1102,7 @@ int avr_page_erase_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM
 
   // Invalidate this cache page and read back, ie, we don't trust the page_erase() routine
   cp->iscached[cacheaddr/cp->page_size] = 0;
+  clearDirty(cp, cacheaddr/cp->page_size);
 
   // Reload cache page
   if(loadCachePage(cp, pgm, p, mem, (int) addr, cacheaddr, 0) < 0)
@@ -803,6 +1127,8 @@ int avr_reset_cache(const PROGRAMMER *pgm, const AVRPART *p_unused) {
       mmt_free(cp->copy);
     if(cp->iscached)
       mmt_free(cp->iscached);
+    if(cp->isdirty)
+      mmt_free(cp->isdirty);
     memset(cp, 0, sizeof *cp);
   }
 
@@ -21,6 +21,8 @@
 
 #include <stdio.h>
 
+#include "libavrdude.h"
+
 #define SYSTEM_CONF_FILE "avrdude.conf"
 
 #if defined(WIN32)
@@ -33,11 +35,22 @@
 #define progbuf ""              // Used to be for indenting continuation below "avrdude: msg"
 extern char *progname;          // Name of program, for messages
 extern int ovsigck;             // Override signature check (-F)
-extern int verbose;             // Verbosity level (-v, -vv, ...)
-extern int quell_progress;      // Quell progress report -q, reduce effective verbosity level (-qq, -qqq)
+extern LIBAVRDUDE_TLS int verbose;        // Verbosity level (-v, -vv, ...), per thread
+extern LIBAVRDUDE_TLS int quell_progress; // Quell progress report -q, reduce effective verbosity level (-qq, -qqq)
+extern LIBAVRDUDE_TLS FILE *msg_log;      // If set, this thread's messages go there, see gang.c
 extern const char *partdesc;    // Part -p string
 extern const char *pgmid;       // Programmer -c string
 
+double parse_bitclock(const char *str);
+char *default_port(const PROGRAMMER *pgm);
+int process_updates(PROGRAMMER *pgm, AVRPART *p, LISTID updates, enum updateflags uflags,
+  int erase, int explicit_e, int baudrate, int is_dryrun);
+
+int avrdude_server(const char *sockpath);
+int avrdude_client(const char *sockpath, LISTID args);
+int avrdude_gang(LISTID targets, LISTID updates, enum updateflags uflags, int erase, int explicit_e,
+  int baudrate, double bitclock, int ispdelay, const char *exitspecs, LISTID xparams);
+
 // Magic memory tree: these functions succeed or exit()
 #define mmt_strdup(s) cfg_strdup(__func__, s)
 #define mmt_malloc(n) cfg_malloc(__func__, n)
@@ -301,7 +301,7 @@ AVRMEM *avr_new_memory(const char *name, int size) {
   m->page_size = 1;             // Ensure not 0
   m->size = size;
   m->buf = mmt_malloc(size);
-  m->tags = mmt_malloc(size);
+  m->tags = mmt_malloc(TAG_WORDS(size)*sizeof *m->tags);
   m->initval = -1;              // Unknown value represented as -1
   m->bitmask = -1;              // Default to -1
 
@@ -344,7 +344,7 @@ int avr_initmem(const AVRPART *p) {
     AVRMEM *m = ldata(ln);
 
     m->buf = mmt_malloc(m->size);
-    m->tags = mmt_malloc(m->size);
+    m->tags = mmt_malloc(TAG_WORDS(m->size)*sizeof *m->tags);
   }
 
   return 0;
@@ -362,8 +362,8 @@ AVRMEM *avr_dup_mem(const AVRMEM *m) {
     }
 
     if(m->tags) {
-      n->tags = (unsigned char *) mmt_malloc(n->size);
-      memcpy(n->tags, m->tags, n->size);
+      n->tags = mmt_malloc(TAG_WORDS(n->size)*sizeof *n->tags);
+      memcpy(n->tags, m->tags, TAG_WORDS(n->size)*sizeof *n->tags);
     }
 
     for(int i = 0; i < AVR_OP_MAX; i++)
@@ -407,6 +407,214 @@ void avr_free_memalias(AVRMEM_ALIAS *m) {
   mmt_free(m);
 }
 
+/*
+ * The allocation tags of a memory are a bitmap with one bit per byte; the
+ * functions below work on the address interval [addr, addr+len) clipped to
+ * the memory a 64-bit word at a time, whilst avr_tag_get(), avr_tag_set()
+ * and avr_tag_clr() in libavrdude.h access single bytes' tags.
+ */
+
+// Mask of the bits in tag word w that lie within [addr, end)
+static uint64_t tag_mask(int w, int addr, int end) {
+  int lo = addr > w*64? addr - w*64: 0, hi = end < (w + 1)*64? end - w*64: 64;
+
+  return (hi == 64? ~(uint64_t) 0: ((uint64_t) 1 << hi) - 1) & ~(((uint64_t) 1 << lo) - 1);
+}
+
+// Clip [*addrp, *endp) to the memory; return 0 if the interval is empty
+static int tag_clip(const AVRMEM *mem, int *addrp, int *endp) {
+  if(*addrp < 0)
+    *addrp = 0;
+  if(*endp > mem->size)
+    *endp = mem->size;
+
+  return *addrp < *endp;
+}
+
+static int tag_ctz(uint64_t x) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(x);
+#else
+  int n = 0;
+
+  while(!(x & 1))
+    x >>= 1, n++;
+  return n;
+#endif
+}
+
+static int tag_popcount(uint64_t x) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(x);
+#else
+  int n = 0;
+
+  for(; x; x &= x - 1)
+    n++;
+  return n;
+#endif
+}
+
+// Tag the bytes in [addr, addr+len) as allocated if set is non-zero, otherwise as unallocated
+void avr_tag_range(const AVRMEM *mem, int addr, int len, int set) {
+  int end = addr + len;
+
+  if(!tag_clip(mem, &addr, &end))
+    return;
+  for(int w = addr/64; w*64 < end; w++)
+    if(set)
+      mem->tags[w] |= tag_mask(w, addr, end);
+    else
+      mem->tags[w] &= ~tag_mask(w, addr, end);
+}
+
+// Is any byte in [addr, addr+len) tagged as allocated?
+int avr_tag_any(const AVRMEM *mem, int addr, int len) {
+  int end = addr + len;
+
+  if(tag_clip(mem, &addr, &end))
+    for(int w = addr/64; w*64 < end; w++)
+      if(mem->tags[w] & tag_mask(w, addr, end))
+        return 1;
+
+  return 0;
+}
+
+// Are all bytes in [addr, addr+len) tagged as allocated? Returns 1 for an empty interval
+int avr_tag_all(const AVRMEM *mem, int addr, int len) {
+  int end = addr + len;
+
+  if(tag_clip(mem, &addr, &end))
+    for(int w = addr/64; w*64 < end; w++) {
+      uint64_t mask = tag_mask(w, addr, end);
+
+      if((mem->tags[w] & mask) != mask)
+        return 0;
+    }
+
+  return 1;
+}
+
+// Number of bytes in [addr, addr+len) tagged as allocated
+int avr_tag_count(const AVRMEM *mem, int addr, int len) {
+  int end = addr + len, ret = 0;
+
+  if(tag_clip(mem, &addr, &end))
+    for(int w = addr/64; w*64 < end; w++)
+      ret += tag_popcount(mem->tags[w] & tag_mask(w, addr, end));
+
+  return ret;
+}
+
+/*
+ * Return the first address in [addr, end) whose byte is tagged as allocated
+ * if set is non-zero or as unallocated otherwise; return end if there is none
+ */
+int avr_tag_find(const AVRMEM *mem, int addr, int end, int set) {
+  int from = addr, to = end;
+
+  if(tag_clip(mem, &from, &to))
+    for(int w = from/64; w*64 < to; w++) {
+      uint64_t bits = (set? mem->tags[w]: ~mem->tags[w]) & tag_mask(w, from, to);
+
+      if(bits)
+        return w*64 + tag_ctz(bits);
+    }
+
+  return end;
+}
+
+/*
+ * Lookup tables for the memories of a part built by index_avrparts() once the
+ * configuration files have been read, and by avr_dup_part() for copies of
+ * indexed parts: all initial substrings of memory and alias names, and the
+ * first memory for each type bit and fuse offset. Lookups only ever read the
+ * tables, so threads can share the parts of the configuration. The memory
+ * lookups below fall back to walking the lists should these have changed in
+ * size since the tables were built.
+ */
+struct avrmem_index {
+  int nmem, nalias;             // List sizes at the time the tables were built
+  Hash_table *mem, *alias;      // Name prefix -> first and exact memory (alias)
+  AVRMEM *bytype[32];           // First memory with type bit n set
+  AVRMEM *fuse[MEM_FUSEOFF_MASK + 1];   // First fuse with offset n
+  AVRMEM *fuseoff[MEM_FUSEOFF_MASK + 2];        // Result of avr_locate_fuse_by_offset(p, n)
+};
+
+static void free_mem_index(AVRPART *p) {
+  if(p->mem_index) {
+    hash_free(p->mem_index->mem);
+    hash_free(p->mem_index->alias);
+    mmt_free(p->mem_index);
+    p->mem_index = NULL;
+  }
+}
+
+// Store item under all initial substrings of its name
+static void index_prefixes(Hash_table *t, const char *name, void *item) {
+  size_t len = strlen(name);
+
+  for(size_t l = 1; l <= len; l++) {
+    Hash_entry *e = hash_put(t, name, l);
+
+    if(!e->n++)
+      e->first = item;
+    if(l == len && !e->exact)
+      e->exact = item;
+  }
+}
+
+// Return exact match of name or the only item that name is an initial substring of
+static void *lookup_prefix(const Hash_table *t, const char *name) {
+  Hash_entry *e = hash_get(t, name, strlen(name));
+
+  return !e? NULL: e->exact? e->exact: e->n == 1? e->first: NULL;
+}
+
+static void index_mems(AVRPART *p) {
+  struct avrmem_index *ix;
+
+  free_mem_index(p);
+  ix = p->mem_index = mmt_malloc(sizeof *ix);
+  ix->mem = hash_new(0);
+  ix->alias = hash_new(0);
+
+  for(LNODEID ln = lfirst(p->mem); ln; ln = lnext(ln)) {
+    AVRMEM *m = ldata(ln);
+
+    ix->nmem++;
+    index_prefixes(ix->mem, m->desc, m);
+    for(int i = 0; i < 32; i++)
+      if(!ix->bytype[i] && (m->type & (1U << i)))
+        ix->bytype[i] = m;
+    if(mem_is_a_fuse(m)) {
+      unsigned int fo = mem_fuse_offset(m);
+
+      if(!ix->fuse[fo])
+        ix->fuse[fo] = m;
+      for(unsigned int off = 0; off < sizeof ix->fuseoff/sizeof *ix->fuseoff; off++)
+        if(!ix->fuseoff[off] && (off == fo || (m->size == 2 && off - 1 == fo)))
+          ix->fuseoff[off] = m;
+    }
+  }
+  for(LNODEID ln = lfirst(p->mem_alias); ln; ln = lnext(ln)) {
+    AVRMEM_ALIAS *a = ldata(ln);
+
+    ix->nalias++;
+    index_prefixes(ix->alias, a->desc, a);
+  }
+}
+
+// Return the lookup tables of the part if they are still valid
+static const struct avrmem_index *mem_index(const AVRPART *p) {
+  const struct avrmem_index *ix = p->mem_index;
+
+  if(ix && ix->nmem == (p->mem? lsize(p->mem): 0) && ix->nalias == (p->mem_alias? lsize(p->mem_alias): 0))
+    return ix;
+
+  return NULL;
+}
+
 AVRMEM_ALIAS *avr_locate_memalias(const AVRPART *p, const char *desc) {
   AVRMEM_ALIAS *m, *match;
   LNODEID ln;
@@ -416,6 +624,11 @@ AVRMEM_ALIAS *avr_locate_memalias(const AVRPART *p, const char *desc) {
   if(!p || !desc || !(d1 = *desc) || !p->mem_alias)
     return NULL;
 
+  const struct avrmem_index *ix = mem_index(p);
+
+  if(ix)
+    return lookup_prefix(ix->alias, desc);
+
   l = strlen(desc);
   matches = 0;
   match = NULL;
@@ -441,6 +654,11 @@ AVRMEM *avr_locate_mem_noalias(const AVRPART *p, const char *desc) {
   if(!p || !desc || !(d1 = *desc) || !p->mem)
     return NULL;
 
+  const struct avrmem_index *ix = mem_index(p);
+
+  if(ix)
+    return lookup_prefix(ix->mem, desc);
+
   l = strlen(desc);
   matches = 0;
   match = NULL;
@@ -471,8 +689,12 @@ AVRMEM *avr_locate_mem(const AVRPART *p, const char *desc) {
 
 // Return the first fuse which has off as offset or which has high byte and off-1 as offset
 AVRMEM *avr_locate_fuse_by_offset(const AVRPART *p, unsigned int off) {
+  const struct avrmem_index *ix;
   AVRMEM *m;
 
+  if(p && (ix = mem_index(p)) && off < sizeof ix->fuseoff/sizeof *ix->fuseoff)
+    return ix->fuseoff[off];
+
   if(p && p->mem)
     for(LNODEID ln = lfirst(p->mem); ln; ln = lnext(ln))
       if(mem_is_a_fuse(m = ldata(ln)))
@@ -489,6 +711,13 @@ AVRMEM *avr_locate_mem_by_type(const AVRPART *p, Memtype type) {
 
   type &= ~(Memtype) MEM_FUSEOFF_MASK;
 
+  const struct avrmem_index *ix = p? mem_index(p): NULL;
+
+  if(ix && type == MEM_IS_A_FUSE)
+    return ix->fuse[off];
+  if(ix && type && !(type & (type - 1)))        // Single type bit
+    return ix->bytype[intlog2(type)];
+
   if(p && p->mem)
     for(LNODEID ln = lfirst(p->mem); ln; ln = lnext(ln))
       if((m = ldata(ln))->type & type)
@@ -997,12 +1226,17 @@ AVRPART *avr_dup_part(const AVRPART *d) {
 
     for(int i = 0; i < AVR_OP_MAX; i++)
       p->op[i] = avr_dup_opcode(p->op[i]);
+
+    p->mem_index = NULL;
+    if(mem_index(d))
+      index_mems(p);
   }
 
   return p;
 }
 
 void avr_free_part(AVRPART *d) {
+  free_mem_index(d);
   ldestroy_cb(d->mem, (void (*)(void *)) avr_free_mem);
   d->mem = NULL;
   ldestroy_cb(d->mem_alias, (void (*)(void *)) avr_free_memalias);
@@ -1020,6 +1254,11 @@ void avr_free_part(AVRPART *d) {
   mmt_free(d);
 }
 
+// Return whether parts is the list that the part lookup tables were built for
+static int parts_indexed(const LISTID parts) {
+  return parts && parts == cx->avr_ixparts && lsize(parts) == cx->avr_ixnparts;
+}
+
 AVRPART *locate_part(const LISTID parts, const char *partdesc) {
   AVRPART *p = NULL;
   int found = 0;
@@ -1027,6 +1266,12 @@ AVRPART *locate_part(const LISTID parts, const char *partdesc) {
   if(!parts || !partdesc)
     return NULL;
 
+  if(parts_indexed(parts)) {
+    Hash_entry *e = hash_get(cx->avr_ixname, partdesc, strlen(partdesc));
+
+    return e? e->first: NULL;
+  }
+
   for(LNODEID ln1 = lfirst(parts); ln1 && !found; ln1 = lnext(ln1)) {
     p = ldata(ln1);
     if(part_eq(p, partdesc, str_caseeq))
@@ -1037,6 +1282,12 @@ AVRPART *locate_part(const LISTID parts, const char *partdesc) {
 }
 
 AVRPART *locate_part_by_avr910_devcode(const LISTID parts, int devcode) {
+  if(parts_indexed(parts)) {
+    Hash_entry *e = hash_get(cx->avr_ixdevcode, &devcode, sizeof devcode);
+
+    return e? e->first: NULL;
+  }
+
   if(parts)
     for(LNODEID ln1 = lfirst(parts); ln1; ln1 = lnext(ln1)) {
       AVRPART *p = ldata(ln1);
@@ -1048,17 +1299,30 @@ AVRPART *locate_part_by_avr910_devcode(const LISTID parts, int devcode) {
   return NULL;
 }
 
+// Whether part p can be found by its signature
+static int part_has_signature(const AVRPART *p) {
+  if(!*p->id || *p->id == '.')  // Skip stump entries
+    return 0;
+  return !is_memset(p->signature, 0xff, 3) && !is_memset(p->signature, 0, 3);
+}
+
 // Return pointer to first part that has signature sig (unless all 0xff or all 0x00); NULL if no match
 AVRPART *locate_part_by_signature_pm(const LISTID parts, unsigned char *sig, int sigsize, int prog_modes) {
   if(parts && sigsize == 3) {
+    if(parts_indexed(parts)) {  // Table has first part with sig: only walk list if prog_modes don't fit
+      Hash_entry *e = hash_get(cx->avr_ixsig, sig, 3);
+
+      if(!e)
+        return NULL;
+      if(((AVRPART *) e->first)->prog_modes & prog_modes)
+        return e->first;
+    }
+
     for(LNODEID ln = lfirst(parts); ln; ln = lnext(ln)) {
       AVRPART *p = ldata(ln);
 
-      if(!*p->id || *p->id == '.')      // Skip stump entries
-        continue;
-      if(!is_memset(p->signature, 0xff, 3) && !is_memset(p->signature, 0, 3))
-        if(!memcmp(p->signature, sig, 3) && p->prog_modes & prog_modes)
-          return p;
+      if(part_has_signature(p) && !memcmp(p->signature, sig, 3) && p->prog_modes & prog_modes)
+        return p;
     }
   }
   return NULL;
@@ -1142,6 +1406,69 @@ static int sort_avrparts_compare(const AVRPART *p1, const AVRPART *p2) {
 // Sort the list avrparts of parts
 void sort_avrparts(LISTID avrparts) {
   lsort(avrparts, (int (*)(void *, void *)) sort_avrparts_compare);
+  if(avrparts && avrparts == cx->avr_ixparts)   // First match in list order may have changed
+    index_avrparts(avrparts);
+}
+
+// Store p under key unless an earlier part has that key
+static void index_part(Hash_table *t, const void *key, size_t len, AVRPART *p) {
+  Hash_entry *e = hash_put(t, key, len);
+
+  if(!e->n++)
+    e->first = p;
+}
+
+/*
+ * Build lookup tables for locate_part(), locate_part_by_signature_pm() and
+ * locate_part_by_avr910_devcode() for the list avrparts, and lookup tables for
+ * each part's memories. Each table entry holds the first part in list order
+ * matching the key, so lookups return the same part as walking the list. Call
+ * once all configuration files have been read and memories have been sorted,
+ * before any threads are started. Reading a configuration file drops the
+ * tables, as does index_avrparts(NULL).
+ */
+void index_avrparts(LISTID avrparts) {
+  if(cx->avr_ixparts)
+    for(LNODEID ln = lfirst(cx->avr_ixparts); ln; ln = lnext(ln))
+      free_mem_index(ldata(ln));
+  hash_free(cx->avr_ixname);
+  hash_free(cx->avr_ixsig);
+  hash_free(cx->avr_ixdevcode);
+  cx->avr_ixname = cx->avr_ixsig = cx->avr_ixdevcode = NULL;
+  cx->avr_ixparts = NULL;
+
+  if(!avrparts)
+    return;
+
+  cx->avr_ixparts = avrparts;
+  cx->avr_ixnparts = lsize(avrparts);
+  cx->avr_ixname = hash_new(1);
+  cx->avr_ixsig = hash_new(0);
+  cx->avr_ixdevcode = hash_new(0);
+
+  for(LNODEID ln = lfirst(avrparts); ln; ln = lnext(ln)) {
+    AVRPART *p = ldata(ln);
+    size_t desclen = strlen(p->desc), variantlen, dashlen;
+
+    index_mems(p);
+    index_part(cx->avr_ixname, p->id, strlen(p->id), p);
+    index_part(cx->avr_ixname, p->desc, desclen, p);
+    // Same variant names as in part_eq()
+    for(LNODEID lv = lfirst(p->variants); lv; lv = lnext(lv)) {
+      const char *q = (const char *) ldata(lv), *qdash = strchr(q, '-'), *qcolon = strchr(q, ':');
+
+      variantlen = qcolon? (size_t) (qcolon - q): strlen(q);
+      dashlen = qdash? (size_t) (qdash - q): variantlen;
+      if(variantlen < 1024 && (variantlen != desclen || memcmp(q, p->desc, desclen))) {
+        index_part(cx->avr_ixname, q, variantlen, p);
+        if(dashlen > desclen && dashlen < variantlen)
+          index_part(cx->avr_ixname, q, dashlen, p);
+      }
+    }
+    index_part(cx->avr_ixdevcode, &p->avr910_devcode, sizeof p->avr910_devcode, p);
+    if(part_has_signature(p))
+      index_part(cx->avr_ixsig, p->signature, 3, p);
+  }
 }
 
 void avr_display(FILE *f, const PROGRAMMER *pgm, const AVRPART *p, const char *prefix, int verbose) {
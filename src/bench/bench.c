@@ -0,0 +1,160 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ac_cfg.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "bench.h"
+
+// Globals that libavrdude expects the application to provide, cf main.c
+char *progname = "bench";
+LIBAVRDUDE_TLS int verbose;
+LIBAVRDUDE_TLS int quell_progress;
+int ovsigck;
+const char *partdesc = "";
+const char *pgmid = "";
+LIBAVRDUDE_TLS libavrdude_context *cx;
+
+// Show errors, warnings and info messages; more with higher verbose level
+int avrdude_message2(FILE *fp, int lno, const char *file, const char *func, int msgmode, int msglvl,
+  const char *format, ...) {
+
+  int rc = 0;
+  va_list ap;
+
+  if(msglvl <= verbose) {
+    if(*format == '\v')
+      format++;
+    if(msgmode & MSG2_FUNCTION)
+      fprintf(fp, "%s %s(): ", progname, func);
+    va_start(ap, format);
+    rc = vfprintf(fp, format, ap);
+    va_end(ap);
+  }
+
+  return rc;
+}
+
+double bench_now(void) {
+#if defined(WIN32)
+  LARGE_INTEGER freq, count;
+
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double) count.QuadPart/freq.QuadPart;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+#endif
+}
+
+#ifdef BENCH_WRAP_MALLOC
+// Count allocations of code linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+static _Atomic long nallocs;    // Atomic as bench_threads allocates from several threads
+
+void *__real_malloc(size_t n);
+void *__real_calloc(size_t n, size_t s);
+void *__real_realloc(void *ptr, size_t n);
+
+void *__wrap_malloc(size_t n) {
+  nallocs++;
+  return __real_malloc(n);
+}
+
+void *__wrap_calloc(size_t n, size_t s) {
+  nallocs++;
+  return __real_calloc(n, s);
+}
+
+void *__wrap_realloc(void *ptr, size_t n) {
+  nallocs++;
+  return __real_realloc(ptr, n);
+}
+
+long bench_allocs(void) {
+  return nallocs;
+}
+#else
+long bench_allocs(void) {
+  return -1;
+}
+#endif
+
+long bench_peak_rss(void) {
+#if defined(WIN32)
+  return -1;
+#else
+  struct rusage ru;
+
+  if(getrusage(RUSAGE_SELF, &ru) < 0)
+    return -1;
+#if defined(__APPLE__)
+  return ru.ru_maxrss/1024;     // Bytes on macOS
+#else
+  return ru.ru_maxrss;
+#endif
+#endif
+}
+
+int bench_init(const char *name, const char *conffile) {
+  progname = (char *) name;
+  init_cx(NULL);
+
+  avrdude_conf_version = "";
+  default_programmer = "";
+  default_parallel = "";
+  default_serial = "";
+  default_spi = "";
+  default_linuxgpio = "";
+  init_config();
+
+  if(read_config(conffile)) {
+    pmsg_error("unable to process configuration file %s\n", conffile);
+    return -1;
+  }
+
+  return 0;
+}
+
+void bench_json(FILE *f, const char *bench, const char *name, const char *fmt, ...) {
+  va_list ap;
+
+  fprintf(f, "{\"bench\": \"%s\", \"name\": \"%s\"", bench, name);
+  if(fmt && *fmt) {
+    fprintf(f, ", ");
+    va_start(ap, fmt);
+    vfprintf(f, fmt, ap);
+    va_end(ap);
+  }
+  fprintf(f, "}\n");
+}
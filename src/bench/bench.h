@@ -0,0 +1,45 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Common glue for the benchmark programs built on libavrdude
+
+#ifndef bench_h
+#define bench_h
+
+#include <stdio.h>
+
+#include "libavrdude.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // Set up cx and read the configuration file(s) like main.c does
+  int bench_init(const char *progname, const char *conffile);
+
+  double bench_now(void);       // Monotonic time in seconds
+  long bench_allocs(void);      // Number of malloc()/calloc()/realloc() calls so far, -1 if unknown
+  long bench_peak_rss(void);    // Peak resident set size in kB so far, -1 if unknown
+
+  // Minimal JSON output: one object per measurement on its own line
+  void bench_json(FILE *f, const char *bench, const char *name, const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,178 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmark of part, programmer and memory lookups on a real parsed
+ * avrdude.conf with and without the lookup tables of index_avrparts() and
+ * index_programmers()
+ *
+ * Looks up every part by id and desc, by signature and by avr910 devcode,
+ * every programmer by its first id, and in each part every memory by name, by
+ * a 3-character prefix and by type as avr_locate_flash() and friends do.
+ * Reports the best time per lookup out of -n runs and checks that both ways
+ * yield the same results.
+ *
+ * Usage: bench_lookup [-n <runs>] [-v] <avrdude.conf>
+ */
+
+#include <ac_cfg.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "bench.h"
+
+static uintptr_t lookup_parts(void) {
+  uintptr_t sum = 0;
+
+  for(LNODEID ln = lfirst(part_list); ln; ln = lnext(ln)) {
+    AVRPART *p = ldata(ln);
+
+    sum += (uintptr_t) locate_part(part_list, p->id);
+    sum += (uintptr_t) locate_part(part_list, p->desc);
+  }
+  return sum;
+}
+
+static uintptr_t lookup_signatures(void) {
+  uintptr_t sum = 0;
+
+  for(LNODEID ln = lfirst(part_list); ln; ln = lnext(ln)) {
+    AVRPART *p = ldata(ln);
+
+    sum += (uintptr_t) locate_part_by_signature(part_list, p->signature, 3);
+    sum += (uintptr_t) locate_part_by_avr910_devcode(part_list, p->avr910_devcode);
+  }
+  return sum;
+}
+
+static uintptr_t lookup_programmers(void) {
+  uintptr_t sum = 0;
+
+  for(LNODEID ln = lfirst(programmers); ln; ln = lnext(ln))
+    sum += (uintptr_t) locate_programmer(programmers, ldata(lfirst(((PROGRAMMER *) ldata(ln))->id)));
+  return sum;
+}
+
+// A session works on one part: repeat the memory lookups for each part REPEAT times
+#define REPEAT 8
+
+static uintptr_t lookup_mems(void) {
+  uintptr_t sum = 0;
+  char prefix[4];
+
+  for(LNODEID ln = lfirst(part_list); ln; ln = lnext(ln)) {
+    AVRPART *p = ldata(ln);
+
+    for(int r = 0; r < REPEAT; r++)
+      for(LNODEID lm = lfirst(p->mem); lm; lm = lnext(lm)) {
+        AVRMEM *m = ldata(lm);
+
+        snprintf(prefix, sizeof prefix, "%s", m->desc);
+        sum += (uintptr_t) avr_locate_mem(p, m->desc);
+        sum += (uintptr_t) avr_locate_mem(p, prefix);
+      }
+  }
+  return sum;
+}
+
+static uintptr_t lookup_types(void) {
+  uintptr_t sum = 0;
+
+  for(LNODEID ln = lfirst(part_list); ln; ln = lnext(ln)) {
+    AVRPART *p = ldata(ln);
+
+    for(int r = 0; r < REPEAT; r++) {
+      sum += (uintptr_t) avr_locate_flash(p);
+      sum += (uintptr_t) avr_locate_eeprom(p);
+      sum += (uintptr_t) avr_locate_signature(p);
+      sum += (uintptr_t) avr_locate_lock(p);
+      sum += (uintptr_t) avr_locate_hfuse(p);
+      sum += (uintptr_t) avr_locate_bootend(p);
+    }
+  }
+  return sum;
+}
+
+static void report(const char *name, uintptr_t (*fn)(void), int nlookups, int runs) {
+  double best[2] = { 1e9, 1e9 };
+  uintptr_t sum[2] = { 0, 0 };
+
+  for(int indexed = 0; indexed < 2; indexed++) {
+    index_avrparts(indexed? part_list: NULL);
+    index_programmers(indexed? programmers: NULL);
+    for(int r = 0; r < runs; r++) {
+      double t0 = bench_now();
+
+      sum[indexed] = fn();
+      t0 = bench_now() - t0;
+      if(t0 < best[indexed])
+        best[indexed] = t0;
+    }
+  }
+
+  if(sum[0] != sum[1])
+    pmsg_error("%s lookups differ with and without index\n", name);
+  bench_json(stdout, "lookup", name, "\"lookups\": %d, \"runs\": %d, \"linear_ns\": %.1f, \"indexed_ns\": %.1f, "
+    "\"speedup\": %.2f, \"same\": %s", nlookups, runs, best[0]*1e9/nlookups, best[1]*1e9/nlookups,
+    best[1] > 0? best[0]/best[1]: 0.0, sum[0] == sum[1]? "true": "false");
+}
+
+int main(int argc, char **argv) {
+  int runs = 20, c, nmems = 0;
+
+  while((c = getopt(argc, argv, "n:v")) != -1) {
+    switch(c) {
+    case 'n':
+      runs = atoi(optarg);
+      break;
+    case 'v':
+      verbose++;
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-n <runs>] [-v] <avrdude.conf>\n", argv[0]);
+      return 1;
+    }
+  }
+  if(optind != argc - 1 || runs < 1) {
+    fprintf(stderr, "Usage: %s [-n <runs>] [-v] <avrdude.conf>\n", argv[0]);
+    return 1;
+  }
+
+  if(bench_init("bench_lookup", argv[optind]) < 0)
+    return 1;
+
+  for(LNODEID ln = lfirst(part_list); ln; ln = lnext(ln)) {
+    AVRPART *p = ldata(ln);
+
+    lsort(p->mem, avr_mem_cmp);
+    nmems += lsize(p->mem);
+  }
+
+  report("parts", lookup_parts, 2*lsize(part_list), runs);
+  report("signatures", lookup_signatures, 2*lsize(part_list), runs);
+  report("programmers", lookup_programmers, lsize(programmers), runs);
+  report("memories", lookup_mems, 2*REPEAT*nmems, runs);
+  report("memory types", lookup_types, 6*REPEAT*lsize(part_list), runs);
+
+  return 0;
+}
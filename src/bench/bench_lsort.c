@@ -0,0 +1,195 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Microbenchmark of lsort() on the lists of a real parsed avrdude.conf
+ *
+ * Sorts the part list by desc and the programmer list by first id (as
+ * sort_avrparts() and sort_programmers() do) and every part's memory list
+ * with avr_mem_cmp() (as main.c does after reading the configuration).
+ * Each list is rebuilt in configuration-file order before each run. The
+ * previous bubble sort is run on an array copy for reference; both report
+ * the best time out of -n runs and the number of comparator calls.
+ *
+ * Usage: bench_lsort [-n <runs>] [-v] <avrdude.conf>
+ */
+
+#include <ac_cfg.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "bench.h"
+
+static long ncmp;
+static int (*cmpfn)(void *p1, void *p2);
+
+static int counting_cmp(void *p1, void *p2) {
+  ncmp++;
+  return cmpfn(p1, p2);
+}
+
+static int part_cmp(void *p1, void *p2) {
+  return strcasecmp(((AVRPART *) p1)->desc, ((AVRPART *) p2)->desc);
+}
+
+static int pgm_cmp(void *p1, void *p2) {
+  return strcasecmp(ldata(lfirst(((PROGRAMMER *) p1)->id)), ldata(lfirst(((PROGRAMMER *) p2)->id)));
+}
+
+// The bubble sort lsort() used to be, on an array to keep it independent of lists.c
+static void bubble_sort(void **a, int n, int (*compare)(void *p1, void *p2)) {
+  for(int unsorted = 1; unsorted;) {
+    unsorted = 0;
+    for(int i = 0; i + 1 < n; i++)
+      if(compare(a[i], a[i + 1]) > 0) {
+        void *t = a[i];
+
+        a[i] = a[i + 1];
+        a[i + 1] = t;
+        unsorted = 1;
+      }
+  }
+}
+
+typedef struct {
+  double secs;                  // Best time of all runs
+  long ncmp;                    // Comparisons in one run
+} Result;
+
+// Sort nl lists (given as arrays in original order) with either algorithm
+static Result run(void ***arrays, int *sizes, int nl, int (*compare)(void *, void *), int bubble, int runs) {
+  Result res = { 1e9, 0 };
+  LISTID *lists = mmt_malloc(nl*sizeof *lists);
+  void **tmp = NULL;
+  int maxn = 0;
+
+  for(int k = 0; k < nl; k++)
+    maxn = sizes[k] > maxn? sizes[k]: maxn;
+  tmp = mmt_malloc((maxn + 1)*sizeof *tmp);
+
+  cmpfn = compare;
+  for(int r = 0; r < runs; r++) {
+    double secs = 0;
+
+    ncmp = 0;
+    for(int k = 0; k < nl; k++) {
+      double t0;
+
+      if(bubble) {
+        memcpy(tmp, arrays[k], sizes[k]*sizeof *tmp);
+        t0 = bench_now();
+        bubble_sort(tmp, sizes[k], counting_cmp);
+        secs += bench_now() - t0;
+      } else {
+        lists[k] = lcreat(NULL, 0);
+        for(int i = 0; i < sizes[k]; i++)
+          ladd(lists[k], arrays[k][i]);
+        t0 = bench_now();
+        lsort(lists[k], counting_cmp);
+        secs += bench_now() - t0;
+        ldestroy(lists[k]);
+      }
+    }
+    res.ncmp = ncmp;
+    if(secs < res.secs)
+      res.secs = secs;
+  }
+
+  mmt_free(tmp);
+  mmt_free(lists);
+  return res;
+}
+
+static void **list2array(LISTID l, int *np) {
+  void **a = mmt_malloc((lsize(l) + 1)*sizeof *a);
+  int n = 0;
+
+  for(LNODEID ln = lfirst(l); ln; ln = lnext(ln))
+    a[n++] = ldata(ln);
+  *np = n;
+  return a;
+}
+
+static void report(const char *name, void ***arrays, int *sizes, int nl, int (*compare)(void *, void *), int runs) {
+  int total = 0;
+
+  for(int k = 0; k < nl; k++)
+    total += sizes[k];
+
+  Result mrg = run(arrays, sizes, nl, compare, 0, runs);
+  Result bub = run(arrays, sizes, nl, compare, 1, runs);
+
+  bench_json(stdout, "lsort", name, "\"lists\": %d, \"elements\": %d, \"runs\": %d, "
+    "\"lsort_us\": %.2f, \"lsort_cmps\": %ld, \"bubble_us\": %.2f, \"bubble_cmps\": %ld, \"speedup\": %.2f",
+    nl, total, runs, mrg.secs*1e6, mrg.ncmp, bub.secs*1e6, bub.ncmp, mrg.secs > 0? bub.secs/mrg.secs: 0.0);
+}
+
+int main(int argc, char **argv) {
+  int runs = 20, c, n;
+
+  while((c = getopt(argc, argv, "n:v")) != -1) {
+    switch(c) {
+    case 'n':
+      runs = atoi(optarg);
+      break;
+    case 'v':
+      verbose++;
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-n <runs>] [-v] <avrdude.conf>\n", argv[0]);
+      return 1;
+    }
+  }
+  if(optind != argc - 1 || runs < 1) {
+    fprintf(stderr, "Usage: %s [-n <runs>] [-v] <avrdude.conf>\n", argv[0]);
+    return 1;
+  }
+
+  if(bench_init("bench_lsort", argv[optind]) < 0)
+    return 1;
+
+  void **parts = list2array(part_list, &n);
+
+  report("parts", &parts, &n, 1, part_cmp, runs);
+
+  void **pgms = list2array(programmers, &n);
+
+  report("programmers", &pgms, &n, 1, pgm_cmp, runs);
+
+  int nl = lsize(part_list), k = 0;
+  void ***mems = mmt_malloc(nl*sizeof *mems);
+  int *sizes = mmt_malloc(nl*sizeof *sizes);
+
+  for(LNODEID ln = lfirst(part_list); ln; ln = lnext(ln))
+    mems[k] = list2array(((AVRPART *) ldata(ln))->mem, sizes + k), k++;
+  report("part memories", mems, sizes, nl, avr_mem_cmp, runs);
+
+  for(k = 0; k < nl; k++)
+    mmt_free(mems[k]);
+  mmt_free(mems);
+  mmt_free(sizes);
+  mmt_free(pgms);
+  mmt_free(parts);
+
+  return 0;
+}
@@ -0,0 +1,309 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Throughput benchmark of reading, writing and verifying a part's flash
+ * through libavrdude without process startup or command line parsing
+ *
+ * Sets up the programmer as main.c does (default dryrun, which can be given
+ * -x timing parameters) and times, for a full-size flash image of random
+ * data, the phases
+ *   - fileio_write: fileio_mem() writing the image to an Intel Hex file
+ *   - fileio_read: fileio_mem() reading that file back
+ *   - avr_write_mem: writing the image to the erased device
+ *   - avr_read_mem: reading the device into a memory copy
+ *   - avr_flush_cache: writing each byte with avr_write_byte_cached() and flushing
+ *   - do_op: -U flash:w:<file>:i with verification, as from the command line
+ * Reports the best time out of -n runs, bytes/s, programmer calls per page,
+ * allocations of the best run and peak resident set size as one JSON line
+ * per phase. Other programmers, eg, serial-port stand-ins, can be selected
+ * with -c and -P; -v shows the commentary, eg, simulated time with -x timing.
+ *
+ * Usage: bench_rw [-c <programmer>] [-P <port>] [-p <part>] [-x <extparam>]
+ *          [-n <runs>] [-s <seed>] [-v] <avrdude.conf>
+ */
+
+#include <ac_cfg.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "bench.h"
+
+// Programmer calls during one run
+static long npaged_write, npaged_load, nbyte;
+
+static int (*orig_paged_write)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int baseaddr, unsigned int n_bytes);
+static int (*orig_paged_load)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int baseaddr, unsigned int n_bytes);
+static int (*orig_write_byte)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned long addr, unsigned char value);
+static int (*orig_read_byte)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned long addr, unsigned char *value);
+
+static int counting_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int baseaddr, unsigned int n_bytes) {
+
+  npaged_write++;
+  return orig_paged_write(pgm, p, m, page_size, baseaddr, n_bytes);
+}
+
+static int counting_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int baseaddr, unsigned int n_bytes) {
+
+  npaged_load++;
+  return orig_paged_load(pgm, p, m, page_size, baseaddr, n_bytes);
+}
+
+static int counting_write_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned long addr, unsigned char value) {
+
+  nbyte++;
+  return orig_write_byte(pgm, p, m, addr, value);
+}
+
+static int counting_read_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned long addr, unsigned char *value) {
+
+  nbyte++;
+  return orig_read_byte(pgm, p, m, addr, value);
+}
+
+static void count_calls(PROGRAMMER *pgm) {
+  if((orig_paged_write = pgm->paged_write))
+    pgm->paged_write = counting_paged_write;
+  if((orig_paged_load = pgm->paged_load))
+    pgm->paged_load = counting_paged_load;
+  if((orig_write_byte = pgm->write_byte))
+    pgm->write_byte = counting_write_byte;
+  if((orig_read_byte = pgm->read_byte))
+    pgm->read_byte = counting_read_byte;
+}
+
+typedef enum {
+  PH_FILEIO_WRITE,
+  PH_FILEIO_READ,
+  PH_WRITE_MEM,
+  PH_READ_MEM,
+  PH_FLUSH_CACHE,
+  PH_DO_OP,
+} Phase;
+
+static const char *phase_name[] = {
+  "fileio_write", "fileio_read", "avr_write_mem", "avr_read_mem", "avr_flush_cache", "do_op",
+};
+
+typedef struct {
+  const PROGRAMMER *pgm;
+  const AVRPART *p;
+  AVRMEM *flm;                  // The part's flash, holding the image
+  unsigned char *image;         // Random flash contents
+  const char *hexfile;          // Temporary Intel Hex file of the image
+} Bench;
+
+// Run one phase once; return negative on error
+static int run_phase(const Bench *b, Phase ph) {
+  const PROGRAMMER *pgm = b->pgm;
+  const AVRPART *p = b->p;
+  AVRMEM *flm = b->flm;
+  int size = flm->size, rc = 0;
+
+  switch(ph) {
+  case PH_FILEIO_WRITE:
+    memcpy(flm->buf, b->image, size);
+    avr_tag_range(flm, 0, size, 1);
+    return fileio_mem(FIO_WRITE, b->hexfile, FMT_IHEX, p, flm, size);
+
+  case PH_FILEIO_READ:
+    return fileio_mem(FIO_READ, b->hexfile, FMT_IHEX, p, flm, -1);
+
+  case PH_WRITE_MEM:
+    memcpy(flm->buf, b->image, size);
+    avr_tag_range(flm, 0, size, 1);
+    return avr_write_mem(pgm, p, flm, size, 1);
+
+  case PH_READ_MEM:
+    return avr_read_mem(pgm, p, flm, NULL);
+
+  case PH_FLUSH_CACHE:
+    for(int i = 0; i < size && rc >= 0; i++)
+      rc = avr_write_byte_cached(pgm, p, flm, i, b->image[size - 1 - i]);
+    if(rc >= 0)
+      rc = avr_flush_cache(pgm, p);
+    avr_reset_cache(pgm, p);
+    return rc;
+
+  case PH_DO_OP:
+    {
+      UPDATE *upd = new_update(DEVICE_WRITE, flm->desc, FMT_IHEX, b->hexfile);
+
+      rc = do_op(pgm, p, upd, UF_AUTO_ERASE | UF_VERIFY);
+      free_update(upd);
+      return rc;
+    }
+  }
+
+  return -1;
+}
+
+static int report(const Bench *b, Phase ph, int runs) {
+  double best = 1e9;
+  long calls[3] = { 0, 0, 0 }, allocs = 0;
+  int size = b->flm->size, npages = b->flm->page_size > 0? (size + b->flm->page_size - 1)/b->flm->page_size: size;
+
+  for(int r = 0; r < runs; r++) {
+    long a0 = bench_allocs();
+
+    npaged_write = npaged_load = nbyte = 0;
+    if(ph != PH_FILEIO_WRITE && ph != PH_FILEIO_READ && ph != PH_READ_MEM && avr_chip_erase(b->pgm, b->p) < 0)
+      return -1;
+
+    double t0 = bench_now();
+
+    if(run_phase(b, ph) < 0) {
+      pmsg_error("phase %s failed\n", phase_name[ph]);
+      return -1;
+    }
+    t0 = bench_now() - t0;
+    if(t0 < best) {
+      best = t0;
+      calls[0] = npaged_write, calls[1] = npaged_load, calls[2] = nbyte;
+      allocs = a0 < 0? -1: bench_allocs() - a0;
+    }
+  }
+
+  bench_json(stdout, "rw", phase_name[ph], "\"part\": \"%s\", \"programmer\": \"%s\", \"bytes\": %d, "
+    "\"runs\": %d, \"secs\": %.6f, \"bytes_per_s\": %.0f, \"paged_writes\": %ld, \"paged_loads\": %ld, "
+    "\"byte_calls\": %ld, \"calls_per_page\": %.3f, \"allocs\": %ld, \"peak_rss_kb\": %ld",
+    b->p->id, pgmid, size, runs, best, best > 0? size/best: 0.0, calls[0], calls[1], calls[2],
+    (double) (calls[0] + calls[1] + calls[2])/npages, allocs, bench_peak_rss());
+
+  return 0;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-c <programmer>] [-P <port>] [-p <part>] [-x <extparam>]\n"
+    "         [-n <runs>] [-s <seed>] [-v] <avrdude.conf>\n", name);
+}
+
+int main(int argc, char **argv) {
+  int runs = 5, seed = 1, c, rc = 1;
+  const char *port = NULL;
+  LISTID xparams = lcreat(NULL, 0);
+  char hexfile[1024];
+
+  pgmid = "dryrun";
+  partdesc = "m328p";
+  verbose = -1;                 // Quieten the commentary of do_op() and friends unless -v
+  while((c = getopt(argc, argv, "c:P:p:x:n:s:v")) != -1) {
+    switch(c) {
+    case 'c':
+      pgmid = optarg;
+      break;
+    case 'P':
+      port = optarg;
+      break;
+    case 'p':
+      partdesc = optarg;
+      break;
+    case 'x':
+      ladd(xparams, optarg);
+      break;
+    case 'n':
+      runs = atoi(optarg);
+      break;
+    case 's':
+      seed = atoi(optarg);
+      break;
+    case 'v':
+      verbose++;
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if(optind != argc - 1 || runs < 1) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  if(bench_init("bench_rw", argv[optind]) < 0)
+    return 1;
+
+  PROGRAMMER *pgm = locate_programmer(programmers, pgmid);
+  AVRPART *p = locate_part(part_list, partdesc);
+  AVRMEM *flm;
+
+  if(!pgm || !pgm->initpgm) {
+    pmsg_error("cannot find programmer %s\n", pgmid);
+    return 1;
+  }
+  if(!p || !(flm = avr_locate_flash(p)) || flm->size < 1) {
+    pmsg_error("cannot find part %s or its flash\n", partdesc);
+    return 1;
+  }
+
+  pgm->initpgm(pgm);
+  if(pgm->setup)
+    pgm->setup(pgm);
+  if(lsize(xparams) && (!pgm->parseextparams || pgm->parseextparams(pgm, xparams) < 0)) {
+    pmsg_error("unable to parse list of -x parameters\n");
+    return 1;
+  }
+  count_calls(pgm);
+
+  if(avr_initmem(p) < 0 || pgm->open(pgm, port) < 0) {
+    pmsg_error("unable to open programmer %s\n", pgmid);
+    return 1;
+  }
+  pgm->enable(pgm, p);
+  if(pgm->initialize(pgm, p) < 0) {
+    pmsg_error("unable to initialise %s with %s\n", p->desc, pgmid);
+    goto done;
+  }
+
+  snprintf(hexfile, sizeof hexfile, "%s/bench_rw_%d.hex", getenv("TMPDIR")? getenv("TMPDIR"): "/tmp", (int) getpid());
+
+  Bench b = { pgm, p, flm, mmt_malloc(flm->size), hexfile };
+
+  srand(seed);
+  for(int i = 0; i < flm->size; i++)
+    b.image[i] = rand();
+
+  rc = 0;
+  for(Phase ph = PH_FILEIO_WRITE; ph <= PH_DO_OP && !rc; ph++)
+    rc = report(&b, ph, runs) < 0;
+
+  unlink(hexfile);
+  mmt_free(b.image);
+
+done:
+  pgm->disable(pgm);
+  pgm->close(pgm);
+  if(pgm->teardown)
+    pgm->teardown(pgm);
+  ldestroy(xparams);
+
+  return rc;
+}
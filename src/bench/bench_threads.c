@@ -0,0 +1,205 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Regression test and benchmark of concurrent libavrdude sessions
+ *
+ * Programs -t dryrun targets from as many threads, each with its own context
+ * from init_cx() and its own copies of programmer and part. Every session
+ * erases the chip, writes its own random full-size flash image with
+ * avr_write_mem(), reads the flash back with avr_read_mem() and compares.
+ * The same sessions are then run one after the other in the main thread.
+ * Reports both times and whether all targets held their own image as one
+ * JSON line; exits with 1 if any session failed.
+ *
+ * Usage: bench_threads [-p <part>] [-t <threads>] [-x <extparam>] [-v] <avrdude.conf>
+ */
+
+#include <ac_cfg.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "bench.h"
+
+typedef struct {
+  unsigned int seed;            // Seed of this session's flash image
+  int verbose;                  // Verbosity level for the session's thread
+  LISTID xparams;               // Shared -x parameters, read only
+  int ok;                       // Set when the target held the image afterwards
+} Session;
+
+// One programming session on its own context, programmer and part
+static void *session(void *arg) {
+  Session *s = arg;
+  PROGRAMMER *pgm;
+  AVRPART *p;
+  AVRMEM *flm;
+  unsigned char *image;
+
+  init_cx(NULL);
+  verbose = s->verbose;
+  s->ok = 0;
+
+  pgm = pgm_dup(locate_programmer(programmers, "dryrun"));
+  p = avr_dup_part(locate_part(part_list, partdesc));
+  if(!pgm->initpgm || !(flm = avr_locate_flash(p)) || flm->size < 1) {
+    pmsg_error("cannot find dryrun programmer or flash of part %s\n", partdesc);
+    goto free;
+  }
+
+  pgm->initpgm(pgm);
+  if(pgm->setup)
+    pgm->setup(pgm);
+  if(lsize(s->xparams) && (!pgm->parseextparams || pgm->parseextparams(pgm, s->xparams) < 0)) {
+    pmsg_error("unable to parse list of -x parameters\n");
+    goto teardown;
+  }
+  if(avr_initmem(p) < 0 || pgm->open(pgm, NULL) < 0) {
+    pmsg_error("unable to open programmer\n");
+    goto teardown;
+  }
+  pgm->enable(pgm, p);
+
+  image = mmt_malloc(flm->size);
+  for(int i = 0; i < flm->size; i++)
+    image[i] = rand_r(&s->seed);
+
+  if(pgm->initialize(pgm, p) >= 0 && avr_chip_erase(pgm, p) >= 0) {
+    memcpy(flm->buf, image, flm->size);
+    avr_tag_range(flm, 0, flm->size, 1);
+    if(avr_write_mem(pgm, p, flm, flm->size, 1) >= 0) {
+      memset(flm->buf, 0, flm->size);
+      if(avr_read_mem(pgm, p, flm, NULL) >= 0)
+        s->ok = !memcmp(flm->buf, image, flm->size);
+    }
+  }
+  if(!s->ok)
+    pmsg_error("session with seed %u failed\n", s->seed);
+
+  mmt_free(image);
+  pgm->disable(pgm);
+  pgm->close(pgm);
+
+teardown:
+  if(pgm->teardown)
+    pgm->teardown(pgm);
+
+free:
+  pgm_free(pgm);
+  avr_free_part(p);
+  free_cx();
+
+  return NULL;
+}
+
+// Run n sessions, in parallel if threaded; return the number of failed ones
+static int run_sessions(Session *ss, int n, int threaded, int verb, LISTID xparams, double *secs) {
+  pthread_t *tids = mmt_malloc(n*sizeof *tids);
+  int nfail = 0;
+  double t0 = bench_now();
+
+  for(int i = 0; i < n; i++) {
+    ss[i] = (Session) { .seed = 1000 + i, .verbose = verb, .xparams = xparams };
+    if(!threaded) {             // Run in this thread but keep its context
+      libavrdude_context *main_cx = cx;
+
+      cx = NULL;
+      session(ss + i);
+      cx = main_cx;
+    } else if(pthread_create(tids + i, NULL, session, ss + i)) {
+      pmsg_error("cannot create thread %d\n", i);
+      n = i;
+      nfail++;
+    }
+  }
+  if(threaded)
+    for(int i = 0; i < n; i++)
+      pthread_join(tids[i], NULL);
+  *secs = bench_now() - t0;
+
+  for(int i = 0; i < n; i++)
+    nfail += !ss[i].ok;
+  mmt_free(tids);
+
+  return nfail;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-p <part>] [-t <threads>] [-x <extparam>] [-v] <avrdude.conf>\n", name);
+}
+
+int main(int argc, char **argv) {
+  int nthreads = 4, c, nfail[2];
+  double secs[2];
+  LISTID xparams = lcreat(NULL, 0);
+
+  partdesc = "m328p";
+  verbose = -1;
+  while((c = getopt(argc, argv, "p:t:x:v")) != -1) {
+    switch(c) {
+    case 'p':
+      partdesc = optarg;
+      break;
+    case 't':
+      nthreads = atoi(optarg);
+      break;
+    case 'x':
+      ladd(xparams, optarg);
+      break;
+    case 'v':
+      verbose++;
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if(optind != argc - 1 || nthreads < 1) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // The configuration is read once here and shared read-only by all sessions
+  if(bench_init("bench_threads", argv[optind]) < 0)
+    return 1;
+  if(!locate_part(part_list, partdesc) || !locate_programmer(programmers, "dryrun")) {
+    pmsg_error("cannot find part %s or the dryrun programmer\n", partdesc);
+    return 1;
+  }
+
+  Session *ss = mmt_malloc(nthreads*sizeof *ss);
+
+  nfail[0] = run_sessions(ss, nthreads, 1, verbose, xparams, secs + 0);
+  nfail[1] = run_sessions(ss, nthreads, 0, verbose, xparams, secs + 1);
+
+  bench_json(stdout, "threads", "dryrun", "\"part\": \"%s\", \"sessions\": %d, \"parallel_secs\": %.6f, "
+    "\"serial_secs\": %.6f, \"speedup\": %.2f, \"parallel_failed\": %d, \"serial_failed\": %d, \"ok\": %s",
+    partdesc, nthreads, secs[0], secs[1], secs[0] > 0? secs[1]/secs[0]: 0.0, nfail[0], nfail[1],
+    nfail[0] || nfail[1]? "false": "true");
+
+  mmt_free(ss);
+  ldestroy(xparams);
+
+  return nfail[0] || nfail[1];
+}
@@ -0,0 +1,591 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Emulator of an optiboot-style STK500v1 or an urboot bootloader on a pty
+ *
+ * Opens a pty, prints the name of its slave device on stdout and then
+ * answers the STK500v1 subset that optiboot implements or, with -u, the
+ * urprotocol of an urboot v8.0 bootloader, so that, eg,
+ *
+ *   $ stk500emu -p m328p avrdude.conf &
+ *   /dev/pts/3
+ *   $ avrdude -c arduino -x noautoreset -p m328p -P /dev/pts/3 -U flash:w:blink.hex
+ *   $ avrdude -c urclock -x bootsize=512 -x noautoreset -p m328p -P /dev/pts/3 -U ...
+ *
+ *   $ stk500emu -u -p m328p avrdude.conf &
+ *   /dev/pts/4
+ *   $ avrdude -c urclock -x noautoreset -p m328p -P /dev/pts/4 -U flash:w:blink.hex
+ *
+ * run end to end without hardware. Memories are held by an instance of the
+ * dryboot programmer, so they behave as with -c dryboot and persist across
+ * avrdude sessions until the emulator is terminated. On parts that erase
+ * several pages at once, eg, ATtiny1634, writing the first page of such a
+ * group erases the whole group, as optiboot does. The urboot bootloader
+ * occupies the top 512 bytes of flash (rounded up to whole pages), can read
+ * flash, read and write EEPROM and chip erase, and protects itself from being
+ * overwritten. It announces the part's mcuid and these features through its
+ * protocol bytes, and its size and capabilities in the top six bytes of flash
+ * as real urboot bootloaders do. Options:
+ *   -u            emulate an urboot bootloader with urprotocol; needs a classic part
+ *   -p <part>     emulated part (default m328p)
+ *   -b <baud>     emulate a serial line of <baud> with 10 bits per byte each way
+ *   -l <us>       delay each response by <us> microseconds, eg, USB latency
+ *   -w <us>       time to erase and write a flash page (default 0)
+ *   -e <us>       time to write an EEPROM byte (default 0)
+ *   -x <param>    extended parameter for dryboot, eg, -x init or -x random=1
+ *   -v            log commands on stderr
+ * The device handles one command at a time, but responses travel in parallel
+ * with the next commands, so streamed commands (avrdude -x pipeline) overlap
+ * the latency as they would with real hardware. The emulator runs until it is
+ * terminated by a signal.
+ *
+ * Usage: stk500emu [-u] [-p <part>] [-b <baud>] [-l <us>] [-w <us>] [-e <us>] [-x <param>] [-v]
+ *          <avrdude.conf>
+ */
+
+#define _GNU_SOURCE             // For posix_openpt() and friends with glibc
+
+#include <ac_cfg.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "stk500_private.h"
+#include "urclock_private.h"
+#include "bench.h"
+
+// Optiboot version reported via Parm_STK_SW_MAJOR/MINOR and stored at the top of flash
+#define EMU_MAJVER 8
+#define EMU_MINVER 3
+
+// Urboot v8.0 bootloader: version byte, capabilities and urprotocol features
+#define EMU_URVER 0100
+#define EMU_URCAP (UR_EEPROM | UR_PROTECTME | UR_HAS_CE)
+#define EMU_URFEATURES (UB_READ_FLASH | UB_CHIP_ERASE)
+#define EMU_URSIZE 512
+
+// Response waiting for its due time
+typedef struct {
+  double due;
+  int n;
+  unsigned char *buf;
+} Response;
+
+typedef struct {
+  int fd;                       // Master side of the pty
+  unsigned char rbuf[4096];     // Received bytes not yet consumed
+  int rlen, rpos;
+  PROGRAMMER *pgm;              // Dryboot instance holding the memories
+  const AVRPART *p;
+  AVRMEM *flm, *eem;            // Transfer buffers for paged access
+  int a_div;                    // 2: classic parts send word addresses, 1: byte addresses
+  int urboot;                   // Speak urprotocol instead of STK500v1
+  unsigned char insync, ok;     // Protocol bytes, for urprotocol encoding the mcuid and features
+  int blstart;                  // Start of the urboot bootloader in flash, which cannot be written
+  unsigned int addr, ext;       // Last loaded address and extended address byte
+  // Timing model, all times in seconds as returned by bench_now()
+  double bytetime;              // Time of a byte on the serial line, 0 if instantaneous
+  double latency;               // Delay of each response
+  double pagewrite, eewrite;    // NVM times of a flash page and an EEPROM byte
+  double tin;                   // Time the last received byte arrived at the device
+  double tout;                  // Time the device's transmit line becomes free
+  Response *resp;               // FIFO of responses in order of due time
+  int nresp, szresp;
+  long nin, nout;               // Bytes received and sent during the current command
+} Emu;
+
+// Write responses that are due
+static void flush_due(Emu *e) {
+  double now = bench_now();
+  int k;
+
+  for(k = 0; k < e->nresp && e->resp[k].due <= now; k++) {
+    for(int done = 0; done < e->resp[k].n;) {
+      ssize_t w = write(e->fd, e->resp[k].buf + done, e->resp[k].n - done);
+
+      if(w < 0 && errno == EINTR)
+        continue;
+      if(w <= 0) {
+        pmsg_error("cannot write to pty: %s\n", strerror(errno));
+        exit(1);
+      }
+      done += w;
+    }
+    mmt_free(e->resp[k].buf);
+  }
+  if(k) {
+    e->nresp -= k;
+    memmove(e->resp, e->resp + k, e->nresp*sizeof *e->resp);
+  }
+}
+
+// Milliseconds until the next response is due, -1 if there is none
+static int ms_to_due(Emu *e) {
+  if(!e->nresp)
+    return -1;
+
+  double ms = (e->resp[0].due - bench_now())*1e3;
+
+  return ms <= 0? 0: ms + 1;
+}
+
+// Sleep until time t whilst sending responses as they fall due
+static void wait_until(Emu *e, double t) {
+  double now;
+
+  while(flush_due(e), (now = bench_now()) < t) {
+    int ms = ms_to_due(e);
+    double us = (t - now)*1e6;
+
+    usleep(ms >= 0 && ms*1e3 < us? ms*1e3: us);
+  }
+}
+
+static int getch(Emu *e) {
+  while(e->rpos >= e->rlen) {
+    struct pollfd pfd = { e->fd, POLLIN, 0 };
+
+    flush_due(e);
+    if(poll(&pfd, 1, ms_to_due(e)) == 0)
+      continue;
+
+    ssize_t n = read(e->fd, e->rbuf, sizeof e->rbuf);
+
+    if(n < 0 && (errno == EINTR || errno == EAGAIN))
+      continue;
+    if(n <= 0) {
+      pmsg_error("cannot read from pty: %s\n", n < 0? strerror(errno): "end of file");
+      exit(1);
+    }
+    e->rlen = n;
+    e->rpos = 0;
+  }
+  if(e->bytetime) {             // Byte cannot arrive before the previous one plus its transfer time
+    double now = bench_now();
+
+    e->tin = (e->tin > now? e->tin: now) + e->bytetime;
+  }
+  e->nin++;
+  return e->rbuf[e->rpos++];
+}
+
+static void getn(Emu *e, unsigned char *buf, int n) {
+  for(int i = 0; i < n; i++)
+    buf[i] = getch(e);
+}
+
+// Queue a response that is due once the command has arrived, been transmitted back and delayed
+static void respond(Emu *e, const unsigned char *buf, int n) {
+  double now = bench_now(), start;
+
+  if(e->tin > now)              // Command has not fully arrived yet on a slow line
+    wait_until(e, e->tin), now = bench_now();
+  start = e->tout > now? e->tout: now;
+  e->tout = start + n*e->bytetime;
+
+  if(e->nresp == e->szresp)
+    e->resp = mmt_realloc(e->resp, (e->szresp = 2*e->szresp + 8)*sizeof *e->resp);
+  e->resp[e->nresp].due = e->tout + e->latency;
+  e->resp[e->nresp].n = n;
+  e->resp[e->nresp].buf = mmt_malloc(n);
+  memcpy(e->resp[e->nresp++].buf, buf, n);
+  e->nout += n;
+  flush_due(e);
+}
+
+// Consume the command's Sync_CRC_EOP; return 0 if it was there, otherwise send Resp_STK_NOSYNC
+static int eop(Emu *e) {
+  if(getch(e) == Sync_CRC_EOP)
+    return 0;
+
+  unsigned char nosync = Resp_STK_NOSYNC;
+
+  respond(e, &nosync, 1);
+  return -1;
+}
+
+// Send the insync byte, n data bytes and the ok byte (or Resp_STK_FAILED)
+static void reply(Emu *e, const unsigned char *data, int n, int ok) {
+  unsigned char *buf = mmt_malloc(n + 2);
+
+  buf[0] = e->insync;
+  if(n)
+    memcpy(buf + 1, data, n);
+  buf[n + 1] = ok? e->ok: Resp_STK_FAILED;
+  respond(e, buf, n + 2);
+  mmt_free(buf);
+}
+
+/*
+ * Program flash on parts that erase n_page_erase pages at once: like
+ * optiboot, erase a group only when its first page is written and program
+ * other pages onto flash as is, which can only clear bits
+ */
+static int group_write(Emu *e, unsigned int addr, const unsigned char *data, int len) {
+  AVRMEM *m = e->flm;
+  unsigned int ps = m->page_size, gs = e->p->n_page_erase*ps;
+  unsigned int beg = addr/gs*gs, end = (addr + len + gs - 1)/gs*gs;
+
+  if(end > (unsigned int) m->size)
+    end = m->size;
+  if(e->pgm->paged_load(e->pgm, e->p, m, ps, beg, end - beg) < 0)
+    return 0;
+  for(unsigned int a = addr; a < addr + len; a++) {
+    if(a%gs == 0)
+      memset(m->buf + a, 0xff, end - a < gs? end - a: gs);
+    m->buf[a] &= data[a - addr];
+  }
+
+  return e->pgm->paged_write(e->pgm, e->p, m, ps, beg, end - beg) >= 0;
+}
+
+// Program (write = 1) or read len bytes of flash or EEPROM at byte address addr through dryboot
+static void page_rw(Emu *e, int write, int memtype, unsigned int addr, int len) {
+  AVRMEM *m = memtype == 'F'? e->flm: memtype == 'E'? e->eem: NULL;
+  unsigned char *data = mmt_malloc(len + 1);
+  int ok;
+
+  if(write)
+    getn(e, data, len);
+  if(eop(e) < 0) {
+    mmt_free(data);
+    return;
+  }
+
+  ok = m && len > 0 && addr + len <= (unsigned int) m->size;
+  if(ok && write && m == e->flm && e->blstart && addr + len > (unsigned int) e->blstart) {
+    if(verbose > 0)             // Urboot silently protects itself
+      pmsg_info("ignore write to bootloader [0x%04x, 0x%04x]\n", addr, addr + len - 1);
+  } else if(ok && write) {      // Device is busy for the NVM time after the data have arrived
+    wait_until(e, (e->tin > bench_now()? e->tin: bench_now()) +
+      (m == e->flm? (len + m->page_size - 1)/m->page_size*e->pagewrite: len*e->eewrite));
+    if(m == e->flm && e->p->n_page_erase > 1)
+      ok = group_write(e, addr, data, len);
+    else {
+      memcpy(m->buf + addr, data, len);
+      ok = e->pgm->paged_write(e->pgm, e->p, m, m->page_size, addr, len) >= 0;
+    }
+  } else if(ok) {
+    ok = e->pgm->paged_load(e->pgm, e->p, m, m->page_size, addr, len) >= 0;
+    memcpy(data, m->buf + addr, len);
+  }
+  if(!ok)
+    pmsg_warning("cannot %s %d bytes of %c memory at 0x%04x\n", write? "write": "read", len, memtype, addr);
+
+  if(verbose > 0)
+    pmsg_info("%s %c [0x%04x, 0x%04x]\n", write? "prog page": "read page", memtype, addr, addr + len - 1);
+  reply(e, data, write || !ok? 0: len, ok);
+  mmt_free(data);
+}
+
+// STK500v1 paged access: big-endian length and memory type; address from Cmnd_STK_LOAD_ADDRESS
+static void page(Emu *e, int write) {
+  unsigned char hdr[3];
+
+  getn(e, hdr, 3);
+
+  int memtype = hdr[2];
+
+  page_rw(e, write, memtype, ((memtype == 'F'? e->ext << 16: 0) | e->addr)*e->a_div, hdr[0] << 8 | hdr[1]);
+}
+
+// Urprotocol paged access: little-endian byte address, 3 bytes if flash exceeds 64 kB, then length
+static void urpage(Emu *e, int cmd) {
+  unsigned char par[5];
+  int na = e->flm->size > 0x10000? 3: 2, nl = e->flm->page_size <= 256? 1: 2, len;
+
+  getn(e, par, na + nl);
+  len = nl == 1? par[na]: par[na] << 8 | par[na + 1];
+  if(!len)                      // Zero stands for the maximum
+    len = nl == 1? 256: 65536;
+  page_rw(e, cmd == Cmnd_UR_PROG_PAGE_FL || cmd == Cmnd_UR_PROG_PAGE_EE,
+    cmd == Cmnd_UR_PROG_PAGE_FL || cmd == Cmnd_UR_READ_PAGE_FL? 'F': 'E',
+    par[0] | par[1] << 8 | (na == 3? par[2] << 16: 0), len);
+}
+
+// Urboot chip erase: erase all flash below the bootloader
+static void urerase(Emu *e) {
+  int ps = e->flm->page_size;
+
+  if(eop(e) < 0)
+    return;
+  wait_until(e, bench_now() + e->blstart/ps*e->pagewrite);
+  memset(e->flm->buf, 0xff, e->blstart);
+  for(int addr = 0; addr < e->blstart; addr += ps)
+    e->pgm->paged_write(e->pgm, e->p, e->flm, ps, addr, ps);
+  if(verbose > 0)
+    pmsg_info("chip erase [0, 0x%04x]\n", e->blstart - 1);
+  reply(e, NULL, 0, 1);
+}
+
+// Answer urprotocol commands; anything unknown is treated as get sync
+static void urserve(Emu *e) {
+  for(;;) {
+    e->nin = e->nout = 0;
+
+    int cmd = getch(e);
+
+    switch(cmd) {
+    case Cmnd_UR_PROG_PAGE_EE:
+    case Cmnd_UR_READ_PAGE_EE:
+    case Cmnd_UR_PROG_PAGE_FL:
+    case Cmnd_UR_READ_PAGE_FL:
+      urpage(e, cmd);
+      break;
+
+    case Cmnd_STK_CHIP_ERASE:
+      urerase(e);
+      break;
+
+    default:
+      if(eop(e) == 0)
+        reply(e, NULL, 0, 1);
+    }
+    if(verbose > 1)
+      pmsg_info("command 0x%02x: %ld bytes in, %ld bytes out\n", cmd, e->nin, e->nout);
+  }
+}
+
+// Set the urprotocol bytes that tell urclock the mcuid and bootloader features
+static void urprotocol_bytes(Emu *e) {
+  int info = UB_INFO(EMU_URFEATURES, e->p->mcuid), insync = info/255, ok = info%255;
+
+  if(ok >= insync)              // The two bytes must differ
+    ok++;
+  if(insync == Resp_STK_INSYNC && ok == Resp_STK_OK) // Reserved for STK500v1, has an escape
+    insync = 255, ok = 254;
+  e->insync = insync;
+  e->ok = ok;
+}
+
+static void serve(Emu *e) {
+  unsigned char buf[32];
+
+  for(;;) {
+    e->nin = e->nout = 0;
+
+    int cmd = getch(e);
+
+    switch(cmd) {
+    case Cmnd_STK_GET_PARAMETER:
+      buf[0] = getch(e);
+      if(eop(e) < 0)
+        break;
+      buf[1] = buf[0] == Parm_STK_SW_MAJOR? EMU_MAJVER: buf[0] == Parm_STK_SW_MINOR? EMU_MINVER: 0x03;
+      reply(e, buf + 1, 1, 1);
+      break;
+
+    case Cmnd_STK_SET_DEVICE:
+      getn(e, buf, 20);
+      if(eop(e) == 0)
+        reply(e, NULL, 0, 1);
+      break;
+
+    case Cmnd_STK_SET_DEVICE_EXT:  // First parameter is the number of parameters
+      buf[0] = getch(e);
+      getn(e, buf + 1, buf[0] > 1 && buf[0] < sizeof buf? buf[0] - 1: 0);
+      if(eop(e) == 0)
+        reply(e, NULL, 0, 1);
+      break;
+
+    case Cmnd_STK_LOAD_ADDRESS:
+      getn(e, buf, 2);
+      if(eop(e) == 0) {
+        e->addr = buf[0] | buf[1] << 8;
+        reply(e, NULL, 0, 1);
+      }
+      break;
+
+    case Cmnd_STK_UNIVERSAL:   // Only load extended address is honoured, others return 0
+      getn(e, buf, 4);
+      if(eop(e) == 0) {
+        if(buf[0] == 0x4d)
+          e->ext = buf[2];
+        buf[0] = 0;
+        reply(e, buf, 1, 1);
+      }
+      break;
+
+    case Cmnd_STK_PROG_PAGE:
+    case Cmnd_STK_READ_PAGE:
+      page(e, cmd == Cmnd_STK_PROG_PAGE);
+      break;
+
+    case Cmnd_STK_READ_SIGN:
+      if(eop(e) == 0)
+        reply(e, e->p->signature, 3, 1);
+      break;
+
+    default:                   // Cmnd_STK_GET_SYNC, Cmnd_STK_ENTER/LEAVE_PROGMODE etc
+      if(eop(e) == 0)
+        reply(e, NULL, 0, 1);
+    }
+    if(verbose > 1)
+      pmsg_info("command 0x%02x: %ld bytes in, %ld bytes out\n", cmd, e->nin, e->nout);
+  }
+}
+
+// Open a pty and return the master fd; the slave stays open so the master never sees a hangup
+static int open_pty(const char **namep) {
+  int fd = posix_openpt(O_RDWR | O_NOCTTY), sfd;
+  struct termios tio;
+
+  if(fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0 || !(*namep = ptsname(fd))) {
+    pmsg_error("cannot open pty: %s\n", strerror(errno));
+    return -1;
+  }
+  if((sfd = open(*namep, O_RDWR | O_NOCTTY)) < 0) {
+    pmsg_error("cannot open %s: %s\n", *namep, strerror(errno));
+    return -1;
+  }
+  if(tcgetattr(sfd, &tio) == 0) { // No echo or line editing until avrdude sets up the port
+    cfmakeraw(&tio);
+    tcsetattr(sfd, TCSANOW, &tio);
+  }
+
+  return fd;
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-u] [-p <part>] [-b <baud>] [-l <us>] [-w <us>] [-e <us>] [-x <param>] [-v]\n"
+    "         <avrdude.conf>\n", name);
+}
+
+int main(int argc, char **argv) {
+  Emu emu = { .a_div = 2, .insync = Resp_STK_INSYNC, .ok = Resp_STK_OK }, *e = &emu;
+  LISTID xparams = lcreat(NULL, 0);
+  const char *ptyname;
+  int c, baud = 0;
+
+  partdesc = "m328p";
+  while((c = getopt(argc, argv, "up:b:l:w:e:x:v")) != -1) {
+    switch(c) {
+    case 'u':
+      e->urboot = 1;
+      break;
+    case 'p':
+      partdesc = optarg;
+      break;
+    case 'b':
+      baud = atoi(optarg);
+      break;
+    case 'l':
+      e->latency = atoi(optarg)/1e6;
+      break;
+    case 'w':
+      e->pagewrite = atoi(optarg)/1e6;
+      break;
+    case 'e':
+      e->eewrite = atoi(optarg)/1e6;
+      break;
+    case 'x':
+      ladd(xparams, optarg);
+      break;
+    case 'v':
+      verbose++;
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if(optind != argc - 1 || baud < 0 || e->latency < 0 || e->pagewrite < 0 || e->eewrite < 0) {
+    usage(argv[0]);
+    return 1;
+  }
+  e->bytetime = baud? 10.0/baud: 0;
+
+  if(bench_init("stk500emu", argv[optind]) < 0)
+    return 1;
+
+  AVRPART *p = locate_part(part_list, partdesc);
+
+  if(!p || !(e->flm = avr_locate_flash(p)) || e->flm->size < 1) {
+    pmsg_error("cannot find part %s or its flash\n", partdesc);
+    return 1;
+  }
+  e->p = p;
+  e->eem = avr_locate_eeprom(p);
+  e->a_div = is_classic(p)? 2: 1;
+  if(e->urboot) {
+    int ps = e->flm->page_size, blsize = (EMU_URSIZE + ps - 1)/ps*ps;
+
+    if(!is_classic(p) || p->mcuid < 0 || p->mcuid >= UB_N_MCU || ps < 1 || blsize/ps > 127 ||
+      blsize > e->flm->size/4) {
+      pmsg_error("cannot emulate an urboot bootloader on %s\n", p->desc);
+      return 1;
+    }
+    e->blstart = e->flm->size - blsize;
+    urprotocol_bytes(e);
+  }
+
+  PROGRAMMER *pgm = e->pgm = locate_programmer(programmers, pgmid = "dryboot");
+
+  if(!pgm || !pgm->initpgm) {
+    pmsg_error("cannot find programmer dryboot\n");
+    return 1;
+  }
+  pgm->initpgm(pgm);
+  if(pgm->setup)
+    pgm->setup(pgm);
+  if(lsize(xparams) && pgm->parseextparams(pgm, xparams) < 0) {
+    pmsg_error("unable to parse list of -x parameters\n");
+    return 1;
+  }
+  if(avr_initmem(p) < 0 || pgm->open(pgm, NULL) < 0) {
+    pmsg_error("unable to initialise dryboot\n");
+    return 1;
+  }
+  pgm->enable(pgm, p);
+  if(pgm->initialize(pgm, p) < 0) {
+    pmsg_error("unable to initialise %s\n", p->desc);
+    return 1;
+  }
+  if(e->urboot) {               // Urboot table: pages, vector number, ret opcode, capabilities, version
+    unsigned char table[6] = {
+      (e->flm->size - e->blstart)/e->flm->page_size, 0, 0x08, 0x95, EMU_URCAP, EMU_URVER
+    };
+
+    for(int i = 0; i < 6; i++)
+      pgm->write_byte(pgm, p, e->flm, e->flm->size - 6 + i, table[i]);
+  } else {                      // Optiboot keeps its version number in the top two bytes of flash
+    pgm->write_byte(pgm, p, e->flm, e->flm->size - 2, EMU_MINVER);
+    pgm->write_byte(pgm, p, e->flm, e->flm->size - 1, EMU_MAJVER);
+  }
+
+  if((e->fd = open_pty(&ptyname)) < 0)
+    return 1;
+  printf("%s\n", ptyname);
+  fflush(stdout);
+
+  if(e->urboot)
+    urserve(e);
+  else
+    serve(e);
+
+  return 0;
+}
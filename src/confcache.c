@@ -0,0 +1,728 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Binary cache of the parsed configuration files
+ *
+ * Parsing the full avrdude.conf with the flex/bison grammar and sorting the
+ * memories of every part dominates the start-up time of short avrdude runs.
+ * cfg_cache_save() dumps the outcome of read_config(), ie, the defaults,
+ * the prologue, the part list and the programmer list, into one flat file
+ * and cfg_cache_load() restores it from a memory mapping of that file.
+ *
+ * The cache is keyed by the real path, modification time, size and 64-bit
+ * FNV-1a hash of each configuration file in the order they were read. It
+ * also records the avrdude version and the sizes of the structures that
+ * are stored verbatim, so a cache from a different build or a cache with
+ * any stale input file is rejected and the caller falls back to parsing.
+ * The format is native-endian and not meant to be shared between hosts.
+ */
+
+#include <ac_cfg.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if !defined(WIN32)
+#include <sys/mman.h>
+#endif
+
+#include "avrdude.h"
+#include "libavrdude.h"
+#include "config.h"
+
+#define CC_MAGIC   "avrdude confcache"
+#define CC_FORMAT  1
+#define CC_NULL    0xffffffffU  // Length that encodes a NULL string or NULL list
+#define CC_END     0x21646e45U  // End marker to detect truncated files
+
+// Growing output buffer for cfg_cache_save()
+typedef struct {
+  unsigned char *buf;
+  size_t len, cap;
+} Ccout;
+
+// Bounds-checked input cursor for cfg_cache_load(); err is sticky
+typedef struct {
+  const unsigned char *p, *end;
+  int err;
+} Ccin;
+
+static void cc_put(Ccout *o, const void *d, size_t n) {
+  if(o->len + n > o->cap) {
+    o->cap = 2*(o->len + n) + 4096;
+    o->buf = mmt_realloc(o->buf, o->cap);
+  }
+  memcpy(o->buf + o->len, d, n);
+  o->len += n;
+}
+
+static void cc_put_u32(Ccout *o, uint32_t v) {
+  cc_put(o, &v, sizeof v);
+}
+
+static void cc_put_str(Ccout *o, const char *s) {
+  uint32_t n = s? (uint32_t) strlen(s): CC_NULL;
+
+  cc_put_u32(o, n);
+  if(s)
+    cc_put(o, s, n + 1);
+}
+
+static void cc_put_strlist(Ccout *o, LISTID l) {
+  cc_put_u32(o, l? (uint32_t) lsize(l): CC_NULL);
+  if(l)
+    for(LNODEID ln = lfirst(l); ln; ln = lnext(ln))
+      cc_put_str(o, ldata(ln));
+}
+
+static void cc_put_intlist(Ccout *o, LISTID l) {
+  cc_put_u32(o, l? (uint32_t) lsize(l): CC_NULL);
+  if(l)
+    for(LNODEID ln = lfirst(l); ln; ln = lnext(ln))
+      cc_put(o, ldata(ln), sizeof(int));
+}
+
+static void cc_put_comments(Ccout *o, LISTID l) {
+  cc_put_u32(o, l? (uint32_t) lsize(l): CC_NULL);
+  if(l)
+    for(LNODEID ln = lfirst(l); ln; ln = lnext(ln)) {
+      COMMENT *c = ldata(ln);
+
+      cc_put_str(o, c->kw);
+      cc_put(o, &c->rhs, sizeof c->rhs);
+      cc_put_strlist(o, c->comms);
+    }
+}
+
+static void cc_put_ops(Ccout *o, OPCODE *const *op) {
+  for(int i = 0; i < AVR_OP_MAX; i++) {
+    unsigned char there = !!op[i];
+
+    cc_put(o, &there, 1);
+    if(there)
+      cc_put(o, op[i], sizeof *op[i]);
+  }
+}
+
+static void cc_get(Ccin *in, void *d, size_t n) {
+  if(in->err || (size_t) (in->end - in->p) < n) {
+    in->err = 1;
+    memset(d, 0, n);
+    return;
+  }
+  memcpy(d, in->p, n);
+  in->p += n;
+}
+
+static uint32_t cc_get_u32(Ccin *in) {
+  uint32_t v;
+
+  cc_get(in, &v, sizeof v);
+  return v;
+}
+
+static int cc_get_int(Ccin *in) {
+  int v;
+
+  cc_get(in, &v, sizeof v);
+  return v;
+}
+
+// Return pointer to the nul-terminated string in the mapped cache file
+static const char *cc_get_str(Ccin *in) {
+  uint32_t n = cc_get_u32(in);
+
+  if(in->err || n == CC_NULL)
+    return NULL;
+  if((size_t) (in->end - in->p) <= n || in->p[n]) {
+    in->err = 1;
+    return NULL;
+  }
+
+  const char *s = (const char *) in->p;
+
+  in->p += n + 1;
+  return s;
+}
+
+// Return hashed copy of a string from the cache or NULL
+static const char *cc_get_cstr(Ccin *in) {
+  const char *s = cc_get_str(in);
+
+  return s? cache_string(s): NULL;
+}
+
+// Number of list elements or CC_NULL; guards against nonsensical counts
+static uint32_t cc_get_count(Ccin *in) {
+  uint32_t n = cc_get_u32(in);
+
+  if(n != CC_NULL && n > (size_t) (in->end - in->p))
+    in->err = 1;
+  return in->err? CC_NULL: n;
+}
+
+static LISTID cc_get_strlist(Ccin *in, LISTID l) {
+  uint32_t n = cc_get_count(in);
+
+  if(n == CC_NULL)
+    return l;
+  if(!l)
+    l = lcreat(NULL, 0);
+  for(uint32_t i = 0; i < n && !in->err; i++) {
+    const char *s = cc_get_str(in);
+
+    if(s)
+      ladd(l, mmt_strdup(s));
+  }
+  return l;
+}
+
+static LISTID cc_get_intlist(Ccin *in, LISTID l) {
+  uint32_t n = cc_get_count(in);
+
+  if(n == CC_NULL)
+    return l;
+  if(!l)
+    l = lcreat(NULL, 0);
+  for(uint32_t i = 0; i < n && !in->err; i++) {
+    int *ip = mmt_malloc(sizeof *ip);
+
+    *ip = cc_get_int(in);
+    ladd(l, ip);
+  }
+  return l;
+}
+
+static LISTID cc_get_comments(Ccin *in) {
+  uint32_t n = cc_get_count(in);
+  LISTID l;
+
+  if(n == CC_NULL)
+    return NULL;
+  l = lcreat(NULL, 0);
+  for(uint32_t i = 0; i < n && !in->err; i++) {
+    COMMENT *c = mmt_malloc(sizeof *c);
+    const char *kw = cc_get_str(in);
+
+    c->kw = mmt_strdup(kw? kw: "");
+    c->rhs = cc_get_int(in);
+    c->comms = cc_get_strlist(in, NULL);
+    ladd(l, c);
+  }
+  return l;
+}
+
+static void cc_get_ops(Ccin *in, OPCODE **op) {
+  for(int i = 0; i < AVR_OP_MAX; i++) {
+    unsigned char there;
+
+    cc_get(in, &there, 1);
+    op[i] = NULL;
+    if(there && !in->err) {
+      op[i] = avr_new_opcode();
+      cc_get(in, op[i], sizeof *op[i]);
+    }
+  }
+}
+
+// 64-bit FNV-1a hash of a file's contents; returns -1 if the file cannot be read
+static int cc_hash_file(const char *path, uint64_t *hashp) {
+  unsigned char buf[16384];
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  size_t n;
+  FILE *f = fopen(path, "rb");
+
+  if(!f)
+    return -1;
+  while((n = fread(buf, 1, sizeof buf, f)) > 0)
+    for(size_t i = 0; i < n; i++)
+      hash = (hash ^ buf[i])*0x100000001b3ULL;
+
+  int ret = ferror(f)? -1: 0;
+
+  fclose(f);
+  *hashp = hash;
+  return ret;
+}
+
+// Put (real path, mtime, size, hash) of each config file; returns -1 on failure
+static int cc_put_key(Ccout *o, LISTID files) {
+  cc_put_u32(o, lsize(files));
+  for(LNODEID ln = lfirst(files); ln; ln = lnext(ln)) {
+    char *rp = realpath((const char *) ldata(ln), NULL);
+    struct stat sb;
+    uint64_t hash;
+    int64_t mtime, size;
+
+    if(!rp || stat(rp, &sb) < 0 || cc_hash_file(rp, &hash) < 0) {
+      pmsg_notice2("cannot key configuration file %s: %s\n", (char *) ldata(ln), strerror(errno));
+      mmt_free(rp);
+      return -1;
+    }
+    mtime = sb.st_mtime;
+    size = sb.st_size;
+    cc_put_str(o, rp);
+    cc_put(o, &mtime, sizeof mtime);
+    cc_put(o, &size, sizeof size);
+    cc_put(o, &hash, sizeof hash);
+    mmt_free(rp);
+  }
+  return 0;
+}
+
+// Check the cached key against the config files; returns -1 if stale
+static int cc_check_key(Ccin *in, LISTID files) {
+  if(cc_get_u32(in) != (uint32_t) lsize(files))
+    return -1;
+
+  for(LNODEID ln = lfirst(files); ln && !in->err; ln = lnext(ln)) {
+    const char *path = cc_get_str(in);
+    int64_t mtime, size;
+    uint64_t hash, fhash;
+    struct stat sb;
+    int stale;
+
+    cc_get(in, &mtime, sizeof mtime);
+    cc_get(in, &size, sizeof size);
+    cc_get(in, &hash, sizeof hash);
+    if(in->err || !path)
+      return -1;
+
+    char *rp = realpath((const char *) ldata(ln), NULL);
+
+    // Cheap checks first, only hash the file if path, mtime and size agree
+    stale = !rp || !str_eq(rp, path) || stat(rp, &sb) < 0 || (int64_t) sb.st_mtime != mtime ||
+      (int64_t) sb.st_size != size || cc_hash_file(rp, &fhash) < 0 || fhash != hash;
+    mmt_free(rp);
+    if(stale) {
+      pmsg_notice2("configuration cache is stale for %s\n", (char *) ldata(ln));
+      return -1;
+    }
+  }
+
+  return in->err? -1: 0;
+}
+
+static void cc_put_header(Ccout *o) {
+  cc_put_str(o, CC_MAGIC);
+  cc_put_u32(o, CC_FORMAT);
+  cc_put_str(o, AVRDUDE_FULL_VERSION);
+  cc_put_u32(o, sizeof(void *));
+  cc_put_u32(o, sizeof(AVRPART));
+  cc_put_u32(o, sizeof(AVRMEM));
+  cc_put_u32(o, sizeof(OPCODE));
+  cc_put_u32(o, sizeof(struct pindef));
+  cc_put_u32(o, N_PINS);
+  cc_put_u32(o, AVR_OP_MAX);
+}
+
+static int cc_check_header(Ccin *in) {
+  const char *magic = cc_get_str(in);
+
+  if(!magic || !str_eq(magic, CC_MAGIC) || cc_get_u32(in) != CC_FORMAT)
+    return -1;
+
+  const char *version = cc_get_str(in);
+
+  if(!version || !str_eq(version, AVRDUDE_FULL_VERSION))
+    return -1;
+
+  return cc_get_u32(in) != sizeof(void *) || cc_get_u32(in) != sizeof(AVRPART) ||
+    cc_get_u32(in) != sizeof(AVRMEM) || cc_get_u32(in) != sizeof(OPCODE) ||
+    cc_get_u32(in) != sizeof(struct pindef) || cc_get_u32(in) != N_PINS ||
+    cc_get_u32(in) != AVR_OP_MAX || in->err? -1: 0;
+}
+
+static void cc_put_mem(Ccout *o, const AVRMEM *m) {
+  cc_put(o, m, sizeof *m);      // Scalars verbatim, pointers are fixed up on load
+  cc_put_str(o, m->desc);
+  cc_put_comments(o, m->comments);
+  cc_put_ops(o, m->op);
+}
+
+static AVRMEM *cc_get_mem(Ccin *in) {
+  AVRMEM *m = avr_new_mem();
+
+  cc_get(in, m, sizeof *m);
+  m->buf = NULL;
+  m->tags = NULL;
+  m->desc = cc_get_cstr(in);
+  m->comments = cc_get_comments(in);
+  cc_get_ops(in, m->op);
+  if(!m->desc)
+    m->desc = cache_string("");
+
+  return m;
+}
+
+// Returns -1 if an alias points to a memory outside the part's memory list
+static int cc_put_part(Ccout *o, const AVRPART *p) {
+  cc_put(o, p, sizeof *p);
+  cc_put_str(o, p->desc);
+  cc_put_str(o, p->id);
+  cc_put_str(o, p->parent_id);
+  cc_put_str(o, p->family_id);
+  cc_put_str(o, p->config_file);
+  cc_put_comments(o, p->comments);
+  cc_put_strlist(o, p->variants);
+  cc_put_ops(o, p->op);
+
+  cc_put_u32(o, lsize(p->mem));
+  for(LNODEID ln = lfirst(p->mem); ln; ln = lnext(ln))
+    cc_put_mem(o, ldata(ln));
+
+  cc_put_u32(o, lsize(p->mem_alias));
+  for(LNODEID ln = lfirst(p->mem_alias); ln; ln = lnext(ln)) {
+    AVRMEM_ALIAS *a = ldata(ln);
+    uint32_t idx = 0;
+    LNODEID lm;
+
+    for(lm = lfirst(p->mem); lm && ldata(lm) != a->aliased_mem; lm = lnext(lm))
+      idx++;
+    if(!lm)
+      return -1;
+    cc_put_str(o, a->desc);
+    cc_put_u32(o, idx);
+  }
+
+  return 0;
+}
+
+static AVRPART *cc_get_part(Ccin *in) {
+  AVRPART *p = avr_new_part();
+  LISTID mem = p->mem, mem_alias = p->mem_alias, variants = p->variants;
+
+  cc_get(in, p, sizeof *p);
+  p->mem = mem;
+  p->mem_alias = mem_alias;
+  p->variants = variants;
+  p->mem_index = NULL;
+  p->desc = cc_get_cstr(in);
+  p->id = cc_get_cstr(in);
+  p->parent_id = cc_get_cstr(in);
+  p->family_id = cc_get_cstr(in);
+  p->config_file = cc_get_cstr(in);
+  p->comments = cc_get_comments(in);
+  cc_get_strlist(in, p->variants);
+  cc_get_ops(in, p->op);
+
+  uint32_t nmem = cc_get_count(in);
+
+  for(uint32_t i = 0; i < nmem && !in->err; i++)
+    ladd(p->mem, cc_get_mem(in));
+
+  uint32_t nalias = cc_get_count(in);
+
+  for(uint32_t i = 0; i < nalias && !in->err; i++) {
+    AVRMEM_ALIAS *a = avr_new_memalias();
+    const char *desc = cc_get_cstr(in);
+    uint32_t idx = cc_get_u32(in);
+
+    a->desc = desc? desc: a->desc;
+    if(idx >= nmem || !(a->aliased_mem = lget_n(p->mem, idx + 1)))
+      in->err = 1;
+    ladd(p->mem_alias, a);
+  }
+
+  // Ensure the part can always be freed, even when the cache is corrupt
+  if(!p->desc || !p->id || !p->parent_id || !p->family_id || !p->config_file) {
+    const char *nulp = cache_string("");
+
+    p->desc = p->desc? p->desc: nulp;
+    p->id = p->id? p->id: nulp;
+    p->parent_id = p->parent_id? p->parent_id: nulp;
+    p->family_id = p->family_id? p->family_id: nulp;
+    p->config_file = p->config_file? p->config_file: nulp;
+    in->err = 1;
+  }
+
+  return p;
+}
+
+// Only the config-file visible members; the rest is set up by pgm_new()
+static void cc_put_pgm(Ccout *o, const PROGRAMMER *pgm) {
+  cc_put_strlist(o, pgm->id);
+  cc_put_str(o, pgm->desc);
+  cc_put_comments(o, pgm->comments);
+  cc_put_str(o, pgm->parent_id);
+  cc_put_str(o, pgm->initpgm? locate_programmer_type_id(pgm->initpgm): NULL);
+  cc_put(o, &pgm->prog_modes, sizeof pgm->prog_modes);
+  cc_put(o, &pgm->is_serialadapter, sizeof pgm->is_serialadapter);
+  cc_put(o, &pgm->extra_features, sizeof pgm->extra_features);
+  cc_put(o, pgm->pin, sizeof pgm->pin);
+  cc_put_u32(o, pgm->conntype);
+  cc_put(o, &pgm->baudrate, sizeof pgm->baudrate);
+  cc_put(o, &pgm->usbvid, sizeof pgm->usbvid);
+  cc_put_intlist(o, pgm->usbpid);
+  cc_put_str(o, pgm->usbdev);
+  cc_put_str(o, pgm->usbsn);
+  cc_put_str(o, pgm->usbvendor);
+  cc_put_str(o, pgm->usbproduct);
+  cc_put_intlist(o, pgm->hvupdi_support);
+  cc_put_str(o, pgm->config_file);
+  cc_put(o, &pgm->lineno, sizeof pgm->lineno);
+}
+
+static PROGRAMMER *cc_get_pgm(Ccin *in) {
+  PROGRAMMER *pgm = pgm_new();
+  const char *s;
+
+  cc_get_strlist(in, pgm->id);
+  if((s = cc_get_cstr(in)))
+    pgm->desc = s;
+  pgm->comments = cc_get_comments(in);
+  if((s = cc_get_cstr(in)))
+    pgm->parent_id = s;
+  if((s = cc_get_str(in)) && *s) {
+    const PROGRAMMER_TYPE *pt = locate_programmer_type(s);
+
+    if(pt)
+      pgm->initpgm = pt->initpgm;
+    else
+      in->err = 1;
+  }
+  pgm->prog_modes = cc_get_int(in);
+  pgm->is_serialadapter = cc_get_int(in);
+  pgm->extra_features = cc_get_int(in);
+  cc_get(in, pgm->pin, sizeof pgm->pin);
+  pgm->conntype = (Conntype) cc_get_u32(in);
+  pgm->baudrate = cc_get_int(in);
+  pgm->usbvid = cc_get_int(in);
+  cc_get_intlist(in, pgm->usbpid);
+  if((s = cc_get_cstr(in)))
+    pgm->usbdev = s;
+  if((s = cc_get_cstr(in)))
+    pgm->usbsn = s;
+  if((s = cc_get_cstr(in)))
+    pgm->usbvendor = s;
+  if((s = cc_get_cstr(in)))
+    pgm->usbproduct = s;
+  cc_get_intlist(in, pgm->hvupdi_support);
+  if((s = cc_get_cstr(in)))
+    pgm->config_file = s;
+  pgm->lineno = cc_get_int(in);
+
+  return pgm;
+}
+
+/*
+ * Write the current configuration, ie, the result of read_config() on the
+ * list of files, to the cache file. Memories must already be sorted. The
+ * file is written under a temporary name and renamed, so concurrent avrdude
+ * processes only ever see a complete cache. Returns 0 on success, -1 else.
+ */
+int cfg_cache_save(const char *cachefile, LISTID files) {
+  Ccout o = { NULL, 0, 0 };
+  char *tmp = NULL;
+  FILE *f = NULL;
+  int ret = -1;
+
+  cc_put_header(&o);
+  if(cc_put_key(&o, files) < 0)
+    goto done;
+
+  cc_put_str(&o, avrdude_conf_version);
+  cc_put_str(&o, default_programmer);
+  cc_put_str(&o, default_parallel);
+  cc_put_str(&o, default_serial);
+  cc_put_str(&o, default_spi);
+  cc_put(&o, &default_baudrate, sizeof default_baudrate);
+  cc_put(&o, &default_bitclock, sizeof default_bitclock);
+  cc_put_str(&o, default_linuxgpio);
+  cc_put(&o, &allow_subshells, sizeof allow_subshells);
+  cc_put_strlist(&o, cfg_get_prologue());
+
+  cc_put_u32(&o, lsize(part_list));
+  for(LNODEID ln = lfirst(part_list); ln; ln = lnext(ln))
+    if(cc_put_part(&o, ldata(ln)) < 0) {
+      pmsg_warning("cannot cache part %s with dangling memory alias\n", ((AVRPART *) ldata(ln))->desc);
+      goto done;
+    }
+
+  cc_put_u32(&o, lsize(programmers));
+  for(LNODEID ln = lfirst(programmers); ln; ln = lnext(ln))
+    cc_put_pgm(&o, ldata(ln));
+  cc_put_u32(&o, CC_END);
+
+  tmp = mmt_sprintf("%s.%ld.tmp", cachefile, (long) getpid());
+  if(!(f = fopen(tmp, "wb"))) {
+    pmsg_warning("cannot write configuration cache %s: %s\n", tmp, strerror(errno));
+    goto done;
+  }
+  if(fwrite(o.buf, 1, o.len, f) != o.len || fclose(f) != 0) {
+    f = NULL;
+    pmsg_warning("cannot write configuration cache %s: %s\n", tmp, strerror(errno));
+    unlink(tmp);
+    goto done;
+  }
+  f = NULL;
+
+#if defined(WIN32)
+  unlink(cachefile);            // Windows rename() does not replace existing files
+#endif
+  if(rename(tmp, cachefile) < 0) {
+    pmsg_warning("cannot rename %s to %s: %s\n", tmp, cachefile, strerror(errno));
+    unlink(tmp);
+    goto done;
+  }
+
+  pmsg_notice2("wrote configuration cache %s (%lu bytes)\n", cachefile, (unsigned long) o.len);
+  ret = 0;
+
+done:
+  if(f)
+    fclose(f);
+  mmt_free(tmp);
+  mmt_free(o.buf);
+  return ret;
+}
+
+/*
+ * Restore the configuration from the cache file instead of calling
+ * read_config() for each of the files; the cache must have been written
+ * for the same list of files by the same avrdude build, and none of the
+ * files must have changed since. Nothing is modified unless the whole
+ * cache is valid. Returns 0 on success and -1 if the cache is missing,
+ * stale or corrupt, in which case the caller should parse the files.
+ */
+int cfg_cache_load(const char *cachefile, LISTID files) {
+  struct stat sb;
+  unsigned char *map = NULL;
+  size_t len = 0;
+  int fd, ret = -1;
+  LISTID parts = NULL, pgms = NULL, prologue = NULL;
+
+  if((fd = open(cachefile, O_RDONLY
+#if defined(WIN32)
+    | O_BINARY
+#endif
+    )) < 0) {
+    pmsg_notice2("no configuration cache %s: %s\n", cachefile, strerror(errno));
+    return -1;
+  }
+  if(fstat(fd, &sb) < 0 || sb.st_size <= 0) {
+    close(fd);
+    return -1;
+  }
+  len = sb.st_size;
+
+#if !defined(WIN32)
+  if((map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+    pmsg_notice2("cannot map configuration cache %s: %s\n", cachefile, strerror(errno));
+    close(fd);
+    return -1;
+  }
+#else
+  map = mmt_malloc(len);
+  if(read(fd, map, len) != (int) len) {
+    mmt_free(map);
+    close(fd);
+    return -1;
+  }
+#endif
+  close(fd);
+
+  Ccin in = { map, map + len, 0 };
+
+  if(cc_check_header(&in) < 0) {
+    pmsg_notice2("configuration cache %s is from a different avrdude build\n", cachefile);
+    goto done;
+  }
+  if(cc_check_key(&in, files) < 0)
+    goto done;
+
+  const char *conf_version = cc_get_cstr(&in), *pgm = cc_get_cstr(&in), *par = cc_get_cstr(&in),
+    *ser = cc_get_cstr(&in), *spi = cc_get_cstr(&in);
+  int baudrate = cc_get_int(&in);
+  double bitclock;
+
+  cc_get(&in, &bitclock, sizeof bitclock);
+
+  const char *linuxgpio = cc_get_cstr(&in);
+  int subshells = cc_get_int(&in);
+
+  prologue = cc_get_strlist(&in, NULL);
+
+  parts = lcreat(NULL, 0);
+  uint32_t n = cc_get_count(&in);
+
+  for(uint32_t i = 0; i < n && !in.err; i++)
+    ladd(parts, cc_get_part(&in));
+
+  pgms = lcreat(NULL, 0);
+  n = cc_get_count(&in);
+  for(uint32_t i = 0; i < n && !in.err; i++)
+    ladd(pgms, cc_get_pgm(&in));
+
+  if(cc_get_u32(&in) != CC_END || in.err) {
+    pmsg_warning("configuration cache %s is corrupt, ignoring it\n", cachefile);
+    goto done;
+  }
+
+  // Commit: replace the (empty) lists set up by init_config()
+  avrdude_conf_version = conf_version;
+  default_programmer = pgm;
+  default_parallel = par;
+  default_serial = ser;
+  default_spi = spi;
+  default_baudrate = baudrate;
+  default_bitclock = bitclock;
+  default_linuxgpio = linuxgpio;
+  allow_subshells = subshells;
+  if(prologue) {
+    if(cx->cfg_prologue)
+      ldestroy_cb(cx->cfg_prologue, mmt_f_free);
+    cx->cfg_prologue = prologue;
+    prologue = NULL;
+  }
+  index_avrparts(NULL);
+  index_programmers(NULL);
+  ldestroy_cb(part_list, (void (*)(void *)) avr_free_part);
+  part_list = parts;
+  parts = NULL;
+  ldestroy_cb(programmers, (void (*)(void *)) pgm_free);
+  programmers = pgms;
+  pgms = NULL;
+
+  pmsg_notice("using configuration cache %s\n", cachefile);
+  ret = 0;
+
+done:
+  if(prologue)
+    ldestroy_cb(prologue, mmt_f_free);
+  if(parts)
+    ldestroy_cb(parts, (void (*)(void *)) avr_free_part);
+  if(pgms)
+    ldestroy_cb(pgms, (void (*)(void *)) pgm_free);
+
+#if !defined(WIN32)
+  munmap(map, len);
+#else
+  mmt_free(map);
+#endif
+
+  return ret;
+}
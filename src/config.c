@@ -28,6 +28,10 @@
 #include <ctype.h>
 #include <wchar.h>
 
+#if !defined(WIN32)
+#include <sys/resource.h>
+#endif
+
 #include "avrdude.h"
 #include "libavrdude.h"
 #include "config.h"
@@ -161,6 +165,8 @@ Component avr_comp[] = {
 #define DEBUG 0
 
 void cleanup_config(void) {
+  index_avrparts(NULL);
+  index_programmers(NULL);
   ldestroy_cb(part_list, (void (*)(void *)) avr_free_part);
   ldestroy_cb(programmers, (void (*)(void *)) pgm_free);
   ldestroy_cb(string_list, (void (*)(void *)) free_token);
@@ -183,14 +189,40 @@ int init_config(void) {
   return 0;
 }
 
+/*
+ * Tally allocations for cfg_alloc_stats(); cx itself is allocated before it
+ * exists. The old size of a reallocated block is unknown, so reallocations
+ * are counted separately and not added to the bytes requested.
+ */
+static void cfg_count_alloc(size_t n, int realloc) {
+  if(cx) {
+    Cfg_allocstats *a = &cx->cfg_allocs;
+
+    if(realloc)
+      a->nreallocs++;
+    else {
+      a->nallocs++;
+      a->bytes += n;
+    }
+    if(n > a->max)
+      a->max = n;
+  }
+}
+
+/*
+ * Allocate n zeroed bytes. Using calloc() rather than malloc() and memset()
+ * lets the C library skip zeroing memory that it freshly maps from the OS,
+ * so large buffers, eg, part memories from avr_initmem(), are only paged in
+ * where they are written.
+ */
 void *cfg_malloc(const char *funcname, size_t n) {
-  void *ret = malloc(n);
+  void *ret = calloc(1, n);
 
   if(!ret) {
-    pmsg_error("out of memory in %s() for malloc(); needed %lu bytes\n", funcname, (unsigned long) n);
+    pmsg_error("out of memory in %s() for calloc(); needed %lu bytes\n", funcname, (unsigned long) n);
     exit(1);
   }
-  memset(ret, 0, n);
+  cfg_count_alloc(n, 0);
   return ret;
 }
 
@@ -201,6 +233,7 @@ void *cfg_realloc(const char *funcname, void *p, size_t n) {
     pmsg_error("out of memory in %s() for %salloc(); needed %lu bytes\n", funcname, p? "re": "c", (unsigned long) n);
     exit(1);
   }
+  cfg_count_alloc(n, !!p);
   return ret;
 }
 
@@ -211,9 +244,47 @@ char *cfg_strdup(const char *funcname, const char *s) {
     pmsg_error("out of memory in %s() for strdup()\n", funcname);
     exit(1);
   }
+  cfg_count_alloc(strlen(s) + 1, 0);
   return ret;
 }
 
+// Add the allocation statistics of another thread's context, eg, of a gang target, to this one
+void cfg_alloc_add(const Cfg_allocstats *a) {
+  Cfg_allocstats *s = &cx->cfg_allocs;
+
+  s->nallocs += a->nallocs;
+  s->nreallocs += a->nreallocs;
+  s->bytes += a->bytes;
+  if(a->max > s->max)
+    s->max = a->max;
+}
+
+/*
+ * Print allocation statistics of this context and resource usage of the
+ * process; allocations of other threads only count once their statistics
+ * have been added with cfg_alloc_add()
+ */
+void cfg_alloc_stats(void) {
+  const Cfg_allocstats *a = &cx->cfg_allocs;
+
+  pmsg_info("%ld allocations requested %.3f MiB, the largest %.3f MiB; %ld reallocations\n",
+    a->nallocs, a->bytes/1048576.0, a->max/1048576.0, a->nreallocs);
+
+#if !defined(WIN32)
+  struct rusage ru;
+
+  if(getrusage(RUSAGE_SELF, &ru) == 0) {
+#if defined(__APPLE__)
+    long maxrss = ru.ru_maxrss/1024;    // Bytes on macOS
+#else
+    long maxrss = ru.ru_maxrss;
+#endif
+    imsg_info("peak resident set size %ld kB, %ld minor and %ld major page faults\n",
+      maxrss, (long) ru.ru_minflt, (long) ru.ru_majflt);
+  }
+#endif
+}
+
 void mmt_f_free(void *ptr) {
   mmt_free(ptr);
 }
@@ -437,6 +508,10 @@ int read_config(const char *file) {
     return -1;
   }
 
+  // Parsing may change or free parts and programmers: drop their lookup tables
+  index_avrparts(NULL);
+  index_programmers(NULL);
+
   cfg_lineno = 1;
   yyin = f;
 
@@ -491,6 +566,99 @@ const char *cache_string(const char *p) {
   return cx->cfg_hstrings[h][k] = mmt_strdup(p);
 }
 
+/*
+ * Open-addressing hash table for lookups by key bytes that are not copied
+ * and need not be nul terminated, eg, initial substrings of memory names or
+ * signatures; the keys must outlive the table. nocase compares ASCII letters
+ * irrespective of case. Used for lookup tables of parts, memories and
+ * programmers once avrdude.conf has been read.
+ */
+
+static unsigned hash_key(const Hash_table *t, const void *key, size_t len) {
+  const unsigned char *s = key;
+  unsigned h = 2166136261U;     // FNV-1a
+
+  if(t->nocase)
+    for(size_t i = 0; i < len; i++)
+      h = (h ^ (s[i] >= 'A' && s[i] <= 'Z'? s[i] + 'a' - 'A': s[i]))*16777619U;
+  else
+    for(size_t i = 0; i < len; i++)
+      h = (h ^ s[i])*16777619U;
+
+  return h;
+}
+
+static int hash_keyeq(const Hash_table *t, const Hash_entry *e, const void *key, size_t len) {
+  return e->len == len && (t->nocase? !strncasecmp(e->key, key, len): !memcmp(e->key, key, len));
+}
+
+Hash_table *hash_new(int nocase) {
+  Hash_table *t = mmt_malloc(sizeof *t);
+
+  t->size = 64;
+  t->nocase = nocase;
+  t->e = mmt_malloc(t->size*sizeof *t->e);
+
+  return t;
+}
+
+void hash_free(Hash_table *t) {
+  if(t) {
+    mmt_free(t->e);
+    mmt_free(t);
+  }
+}
+
+// Return the table entry for key or NULL if there is none
+Hash_entry *hash_get(const Hash_table *t, const void *key, size_t len) {
+  if(!t || !key)
+    return NULL;
+
+  for(unsigned i = hash_key(t, key, len) & (t->size - 1);; i = (i + 1) & (t->size - 1)) {
+    Hash_entry *e = t->e + i;
+
+    if(!e->key)
+      return NULL;
+    if(hash_keyeq(t, e, key, len))
+      return e;
+  }
+}
+
+// Return the table entry for key creating an empty one if needed
+Hash_entry *hash_put(Hash_table *t, const void *key, size_t len) {
+  Hash_entry *e = hash_get(t, key, len);
+
+  if(e)
+    return e;
+
+  if(2*(t->used + 1) > t->size) {       // Keep load factor at or below 1/2
+    Hash_entry *old = t->e;
+    int oldsize = t->size;
+
+    t->size *= 2;
+    t->e = mmt_malloc(t->size*sizeof *t->e);
+    for(int k = 0; k < oldsize; k++)
+      if(old[k].key)
+        for(unsigned i = hash_key(t, old[k].key, old[k].len) & (t->size - 1);; i = (i + 1) & (t->size - 1))
+          if(!t->e[i].key) {
+            t->e[i] = old[k];
+            break;
+          }
+    mmt_free(old);
+  }
+
+  unsigned i = hash_key(t, key, len) & (t->size - 1);
+
+  while(t->e[i].key)
+    i = (i + 1) & (t->size - 1);
+  e = t->e + i;
+  e->key = key;
+  e->len = len;
+  t->used++;
+
+  return e;
+}
+
 COMMENT *locate_comment(const LISTID comments, const char *where, int rhs) {
   if(comments)
     for(LNODEID ln = lfirst(comments); ln; ln = lnext(ln)) {
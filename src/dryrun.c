@@ -28,6 +28,7 @@
 #include <string.h>
 #include <errno.h>
 #include <ctype.h>
+#include <limits.h>
 #include <unistd.h>
 #include <stdarg.h>
 #include <time.h>
@@ -61,6 +62,18 @@ typedef struct {
   int datastart, datasize;      // Start and size of application data section (if any)
   int bootstart, bootsize;      // Start and size of boot section (if any)
   int initialised;              // 1 once the part memories are initialised
+  // Timing model of a physical programmer, all times in us
+  int timing;                   // Account for the time transactions would take
+  int sleep;                    // Also spend the simulated time in real time
+  int latency;                  // Round-trip time of a transaction
+  int bandwidth;                // Link throughput in bytes/s, 0 for infinite
+  int pagewrite, pageerase;     // NVM write and erase time of a page
+  int chiperase;                // NVM chip erase time
+  int burst;                    // Pages per paged transaction, 0 for any number
+  int checksum;                 // Offer device-side checksums for verification
+  double simtime;               // Simulated time of all transactions so far
+  uint64_t wallstart;           // avr_ustimestamp() when the programmer was opened
+  long ntrans, nbytes;          // Number of transactions and bytes sent or received
 } Dryrun_data;
 
 // Use private programmer data as if they were a global structure dry
@@ -72,6 +85,36 @@ typedef struct {
 
 static int dryrun_readonly(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, unsigned int addr);
 
+// Account for a transaction of nbytes over the link that keeps the NVM busy for nvm us
+static void timing(const PROGRAMMER *pgm, long nbytes, double nvm) {
+  if(!dry.timing)
+    return;
+
+  dry.simtime += dry.latency + nvm + (dry.bandwidth? nbytes*1e6/dry.bandwidth: 0);
+  dry.ntrans++;
+  dry.nbytes += nbytes;
+
+  if(dry.sleep) {               // Wait until wall time has caught up with simulated time
+    double ahead;
+
+    while((ahead = dry.wallstart + dry.simtime - avr_ustimestamp()) > 0)
+      usleep((useconds_t) (ahead > 500000? 500000: ahead));
+  }
+}
+
+// Account for the transactions of a paged access of n_bytes, each of up to dry.burst pages
+static void paged_timing(const PROGRAMMER *pgm, unsigned int page_size, unsigned int n_bytes, double nvm) {
+  unsigned int npages = (n_bytes + page_size - 1)/page_size;
+  unsigned int burst = dry.burst > 0 && (unsigned int) dry.burst < npages? (unsigned int) dry.burst: npages;
+
+  for(unsigned int pg = 0; pg < npages; pg += burst) {
+    unsigned int np = npages - pg < burst? npages - pg: burst;
+    unsigned int nb = pg + np < npages? np*page_size: n_bytes - pg*page_size;
+
+    timing(pgm, 8 + nb, np*nvm);
+  }
+}
+
 // Read expected signature bytes from part description
 static int dryrun_read_sig_bytes(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *sigmem) {
   pmsg_debug("%s()", __func__);
@@ -80,6 +123,7 @@ static int dryrun_read_sig_bytes(const PROGRAMMER *pgm, const AVRPART *p, const
     Return("memory size too small for %s()", __func__);
 
   memcpy(sigmem->buf, p->signature, 3);
+  timing(pgm, 4 + 3, 0);
   msg_debug(" returns 0x%02x%02x%02x\n", sigmem->buf[0], sigmem->buf[1], sigmem->buf[2]);
   return 3;
 }
@@ -95,6 +139,7 @@ static int dryrun_chip_erase(const PROGRAMMER *pgm, const AVRPART *punused) {
     Return("cannot locate %s flash memory for chip erase", dry.dp->desc);
   if(mem->size < 1)
     Return("cannot erase %s flash memory owing to its size %d", dry.dp->desc, mem->size);
+  timing(pgm, 4 + 4, dry.chiperase);
 
   if(dry.bl) {                  // Bootloaders won't overwrite themselves
     memset(mem->buf + (dry.bl == DRY_TOP? 0: dry.bootsize), 0xff, mem->size - dry.bootsize);
@@ -133,7 +178,8 @@ static int dryrun_cmd(const PROGRAMMER *pgm, const unsigned char *cmd, unsigned
     (cmd[0] == (Subc_STK_UNIVERSAL_CE >> 24) && cmd[1] == (uint8_t) (Subc_STK_UNIVERSAL_CE >> 16))) {
 
     ret = dryrun_chip_erase(pgm, NULL);
-  }
+  } else
+    timing(pgm, 4 + 4, 0);
   // Pretend call happened and all is good, returning 0xff each time
   memcpy(res, cmd + 1, 3);
   res[3] = 0xff;
@@ -160,12 +206,14 @@ static int dryrun_page_erase(const PROGRAMMER *pgm, const AVRPART *p, const AVRM
       str_ccinterval(addr, addr + dmem->page_size - 1), str_ccinterval(0, dmem->size - 1));
 
   memset(dmem->buf + addr, 0xff, dmem->page_size);
+  timing(pgm, 4 + 4, dry.pageerase);
 
   return 0;
 }
 
 static int dryrun_program_enable(const PROGRAMMER *pgm, const AVRPART *p_unused) {
   pmsg_debug("%s()\n", __func__);
+  timing(pgm, 4 + 4, 0);
 
   return 0;
 }
@@ -729,12 +777,16 @@ static void dryrun_disable(const PROGRAMMER *pgm) {
 
 static int dryrun_open(PROGRAMMER *pgm, const char *port) {
   pmsg_debug("%s(%s)\n", __func__, port? port: "NULL");
+  dry.wallstart = avr_ustimestamp();
 
   return 0;
 }
 
 static void dryrun_close(PROGRAMMER *pgm) {
   pmsg_debug("%s()\n", __func__);
+  if(dry.timing)
+    pmsg_info("%ld transactions with %ld bytes took %.3f s simulated and %.3f s wall time\n",
+      dry.ntrans, dry.nbytes, dry.simtime/1e6, (avr_ustimestamp() - dry.wallstart)/1e6);
 }
 
 // Emulate flash NOR-memory
@@ -774,6 +826,8 @@ static int dryrun_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const AVR
       Return("cannot write page [0x%04x, 0x%04x] to %s %s as it is incompatible with memory [0, 0x%04x]",
         addr, end - 1, dry.dp->desc, dmem->desc, dmem->size - 1);
 
+    // Bootloaders erase each page before writing it
+    paged_timing(pgm, page_size, n_bytes, dry.pagewrite + (dry.bl? dry.pageerase: 0));
     for(; addr < end; addr += chunk) {
       chunk = end - addr < page_size? end - addr: page_size;
       // @@@ Check for bootloader write protection here
@@ -820,6 +874,7 @@ static int dryrun_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVRM
       Return("cannot read page [0x%04x, 0x%04x] from %s %s as it is incompatible with memory [0, 0x%04x]",
         addr, end - 1, dry.dp->desc, dmem->desc, dmem->size - 1);
 
+    paged_timing(pgm, page_size, n_bytes, 0);
     for(; addr < end; addr += chunk) {
       chunk = end - addr < page_size? end - addr: page_size;
       memcpy(m->buf + addr, dmem->buf + addr, chunk);
@@ -829,6 +884,34 @@ static int dryrun_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVRM
   return n_bytes;
 }
 
+// Device-side CRC-32 of [addr, addr+len) in flash, EEPROM, bootrow or usersig
+static int dryrun_checksum(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int addr, unsigned int len, uint32_t *crc) {
+
+  AVRMEM *dmem;
+
+  pmsg_debug("%s(%s, 0x%04x, %u)\n", __func__, m->desc, addr, len);
+  if(!dry.dp)
+    Return("no dryrun device?");
+
+  if(!dry.checksum || !mem_is_paged_type(m)) // Verify by reading back unless -x checksum
+    return -2;
+
+  if(!(dmem = avr_locate_mem(dry.dp, m->desc)))
+    Return("cannot locate %s %s memory for checksum", dry.dp->desc, m->desc);
+  if(dmem->size != m->size)
+    Return("cannot compute checksum of %s %s as memory sizes differ: 0x%04x vs 0x%04x",
+      dry.dp->desc, dmem->desc, dmem->size, m->size);
+  if(addr >= (unsigned int) dmem->size || len > (unsigned int) dmem->size - addr)
+    Return("cannot compute checksum of [0x%04x, 0x%04x] of %s %s as it is incompatible with memory [0, 0x%04x]",
+      addr, addr + len - 1, dry.dp->desc, dmem->desc, dmem->size - 1);
+
+  *crc = avr_crc32(0, dmem->buf + addr, len);
+  timing(pgm, 8 + 4, 0);
+
+  return 0;
+}
+
 int dryrun_write_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
   unsigned long addr, unsigned char data) {
 
@@ -865,6 +948,7 @@ int dryrun_write_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
   }
 
   dmem->buf[addr] = data;
+  timing(pgm, 4 + 4, mem_is_io(dmem) || mem_is_sram(dmem)? 0: dry.pagewrite);
 
   if(mem_is_fuses(dmem) && addr < 16) { // Copy the byte to corresponding individual fuse
     for(LNODEID ln = lfirst(dry.dp->mem); ln; ln = lnext(ln)) {
@@ -909,6 +993,7 @@ int dryrun_read_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
     Return("classic part io/sram memories cannot be read externally");
 
   *value = dmem->buf[addr];
+  timing(pgm, 4 + 4, 0);
 
   msg_debug(" returns 0x%02x\n", *value);
   return 0;
@@ -972,6 +1057,13 @@ static void dryrun_setup(PROGRAMMER *pgm) {
   pmsg_debug("%s()\n", __func__);
   // Allocate dry
   pgm->cookie = mmt_malloc(sizeof(Dryrun_data));
+  // Defaults of the timing model resemble an ISP programmer at 115200 baud
+  dry.latency = 1000;
+  dry.bandwidth = 11520;
+  dry.pagewrite = 4500;
+  dry.pageerase = 4500;
+  dry.chiperase = 9000;
+  dry.burst = 1;
 }
 
 static void dryrun_teardown(PROGRAMMER *pgm) {
@@ -1011,6 +1103,32 @@ static int dryrun_parseextparams(const PROGRAMMER *pgm, const LISTID extparms) {
         dry.random = 1;
       continue;
     }
+    if(str_eq(xpara, "checksum")) {
+      dry.checksum = 1;
+      continue;
+    }
+    if(str_eq(xpara, "timing") || str_eq(xpara, "sleep")) {
+      dry.timing = 1;
+      if(str_eq(xpara, "sleep"))
+        dry.sleep = 1;
+      continue;
+    }
+    if(str_starts(xpara, "latency=") || str_starts(xpara, "bandwidth=") || str_starts(xpara, "pagewrite=") ||
+      str_starts(xpara, "pageerase=") || str_starts(xpara, "chiperase=") || str_starts(xpara, "burst=")) {
+      const char *errptr;
+      int val = str_int(strchr(xpara, '=') + 1, STR_INT32, &errptr);
+
+      if(errptr || val < 0) {
+        pmsg_error("cannot parse %s value: %s\n", xpara, errptr? errptr: "negative");
+        rc = -1;
+        break;
+      }
+      *(str_starts(xpara, "latency")? &dry.latency: str_starts(xpara, "bandwidth")? &dry.bandwidth:
+        str_starts(xpara, "pagewrite")? &dry.pagewrite: str_starts(xpara, "pageerase")? &dry.pageerase:
+        str_starts(xpara, "burst")? &dry.burst: &dry.chiperase) = val;
+      dry.timing = 1;
+      continue;
+    }
     if(str_eq(xpara, "help")) {
       help = true;
       rc = LIBAVRDUDE_EXIT;
@@ -1026,11 +1144,22 @@ static int dryrun_parseextparams(const PROGRAMMER *pgm, const LISTID extparms) {
     msg_error("  -x random     Initialise memories with random code/values (1, 3)\n");
     msg_error("  -x random=<n> Shortcut for -x random -x seed=<n>\n");
     msg_error("  -x seed=<n>   Seed random number generator with <n>, n>0, default time(NULL)\n");
+    msg_error("  -x checksum   Verify paged memories with device-side checksums (5)\n");
+    msg_error("  -x timing     Simulate the time transactions take with a physical programmer (4)\n");
+    msg_error("  -x sleep      Shortcut for -x timing that also spends the simulated time\n");
+    msg_error("  -x latency=<us>   Round-trip time of a transaction (default %d us)\n", dry.latency);
+    msg_error("  -x bandwidth=<n>  Link throughput in bytes/s, 0 for infinite (default %d)\n", dry.bandwidth);
+    msg_error("  -x pagewrite=<us> NVM write time of a page or byte (default %d us)\n", dry.pagewrite);
+    msg_error("  -x pageerase=<us> NVM erase time of a page (default %d us)\n", dry.pageerase);
+    msg_error("  -x chiperase=<us> NVM chip erase time (default %d us)\n", dry.chiperase);
+    msg_error("  -x burst=<n>      Pages per paged transaction, 0 for any number (default %d)\n", dry.burst);
     msg_error("  -x help       Show this help menu and exit\n");
     msg_error("Notes:\n");
     msg_error("  (1) -x init and -x random randomly configure flash wrt boot/data/code length\n");
     msg_error("  (2) Patterns can best be seen with fixed-width font on -U flash:r:-:I\n");
     msg_error("  (3) Choose, eg, -x seed=1 for reproducible flash configuration and output\n");
+    msg_error("  (4) Timing parameters imply -x timing; simulated time is reported on closing\n");
+    msg_error("  (5) Exercises the pgm->checksum() path that no hardware programmer implements yet\n");
     return rc;
   }
 
@@ -1066,6 +1195,8 @@ void dryrun_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = dryrun_paged_write;
   pgm->paged_load = dryrun_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines take any number of pages
+  pgm->checksum = dryrun_checksum;
   pgm->setup = dryrun_setup;
   pgm->teardown = dryrun_teardown;
   pgm->term_keep_alive = dryrun_term_keep_alive;
@@ -200,6 +200,140 @@ AVRMEM *fileio_any_memory(const char *name) {
   return avr_new_memory(name, ANY_MEM_SIZE);
 }
 
+/*
+ * Sparse multi-memory images only store the bytes that are set in the flat
+ * address space above. fileio_image_put() keeps the extents sorted by address
+ * and merges overlapping and adjacent ones, so an image read from a file
+ * holds one extent per consecutive run of bytes. fileio_image_add() appends
+ * an extent as is: fileio_image() writes these to a file in the order they
+ * were added, one segment each. Do not mix both for the same image.
+ */
+Memimage *fileio_new_image(void) {
+  return mmt_malloc(sizeof(Memimage));
+}
+
+void fileio_free_image(Memimage *img) {
+  if(img) {
+    for(int i = 0; i < img->n; i++)
+      mmt_free(img->ext[i].buf);
+    mmt_free(img->ext);
+    mmt_free(img);
+  }
+}
+
+// Make room for an extent at position i and return it
+static Extent *image_insert(Memimage *img, int i) {
+  if(img->n == img->nalloc) {
+    img->nalloc = img->nalloc? 2*img->nalloc: 8;
+    img->ext = mmt_realloc(img->ext, img->nalloc*sizeof *img->ext);
+  }
+  memmove(img->ext + i + 1, img->ext + i, (img->n - i)*sizeof *img->ext);
+  img->n++;
+  memset(img->ext + i, 0, sizeof *img->ext);
+
+  return img->ext + i;
+}
+
+static void extent_reserve(Extent *x, int len) {
+  if(len > x->cap) {
+    x->cap = len > 2*x->cap? len: 2*x->cap;
+    x->buf = mmt_realloc(x->buf, x->cap);
+  }
+}
+
+// Append data as a new extent
+void fileio_image_add(Memimage *img, unsigned addr, const unsigned char *data, int len) {
+  if(len > 0) {
+    Extent *x = image_insert(img, img->n);
+
+    x->addr = addr;
+    extent_reserve(x, x->len = len);
+    memcpy(x->buf, data, len);
+  }
+}
+
+// Set len bytes from addr onwards; data overwrite what the image might already hold there
+void fileio_image_put(Memimage *img, unsigned addr, const unsigned char *data, int len) {
+  if(len <= 0)
+    return;
+
+  unsigned end = addr + len;
+  int lo = 0, hi, n = img->n;
+  Extent *x = img->ext;
+
+  // Find first extent that ends at or after addr; files are mostly read in ascending order
+  if(n && x[n - 1].addr <= addr)
+    lo = x[n - 1].addr + x[n - 1].len >= addr? n - 1: n;
+  else
+    for(hi = n; lo < hi;) {     // Binary search
+      int mid = (lo + hi)/2;
+
+      if(x[mid].addr + x[mid].len >= addr)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+
+  // Extents lo, ..., hi-1 overlap or touch [addr, end)
+  for(hi = lo; hi < n && x[hi].addr <= end; hi++)
+    continue;
+
+  if(hi == lo) {
+    x = image_insert(img, lo);
+    x->addr = addr;
+    extent_reserve(x, x->len = len);
+    memcpy(x->buf, data, len);
+    return;
+  }
+
+  // Merge all of them into extent lo
+  x = img->ext + lo;
+  unsigned last = x[hi - 1 - lo].addr + x[hi - 1 - lo].len;
+  unsigned from = addr < x->addr? addr: x->addr, to = end > last? end: last;
+
+  extent_reserve(x, to - from);
+  if(from < x->addr)
+    memmove(x->buf + (x->addr - from), x->buf, x->len);
+  for(int i = 1; i < hi - lo; i++) {
+    memcpy(x->buf + (x[i].addr - from), x[i].buf, x[i].len);
+    mmt_free(x[i].buf);
+  }
+  memcpy(x->buf + (addr - from), data, len);
+  x->addr = from;
+  x->len = to - from;
+
+  memmove(x + 1, x + (hi - lo), (n - hi)*sizeof *x);
+  img->n -= hi - lo - 1;
+}
+
+/*
+ * Copy the bytes that the image holds in [addr, addr+len) to the buffer of
+ * mem from memaddr onwards and tag them as allocated there (mem can be NULL);
+ * return the offset of the highest byte set plus one or 0 if the image has
+ * no data in that interval
+ */
+int fileio_image_get(const Memimage *img, unsigned addr, int len, const AVRMEM *mem, int memaddr) {
+  unsigned end = addr + len;
+  int ret = 0;
+
+  for(int i = 0; i < img->n; i++) {
+    const Extent *x = img->ext + i;
+    unsigned from = x->addr > addr? x->addr: addr;
+    unsigned to = x->addr + x->len < end? x->addr + x->len: end;
+
+    if(from >= to)
+      continue;
+    if(mem) {
+      memcpy(mem->buf + memaddr + (from - addr), x->buf + (from - x->addr), to - from);
+      avr_tag_range(mem, memaddr + (from - addr), to - from, 1);
+    }
+    if((int) (to - addr) > ret)
+      ret = to - addr;
+  }
+
+  return ret;
+}
+
 #define boffset(p, basemem) baseoffset((p), avr_locate_ ## basemem(p), # basemem)
 
 static int baseoffset(const AVRPART *p, const AVRMEM *base, const char *memname) {
@@ -281,8 +415,8 @@ static void print_ihex_extended_addr(int n_64k, FILE *outf) {
 /*
  * Binary buffer to Intel Hex, see https://en.wikipedia.org/wiki/Intel_HEX
  *
- * Given a buffer and a single segment, segp, an open file 'outf' to which to
- * write Intel Hex formatted data, the desired record size recsize, an
+ * Given a single segment, segp, its contents data, an open file 'outf' to
+ * which to write Intel Hex formatted data, the desired record size recsize, an
  * AVR32-specific memory offset startaddr and the name of the output file,
  * write a valid Intel Hex file. Where indicates whether this is the first
  * segment to be written to the file or the last segment (or both).
@@ -290,10 +424,10 @@ static void print_ihex_extended_addr(int n_64k, FILE *outf) {
  * Return the maximum memory address within mem->buf that was read from plus
  * one. If an error occurs, return -1.
  */
-static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, Segorder where,
-  int recsize, int startaddr, const char *outfile_unused, FILE *outf, FILEFMT ffmt) {
+static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, const unsigned char *data,
+  Segorder where, int recsize, int startaddr, const char *outfile_unused, FILE *outf, FILEFMT ffmt) {
 
-  const unsigned char *buf = mem->buf;
+  const unsigned char *buf = data;
   int bufsize = segp->len;
   unsigned int nextaddr;
   int n, hiaddr, n_64k;
@@ -306,7 +440,6 @@ static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, Sego
   nextaddr = (unsigned) (startaddr + segp->addr)%0x10000;
   n_64k = (unsigned) (startaddr + segp->addr)/0x10000;
   hiaddr = segp->addr;
-  buf += segp->addr;
 
   // Give address unless it's the first segment and it would be the default 0
   if(!((where & FIRST_SEG) && n_64k == 0))
@@ -377,71 +510,50 @@ static int b2ihex(const AVRPART *p, const AVRMEM *mem, const Segment *segp, Sego
   return hiaddr;
 }
 
-static int ihex_readrec(struct ihexsrec *ihex, char *rec) {
-  int i, j;
-  char buf[8];
-  int offset, len;
-  char *e;
-  unsigned char cksum;
-
-  len = strlen(rec);
-  offset = 1;
-  cksum = 0;
+// Value of hex digits; other characters map to 0x10
+static const unsigned char hexval[256] = {
+#define X16 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+  X16, X16, X16,
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 10, 11, 12, 13, 14, 15, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  X16,
+  0x10, 10, 11, 12, 13, 14, 15, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  X16, X16, X16, X16, X16, X16, X16, X16, X16,
+#undef X16
+};
 
-  // Reclen
-  if(offset + 2 > len)
-    return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  ihex->reclen = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
-    return -1;
+// Decode n bytes from 2n hex digits at str into buf; return their sum or -1 if a digit is invalid
+static int hex2bytes(unsigned char *buf, const char *str, int n) {
+  const unsigned char *s = (const unsigned char *) str;
+  int sum = 0, bad = 0;
 
-  // Load offset
-  if(offset + 4 > len)
-    return -1;
-  for(i = 0; i < 4; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  ihex->loadofs = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
-    return -1;
+  for(int i = 0; i < n; i++, s += 2) {
+    int hi = hexval[s[0]], lo = hexval[s[1]];
 
-  // Record type
-  if(offset + 2 > len)
-    return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  ihex->rectyp = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
-    return -1;
+    bad |= hi | lo;
+    sum += buf[i] = hi << 4 | lo;
+  }
 
-  cksum = ihex->reclen + ((ihex->loadofs >> 8) & 0x0ff) + (ihex->loadofs & 0x0ff) + ihex->rectyp;
+  return bad & 0x10? -1: sum;
+}
 
-  // Data
-  for(j = 0; j < ihex->reclen; j++) {
-    if(offset + 2 > len)
-      return -1;
-    for(i = 0; i < 2; i++)
-      buf[i] = rec[offset++];
-    buf[i] = 0;
-    ihex->data[j] = strtoul(buf, &e, 16);
-    if(e == buf || *e != 0)
-      return -1;
-    cksum += ihex->data[j];
-  }
+// Parse Intel Hex record rec of length len; return computed checksum or -1 if malformed
+static int ihex_readrec(struct ihexsrec *ihex, const char *rec, int len) {
+  unsigned char head[4];
+  int cksum, sum;
 
-  // Cksum
-  if(offset + 2 > len)
+  // Reclen, load offset and record type
+  if(len < 1 + 2*4 || (cksum = hex2bytes(head, rec + 1, 4)) < 0)
     return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  ihex->cksum = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
+  ihex->reclen = head[0];
+  ihex->loadofs = head[1] << 8 | head[2];
+  ihex->rectyp = head[3];
+
+  // Data and cksum
+  if(len < 1 + 2*(4 + ihex->reclen + 1) || (sum = hex2bytes(ihex->data, rec + 9, ihex->reclen)) < 0 ||
+    hex2bytes(&ihex->cksum, rec + 9 + 2*ihex->reclen, 1) < 0)
     return -1;
+  cksum += sum;
 
   pmsg_debug("read ihex record type 0x%02x at 0x%04x with %2d bytes and chksum 0x%02x (0x%02x)\n",
     ihex->rectyp, ihex->loadofs, ihex->reclen, ihex->cksum, -cksum & 0xff);
@@ -449,8 +561,72 @@ static int ihex_readrec(struct ihexsrec *ihex, char *rec) {
   return -cksum & 0xff;
 }
 
-// Extract correct memory from large any memory assuming multi-memory model
-static int any2mem(const AVRPART *p, const AVRMEM *mem, const Segment *segp, const AVRMEM *any, unsigned maxsize) {
+/*
+ * Line reader for record files: reads the file in large blocks and returns
+ * lines in place without allocating memory for each line
+ */
+typedef struct {
+  FILE *fp;
+  char *buf;                    // Holds lines from beg to end
+  int size, beg, end, eof;
+  const char *err;
+} Linereader;
+
+static void lr_init(Linereader *lr, FILE *fp) {
+  memset(lr, 0, sizeof *lr);
+  lr->fp = fp;
+  lr->size = 1 << 16;
+  lr->buf = mmt_malloc(lr->size);
+}
+
+static void lr_free(Linereader *lr) {
+  mmt_free(lr->buf);
+  lr->buf = NULL;
+}
+
+// Return next line without \n and set *lenp to its length; return NULL at EOF or on error
+static char *lr_getline(Linereader *lr, int *lenp) {
+  while(1) {
+    char *s = lr->buf + lr->beg, *nl = memchr(s, '\n', lr->end - lr->beg);
+
+    if(nl || (lr->eof && lr->end > lr->beg)) {
+      int n = nl? nl - s: lr->end - lr->beg;
+
+      s[n] = 0;                 // Room for a terminating nul is always left in buf
+      lr->beg += nl? n + 1: n;
+      *lenp = strlen(s);
+      return s;
+    }
+    if(lr->eof)
+      return NULL;
+
+    // Move incomplete line to the front and read next block
+    lr->end -= lr->beg;
+    memmove(lr->buf, s, lr->end);
+    lr->beg = 0;
+    if(lr->end >= lr->size/2) {
+      if(lr->size >= INT_MAX/2) {
+        lr->err = "cannot cope with lines longer than INT_MAX/2 bytes";
+        return NULL;
+      }
+      lr->size *= 2;
+      lr->buf = mmt_realloc(lr->buf, lr->size);
+    }
+    size_t got = fread(lr->buf + lr->end, 1, lr->size - 1 - lr->end, lr->fp);
+
+    if(got == 0) {
+      if(ferror(lr->fp)) {
+        lr->err = "I/O error";
+        return NULL;
+      }
+      lr->eof = 1;
+    }
+    lr->end += got;
+  }
+}
+
+// Extract correct memory from sparse multi-memory image
+static int image2mem(const AVRPART *p, const AVRMEM *mem, const Segment *segp, const Memimage *img, unsigned maxsize) {
 
   // Compute location for multi-memory file input
   unsigned location = maxsize > MEND(FLASH) + 1? fileio_mem_offset(p, mem): 0;
@@ -458,37 +634,27 @@ static int any2mem(const AVRPART *p, const AVRMEM *mem, const Segment *segp, con
   if(location == ~0U)
     return -1;
 
-  unsigned ret = 0;
-
   // Copy over memory to right place and return highest written address plus one
-  for(unsigned i = segp->addr, end = segp->addr + segp->len; i < end; i++)
-    if(any->tags[location + i]) {
-      mem->buf[i] = any->buf[location + i];
-      mem->tags[i] = any->tags[location + i];
-      ret = i + 1;
-    }
+  int ret = fileio_image_get(img, location + segp->addr, segp->len, mem, segp->addr);
 
-  return ret;
+  return ret? segp->addr + ret: 0;
 }
 
 /*
- * Intel Hex to binary buffer
+ * Intel Hex to sparse image
  *
  * Given an open file 'inf' which contains Intel Hex formatted data, parse the
- * file, which potentially contains many AVR memories, and lay it out in a
- * temporary AVR "any memory". This also determines whether inf contains the
- * AVR memory mem to write to. Only the segment within mem->buf, segp, is
- * written to.
+ * file, which potentially contains many AVR memories, and lay it out in the
+ * multi-memory image img.
  *
- * Return 0 if nothing was written, otherwise the maximum memory address within
- * mem->buf that was written plus one. On error, return -1.
+ * Return the highest address of the image that was written plus one. On
+ * error, return -1.
  */
-static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM *mem,
-  const Segment *segp, unsigned int fileoffset, FILEFMT ffmt) {
+static int ihex2img(const char *infile, FILE *inf, const AVRPART *p, Memimage *img,
+  unsigned int fileoffset, FILEFMT ffmt) {
 
-  const char *errstr;
   unsigned int nextaddr, baseaddr, maxaddr;
-  int lineno, rc;
+  int lineno, rc, len;
   struct ihexsrec ihex;
 
   lineno = 0;
@@ -497,27 +663,22 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
   nextaddr = 0;
   rewind(inf);
 
-  AVRMEM *any = fileio_any_memory("any");
+  Linereader lr;
 
-  for(char *buffer; (buffer = str_fgets(inf, &errstr)); mmt_free(buffer)) {
+  lr_init(&lr, inf);
+  for(char *buffer; (buffer = lr_getline(&lr, &len));) {
     lineno++;
-    int len = strlen(buffer);
-
-    if(len > 0 && buffer[len - 1] == '\n')
-      buffer[--len] = 0;
     if(len == 0 || buffer[0] != ':')
       continue;
-    rc = ihex_readrec(&ihex, buffer);
+    rc = ihex_readrec(&ihex, buffer, len);
     if(rc < 0) {
       pmsg_error("invalid record at line %d of %s\n", lineno, infile);
-      mmt_free(buffer);
       goto error;
     }
     if(rc != ihex.cksum) {
       if(ffmt == FMT_IHEX) {
         pmsg_error("checksum mismatch at line %d of %s\n", lineno, infile);
         imsg_error("checksum=0x%02x, computed checksum=0x%02x\n", ihex.cksum, rc);
-        mmt_free(buffer);
         goto error;
       }
       // Just warn with more permissive format FMT_IHXC
@@ -525,7 +686,7 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
       imsg_notice("checksum=0x%02x, computed checksum=0x%02x\n", ihex.cksum, rc);
     }
 
-    unsigned below = 0, anysize = any->size;
+    unsigned below = 0, anysize = ANY_MEM_SIZE;
 
     switch(ihex.rectyp) {
     case 0:                    // Data record
@@ -534,7 +695,6 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
           pmsg_error("address 0x%06x below memory offset 0x%x at line %d of %s;\n",
             ihex.loadofs + baseaddr, fileoffset, lineno, infile);
           imsg_error("use -F to skip this check\n");
-          mmt_free(buffer);
           goto error;
         }
         pmsg_warning("address 0x%06x below memory offset 0x%x at line %d of %s: ",
@@ -554,7 +714,6 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
           pmsg_error("Intel Hex record [0x%06x, 0x%06x] out of range [0, 0x%06x]\n",
             nextaddr, nextaddr + ihex.reclen - 1, anysize - 1);
           imsg_error("at line %d of %s; use -F to skip this check\n", lineno, infile);
-          mmt_free(buffer);
           goto error;
         }
         pmsg_warning("Intel Hex record [0x%06x, 0x%06x] out of range [0, 0x%06x]: ",
@@ -566,16 +725,12 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
         }
         msg_warning("%s it\n", ihex.reclen? "clipping": "ignoring");
       }
-      for(int i = 0; i < ihex.reclen; i++) {
-        any->buf[nextaddr + i] = ihex.data[below + i];
-        any->tags[nextaddr + i] = TAG_ALLOCATED;
-      }
+      fileio_image_put(img, nextaddr, ihex.data + below, ihex.reclen);
       if(!ovsigck && nextaddr == mulmem[MULTI_SIGROW].base && ihex.reclen >= 3)
-        if(!avr_sig_compatible(p->signature, any->buf + nextaddr)) {
+        if(!avr_sig_compatible(p->signature, ihex.data + below)) {
           pmsg_error("signature of %s incompatible with file's (%s);\n", p->desc,
-            str_ccmcunames_signature(any->buf + nextaddr, PM_ALL));
+            str_ccmcunames_signature(ihex.data + below, PM_ALL));
           imsg_error("use -F to override this check\n");
-          mmt_free(buffer);
           goto error;
         }
       if(ihex.reclen && nextaddr + ihex.reclen > maxaddr)
@@ -583,7 +738,6 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
       break;
 
     case 1:                    // End of file record
-      mmt_free(buffer);
       goto done;
 
     case 2:                    // Extended segment address record
@@ -604,13 +758,12 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
 
     default:
       pmsg_error("do not know how to deal with rectype=%d " "at line %d of %s\n", ihex.rectyp, lineno, infile);
-      mmt_free(buffer);
       goto error;
     }
   }
 
-  if(errstr) {
-    pmsg_error("read error in Intel Hex file %s: %s\n", infile, errstr);
+  if(lr.err) {
+    pmsg_error("read error in Intel Hex file %s: %s\n", infile, lr.err);
     goto error;
   }
 
@@ -622,17 +775,37 @@ static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM
   pmsg_warning("no end of file record found for Intel Hex file %s\n", infile);
 
 done:
-  rc = any2mem(p, mem, segp, any, maxaddr);
-  avr_free_mem(any);
-  if(!rc)
-    pmsg_warning("no %s data found in Intel Hex file %s\n", mem->desc, infile);
-  return rc;
+  lr_free(&lr);
+  return maxaddr;
 
 error:
-  avr_free_mem(any);
+  lr_free(&lr);
   return -1;
 }
 
+/*
+ * Intel Hex to binary buffer
+ *
+ * Parse the Intel Hex file 'inf' into a temporary sparse multi-memory image.
+ * This also determines whether inf contains the AVR memory mem to write to.
+ * Only the segment within mem->buf, segp, is written to.
+ *
+ * Return 0 if nothing was written, otherwise the maximum memory address within
+ * mem->buf that was written plus one. On error, return -1.
+ */
+static int ihex2b(const char *infile, FILE *inf, const AVRPART *p, const AVRMEM *mem,
+  const Segment *segp, unsigned int fileoffset, FILEFMT ffmt) {
+
+  Memimage *img = fileio_new_image();
+  int rc = ihex2img(infile, inf, p, img, fileoffset, ffmt);
+
+  if(rc >= 0 && !(rc = image2mem(p, mem, segp, img, rc)))
+    pmsg_warning("no %s data found in Intel Hex file %s\n", mem->desc, infile);
+  fileio_free_image(img);
+
+  return rc;
+}
+
 static unsigned int cksum_srec(const unsigned char *buf, int n, unsigned addr, int addr_width) {
   unsigned char cksum = n + addr_width + 1;
 
@@ -646,14 +819,14 @@ static unsigned int cksum_srec(const unsigned char *buf, int n, unsigned addr, i
 }
 
 // Binary to Motorola S-Record, see https://en.wikipedia.org/wiki/SREC_(file_format)
-static int b2srec(const AVRMEM *mem, const Segment *segp, Segorder where,
+static int b2srec(const AVRMEM *mem, const Segment *segp, const unsigned char *data, Segorder where,
   int recsize, int startaddr, const char *outfile_unused, FILE *outf) {
 
   const unsigned char *buf;
   unsigned int nextaddr;
   int n, hiaddr, addr_width;
 
-  buf = mem->buf + segp->addr;
+  buf = data;
   nextaddr = startaddr + segp->addr;
   hiaddr = 0;
 
@@ -723,88 +896,45 @@ static int b2srec(const AVRMEM *mem, const Segment *segp, Segorder where,
   return hiaddr;
 }
 
-static int srec_readrec(struct ihexsrec *srec, char *rec) {
-  int i, j;
-  char buf[8];
-  int offset, len, addr_width;
-  char *e;
-  unsigned char cksum;
-  int rc;
-
-  len = strlen(rec);
-  offset = 1;
-  cksum = 0;
-  addr_width = 2;
+// Parse Motorola S-Record rec of length len; return computed checksum or -1 if malformed
+static int srec_readrec(struct ihexsrec *srec, const char *rec, int len) {
+  unsigned char addr[4];
+  int addr_width, cksum, sum;
 
   // Record type
-  if(offset + 1 > len)
-    return -1;
-  srec->rectyp = rec[offset++];
-  if(srec->rectyp == 0x32 || srec->rectyp == 0x38)
-    addr_width = 3;             // S2 or S8-record
-  else if(srec->rectyp == 0x33 || srec->rectyp == 0x37)
-    addr_width = 4;             // S3 or S7-record
-
-  // Reclen
-  if(offset + 2 > len)
-    return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  srec->reclen = strtoul(buf, &e, 16);
-  cksum += srec->reclen;
-  srec->reclen -= (addr_width + 1);
-  if(e == buf || *e != 0)
+  if(len < 2)
     return -1;
+  srec->rectyp = rec[1];
+  addr_width = srec->rectyp == '2' || srec->rectyp == '8'? 3: // S2 or S8-record
+    srec->rectyp == '3' || srec->rectyp == '7'? 4: 2;  // S3 or S7-record
 
-  // Load offset
-  if(offset + addr_width > len)
-    return -1;
-  for(i = 0; i < addr_width*2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  srec->loadofs = strtoull(buf, &e, 16);
-  if(e == buf || *e != 0)
+  // Reclen and load offset
+  if(len < 2 + 2*(1 + addr_width) || (cksum = hex2bytes(&srec->reclen, rec + 2, 1)) < 0 ||
+    (sum = hex2bytes(addr, rec + 4, addr_width)) < 0)
     return -1;
+  cksum += sum;
+  srec->reclen -= addr_width + 1;
+  srec->loadofs = 0;
+  for(int i = 0; i < addr_width; i++)
+    srec->loadofs = srec->loadofs << 8 | addr[i];
 
-  for(i = addr_width; i > 0; i--)
-    cksum += (srec->loadofs >> (i - 1)*8) & 0xff;
+  // Data and cksum
+  const char *data = rec + 4 + 2*addr_width;
 
-  // Data
-  for(j = 0; j < srec->reclen; j++) {
-    if(offset + 2 > len)
-      return -1;
-    for(i = 0; i < 2; i++)
-      buf[i] = rec[offset++];
-    buf[i] = 0;
-    srec->data[j] = strtoul(buf, &e, 16);
-    if(e == buf || *e != 0)
-      return -1;
-    cksum += srec->data[j];
-  }
-
-  // Cksum
-  if(offset + 2 > len)
-    return -1;
-  for(i = 0; i < 2; i++)
-    buf[i] = rec[offset++];
-  buf[i] = 0;
-  srec->cksum = strtoul(buf, &e, 16);
-  if(e == buf || *e != 0)
+  if(len < data - rec + 2*(srec->reclen + 1) || (sum = hex2bytes(srec->data, data, srec->reclen)) < 0 ||
+    hex2bytes(&srec->cksum, data + 2*srec->reclen, 1) < 0)
     return -1;
+  cksum += sum;
 
-  rc = 0xff - cksum;
-  return rc;
+  return 0xff - (cksum & 0xff);
 }
 
-// Motorola S-Record to binary
-static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
-  const AVRMEM *mem, const Segment *segp, unsigned int fileoffset) {
+// Motorola S-Record to sparse image; return highest address written plus one or -1 on error
+static int srec2img(const char *infile, FILE *inf, const AVRPART *p, Memimage *img, unsigned int fileoffset) {
 
-  const char *errstr;
   unsigned int nextaddr, maxaddr;
   struct ihexsrec srec;
-  int lineno, rc, hexdigs;
+  int lineno, rc, hexdigs, len;
   unsigned int reccount;
   unsigned char datarec;
 
@@ -813,26 +943,21 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
   reccount = 0;
   rewind(inf);
 
-  AVRMEM *any = fileio_any_memory("any");
+  Linereader lr;
 
-  for(char *buffer; (buffer = str_fgets(inf, &errstr)); mmt_free(buffer)) {
+  lr_init(&lr, inf);
+  for(char *buffer; (buffer = lr_getline(&lr, &len));) {
     lineno++;
-    int len = strlen(buffer);
-
-    if(len > 0 && buffer[len - 1] == '\n')
-      buffer[--len] = 0;
     if(len == 0 || buffer[0] != 'S')
       continue;
-    rc = srec_readrec(&srec, buffer);
+    rc = srec_readrec(&srec, buffer, len);
     if(rc < 0) {
       pmsg_error("invalid record at line %d of %s\n", lineno, infile);
-      mmt_free(buffer);
       goto error;
     }
     if(rc != srec.cksum) {
       pmsg_error("checksum mismatch at line %d of %s\n", lineno, infile);
       imsg_error("checksum=0x%02x, computed checksum=0x%02x\n", srec.cksum, rc);
-      mmt_free(buffer);
       goto error;
     }
 
@@ -858,14 +983,12 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
 
     case '4':                  // S4: symbol record (LSI extension)
       pmsg_error("not supported record at line %d of %s\n", lineno, infile);
-      mmt_free(buffer);
       goto error;
 
     case '5':                  // S5: count of S1, S2 and S3 records previously tx'd
       if(srec.loadofs != reccount) {
         pmsg_error("count of transmitted data records mismatch at line %d of %s\n", lineno, infile);
         imsg_error("transmitted data records= %d, expected value= %d\n", reccount, srec.loadofs);
-        mmt_free(buffer);
         goto error;
       }
       break;
@@ -873,26 +996,23 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
     case '7':                  // S7: end record for 32 bit addresses
     case '8':                  // S8: end record for 24 bit addresses
     case '9':                  // S9: end record for 16 bit addresses
-      mmt_free(buffer);
       goto done;
 
     default:
       pmsg_error("do not know how to deal with rectype S%d at line %d of %s\n",
         srec.rectyp, lineno, infile);
-      mmt_free(buffer);
       goto error;
     }
 
     if(datarec == 1) {
       nextaddr = srec.loadofs;
-      unsigned below = 0, anysize = any->size;
+      unsigned below = 0, anysize = ANY_MEM_SIZE;
 
       if(nextaddr < fileoffset) {
         if(!ovsigck) {
           pmsg_error("address 0x%0*x below memory offset 0x%x at line %d of %s\n",
             hexdigs, nextaddr, fileoffset, lineno, infile);
           imsg_error("use -F to skip this check\n");
-          mmt_free(buffer);
           goto error;
         }
         pmsg_warning("address 0x%0*x below memory offset 0x%x at line %d of %s: ",
@@ -912,7 +1032,6 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
           pmsg_error("Motorola S-Record [0x%06x, 0x%06x] out of range [0, 0x%06x]\n",
             nextaddr, nextaddr + srec.reclen - 1, anysize - 1);
           imsg_error("at line %d of %s; use -F to skip this check\n", lineno, infile);
-          mmt_free(buffer);
           goto error;
         }
         pmsg_warning("Motorola S-Record [0x%06x, 0x%06x] out of range [0, 0x%06x]: ",
@@ -924,16 +1043,12 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
         }
         msg_warning("%s it\n", srec.reclen? "clipping": "ignoring");
       }
-      for(int i = 0; i < srec.reclen; i++) {
-        any->buf[nextaddr + i] = srec.data[below + i];
-        any->tags[nextaddr + i] = TAG_ALLOCATED;
-      }
+      fileio_image_put(img, nextaddr, srec.data + below, srec.reclen);
       if(!ovsigck && nextaddr == mulmem[MULTI_SIGROW].base && srec.reclen >= 3)
-        if(!avr_sig_compatible(p->signature, any->buf + nextaddr)) {
+        if(!avr_sig_compatible(p->signature, srec.data + below)) {
           pmsg_error("signature of %s incompatible with file's (%s);\n", p->desc,
-            str_ccmcunames_signature(any->buf + nextaddr, PM_ALL));
+            str_ccmcunames_signature(srec.data + below, PM_ALL));
           imsg_error("use -F to override this check\n");
-          mmt_free(buffer);
           goto error;
         }
 
@@ -943,24 +1058,35 @@ static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
     }
   }
 
-  if(errstr) {
-    pmsg_error("read error in Motorola S-Record file %s: %s\n", infile, errstr);
+  if(lr.err) {
+    pmsg_error("read error in Motorola S-Record file %s: %s\n", infile, lr.err);
     goto error;
   }
 
   pmsg_warning("no end of file record found for Motorola S-Records file %s\n", infile);
 done:
-  rc = any2mem(p, mem, segp, any, maxaddr);
-  avr_free_mem(any);
-  if(!rc)
-    pmsg_warning("no %s data found in Motorola S-Record file %s\n", mem->desc, infile);
-  return rc;
+  lr_free(&lr);
+  return maxaddr;
 
 error:
-  avr_free_mem(any);
+  lr_free(&lr);
   return -1;
 }
 
+// Motorola S-Record to binary
+static int srec2b(const char *infile, FILE *inf, const AVRPART *p,
+  const AVRMEM *mem, const Segment *segp, unsigned int fileoffset) {
+
+  Memimage *img = fileio_new_image();
+  int rc = srec2img(infile, inf, p, img, fileoffset);
+
+  if(rc >= 0 && !(rc = image2mem(p, mem, segp, img, rc)))
+    pmsg_warning("no %s data found in Motorola S-Record file %s\n", mem->desc, infile);
+  fileio_free_image(img);
+
+  return rc;
+}
+
 #ifdef HAVE_LIBELF
 
 /*
@@ -1035,15 +1161,19 @@ static int elf_mem_limits(const AVRMEM *mem, const AVRPART *p,
   return rv;
 }
 
-// ELF format to binary (the memory segment to read into is ignored)
+/*
+ * ELF format to binary (the memory segment to read into is ignored); if img
+ * is not NULL read all sections in the multi-memory address space into the
+ * sparse image instead, mem then is the descriptor of the flat address space
+ */
 static int elf2b(const char *infile, FILE *inf, const AVRMEM *mem,
-  const AVRPART *p, const Segment *segp_unused, unsigned int fileoffset_unused) {
+  const AVRPART *p, const Segment *segp_unused, unsigned int fileoffset_unused, Memimage *img) {
 
   Elf *e;
   int rv = 0, size = 0;
-  unsigned int low, high, foff;
+  unsigned int low = 0, high = mem->size, foff = 0;
 
-  if(elf_mem_limits(mem, p, &low, &high, &foff) != 0) {
+  if(!img && elf_mem_limits(mem, p, &low, &high, &foff) != 0) {
     pmsg_error("cannot handle %s memory region from ELF file\n", mem->desc);
     return -1;
   }
@@ -1054,7 +1184,7 @@ static int elf2b(const char *infile, FILE *inf, const AVRMEM *mem,
    * allows to select only the appropriate sections out of an ELF file that
    * contains section data for more than one sub-segment.
    */
-  if(is_pdi(p) && mem_is_in_flash(mem) && !mem_is_flash(mem)) {
+  if(!img && is_pdi(p) && mem_is_in_flash(mem) && !mem_is_flash(mem)) {
     AVRMEM *flashmem = avr_locate_flash(p);
 
     if(flashmem == NULL) {
@@ -1218,7 +1348,7 @@ static int elf2b(const char *infile, FILE *inf, const AVRMEM *mem,
           } else {
             pmsg_debug("extracting one byte from file offset %d\n", foff);
             mem->buf[0] = ((unsigned char *) d->d_buf)[foff];
-            mem->tags[0] = TAG_ALLOCATED;
+            avr_tag_set(mem, 0);
             size = 1;
           }
         } else {
@@ -1229,8 +1359,12 @@ static int elf2b(const char *infile, FILE *inf, const AVRMEM *mem,
             if(end > size)
               size = end;
             pmsg_debug("writing %d bytes to mem offset 0x%x\n", end - idx, idx);
-            memcpy(mem->buf + idx, d->d_buf, end - idx);
-            memset(mem->tags + idx, TAG_ALLOCATED, end - idx);
+            if(img) {
+              fileio_image_put(img, idx, d->d_buf, end - idx);
+            } else {
+              memcpy(mem->buf + idx, d->d_buf, end - idx);
+              avr_tag_range(mem, idx, end - idx, 1);
+            }
           } else {
             pmsg_error("section %s [0x%04x, 0x%04x] does not fit into %s [0, 0x%04x]\n",
               sname, idx, (int) (idx + d->d_size - 1), mem->desc, mem->size - 1);
@@ -1247,7 +1381,8 @@ done:
 #endif                          // HAVE_LIBELF
 
 // Read/write binary files and return highest memory addr set + 1
-static int fileio_rbin(struct fioparms *fio, const char *filename, FILE *f, const AVRMEM *mem, const Segment *segp) {
+static int fileio_rbin(struct fioparms *fio, const char *filename, FILE *f,
+  const AVRMEM *mem, const Segment *segp, const unsigned char *data) {
 
   int rc;
 
@@ -1255,10 +1390,10 @@ static int fileio_rbin(struct fioparms *fio, const char *filename, FILE *f, cons
   case FIO_READ:
     rc = fread(mem->buf + segp->addr, 1, segp->len, f);
     if(rc > 0)
-      memset(mem->tags + segp->addr, TAG_ALLOCATED, rc);
+      avr_tag_range(mem, segp->addr, rc, 1);
     break;
   case FIO_WRITE:
-    rc = fwrite(mem->buf + segp->addr, 1, segp->len, f);
+    rc = fwrite(data, 1, segp->len, f);
     break;
   default:
     pmsg_error("invalid fileio operation=%d\n", fio->op);
@@ -1293,7 +1428,7 @@ static int fileio_imm(struct fioparms *fio, const char *fname, FILE *f_unused,
         mmt_free(line);
         return -1;
       }
-      memset(mem->tags + n, TAG_ALLOCATED, set);
+      avr_tag_range(mem, n, set, 1);
       n += set;
     }
     break;
@@ -1313,14 +1448,14 @@ static int fileio_imm(struct fioparms *fio, const char *fname, FILE *f_unused,
   return n;
 }
 
-static int fileio_ihex(struct fioparms *fio, const char *filename, FILE *f,
-  const AVRPART *p, const AVRMEM *mem, const Segment *segp, FILEFMT ffmt, Segorder where) {
+static int fileio_ihex(struct fioparms *fio, const char *filename, FILE *f, const AVRPART *p,
+  const AVRMEM *mem, const Segment *segp, const unsigned char *data, FILEFMT ffmt, Segorder where) {
 
   int rc;
 
   switch(fio->op) {
   case FIO_WRITE:
-    rc = b2ihex(p, mem, segp, where, 32, fio->fileoffset, filename, f, ffmt);
+    rc = b2ihex(p, mem, segp, data, where, 32, fio->fileoffset, filename, f, ffmt);
     break;
 
   case FIO_READ:
@@ -1335,14 +1470,14 @@ static int fileio_ihex(struct fioparms *fio, const char *filename, FILE *f,
   return rc < 0? -1: rc;
 }
 
-static int fileio_srec(struct fioparms *fio, const char *filename, FILE *f,
-  const AVRPART *p, const AVRMEM *mem, const Segment *segp, Segorder where) {
+static int fileio_srec(struct fioparms *fio, const char *filename, FILE *f, const AVRPART *p,
+  const AVRMEM *mem, const Segment *segp, const unsigned char *data, Segorder where) {
 
   int rc;
 
   switch(fio->op) {
   case FIO_WRITE:
-    rc = b2srec(mem, segp, where, 32, fio->fileoffset, filename, f);
+    rc = b2srec(mem, segp, data, where, 32, fio->fileoffset, filename, f);
     break;
 
   case FIO_READ:
@@ -1370,7 +1505,7 @@ static int fileio_elf(struct fioparms *fio, const char *filename, FILE *f,
     break;
 
   case FIO_READ:
-    rc = elf2b(filename, f, mem, p, segp, fio->fileoffset);
+    rc = elf2b(filename, f, mem, p, segp, fio->fileoffset, NULL);
     return rc;
 
   default:
@@ -1381,7 +1516,7 @@ static int fileio_elf(struct fioparms *fio, const char *filename, FILE *f,
 }
 #endif
 
-static int b2num(const char *filename, FILE *f, const AVRMEM *mem, const Segment *segp, FILEFMT fmt) {
+static int b2num(const char *filename, FILE *f, const Segment *segp, const unsigned char *data, FILEFMT fmt) {
   const char *prefix;
   int base;
 
@@ -1420,7 +1555,7 @@ static int b2num(const char *filename, FILE *f, const AVRMEM *mem, const Segment
       if(putc(',', f) == EOF)
         goto writeerr;
 
-    unsigned num = mem->buf[i];
+    unsigned num = data[i - segp->addr];
 
     /*
      * For a base of 8 and a value < 8 to convert, don't write the prefix.  The
@@ -1467,7 +1602,7 @@ static int num2b(const char *filename, FILE *f, const AVRMEM *mem, const Segment
           mmt_free(line);
           return -1;
         }
-        memset(mem->tags + n, TAG_ALLOCATED, set);
+        avr_tag_range(mem, n, set, 1);
         n += set;
       }
     }
@@ -1482,11 +1617,11 @@ static int num2b(const char *filename, FILE *f, const AVRMEM *mem, const Segment
 }
 
 static int fileio_num(struct fioparms *fio, const char *filename, FILE *f,
-  const AVRMEM *mem, const Segment *segp, FILEFMT fmt) {
+  const AVRMEM *mem, const Segment *segp, const unsigned char *data, FILEFMT fmt) {
 
   switch(fio->op) {
   case FIO_WRITE:
-    return b2num(filename, f, mem, segp, fmt);
+    return b2num(filename, f, segp, data, fmt);
 
   case FIO_READ:
     return num2b(filename, f, mem, segp);
@@ -1691,31 +1826,19 @@ int segment_normalise(const AVRMEM *mem, Segment *segp) {
   return 0;
 }
 
-static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT format,
-  const AVRPART *p, const AVRMEM *mem, int n, Segment *seglist) {
+// Open file for I/O and resolve FMT_AUTO; return whether stdin/stdout is used or -1 on error
+static int fileio_open(struct fioparms *fio, const char *filename, FILEFMT *formatp,
+  const char **fnamep, FILE **fp) {
 
-  int op, rc;
-  FILE *f;
-  const char *fname;
-  struct fioparms fio;
-  int using_stdio;
-
-  op = oprwv == FIO_READ_FOR_VERIFY? FIO_READ: oprwv;
-  rc = fileio_setparms(op, &fio, p, mem);
-  if(rc < 0)
-    return -1;
-
-  for(int i = 0; i < n; i++)
-    if(segment_normalise(mem, seglist + i) < 0)
-      return -1;
+  int using_stdio = 0;
+  const char *fname = filename;
+  FILE *f = NULL;
+  FILEFMT format = *formatp;
 
-  using_stdio = 0;
-  fname = filename;
-  f = NULL;
   if(str_eq(filename, "-")) {
     using_stdio = 1;
-    fname = fio.op == FIO_READ? "<stdin>": "<stdout>";
-    f = fio.op == FIO_READ? stdin: stdout;
+    fname = fio->op == FIO_READ? "<stdin>": "<stdout>";
+    f = fio->op == FIO_READ? stdin: stdout;
   }
 
   if(format == FMT_AUTO) {
@@ -1735,31 +1858,99 @@ static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT fo
     format = format_detect;
 
     if(quell_progress < 2)
-      pmsg_notice("%s file %s auto detected as %s\n", fio.iodesc, fname, fileio_fmtstr(format));
+      pmsg_notice("%s file %s auto detected as %s\n", fio->iodesc, fname, fileio_fmtstr(format));
   }
 
 #if defined(WIN32)
   // Open Raw Binary and ELF format in binary mode on Windows
   if(format == FMT_RBIN || format == FMT_ELF) {
-    if(fio.op == FIO_READ) {
-      fio.mode = "rb";
+    if(fio->op == FIO_READ) {
+      fio->mode = "rb";
     }
-    if(fio.op == FIO_WRITE) {
-      fio.mode = "wb";
+    if(fio->op == FIO_WRITE) {
+      fio->mode = "wb";
     }
   }
 #endif
 
   if(format != FMT_IMM) {
     if(!using_stdio) {
-      f = fopen(fname, fio.mode);
+      f = fopen(fname, fio->mode);
       if(f == NULL) {
-        pmsg_ext_error("cannot open %s file %s: %s\n", fio.iodesc, fname, strerror(errno));
+        pmsg_ext_error("cannot open %s file %s: %s\n", fio->iodesc, fname, strerror(errno));
         return -1;
       }
     }
   }
 
+  *formatp = format;
+  *fnamep = fname;
+  *fp = f;
+
+  return using_stdio;
+}
+
+// Read or write one segment; data are the segment's contents when writing
+static int fileio_segment(struct fioparms *fio, const char *fname, FILE *f, FILEFMT format,
+  const AVRPART *p, const AVRMEM *mem, const Segment *segp, const unsigned char *data, Segorder where) {
+
+  switch(format) {
+  case FMT_IHEX:
+  case FMT_IHXC:
+    return fileio_ihex(fio, fname, f, p, mem, segp, data, format, where);
+
+  case FMT_SREC:
+    return fileio_srec(fio, fname, f, p, mem, segp, data, where);
+
+  case FMT_RBIN:
+    return fileio_rbin(fio, fname, f, mem, segp, data);
+
+  case FMT_ELF:
+
+#ifdef HAVE_LIBELF
+    return fileio_elf(fio, fname, f, mem, p, segp);
+#else
+    pmsg_error("cannot handle ELF file %s, ELF file support was not compiled in\n", fname);
+    return -1;
+#endif
+
+  case FMT_IMM:
+    return fileio_imm(fio, fname, f, mem, segp);
+
+  case FMT_HEX:
+  case FMT_DEC:
+  case FMT_OCT:
+  case FMT_BIN:
+  case FMT_EEGG:
+    return fileio_num(fio, fname, f, mem, segp, data, format);
+
+  default:
+    pmsg_error("invalid %s file format: %d\n", fio->iodesc, format);
+    return -1;
+  }
+}
+
+static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT format,
+  const AVRPART *p, const AVRMEM *mem, int n, Segment *seglist) {
+
+  int op, rc;
+  FILE *f;
+  const char *fname;
+  struct fioparms fio;
+  int using_stdio;
+
+  op = oprwv == FIO_READ_FOR_VERIFY? FIO_READ: oprwv;
+  rc = fileio_setparms(op, &fio, p, mem);
+  if(rc < 0)
+    return -1;
+
+  for(int i = 0; i < n; i++)
+    if(segment_normalise(mem, seglist + i) < 0)
+      return -1;
+
+  if((using_stdio = fileio_open(&fio, filename, &format, &fname, &f)) < 0)
+    return -1;
+
   rc = 0;
   for(int i = 0; i < n; i++) {
     int addr = seglist[i].addr, len = seglist[i].len;
@@ -1769,55 +1960,15 @@ static int fileio_segments_normalise(int oprwv, const char *filename, FILEFMT fo
 
     if(fio.op == FIO_READ)      // Fill unspecified memory in segment
       memset(mem->buf + addr, 0xff, len);
-    memset(mem->tags + addr, 0, len);
+    avr_tag_range(mem, addr, len, 0);
 
     Segorder where = i == 0? FIRST_SEG: 0;
 
     if(i + 1 == n)
       where |= LAST_SEG;
 
-    int thisrc = 0;
-
-    switch(format) {
-    case FMT_IHEX:
-    case FMT_IHXC:
-      thisrc = fileio_ihex(&fio, fname, f, p, mem, seglist + i, format, where);
-      break;
-
-    case FMT_SREC:
-      thisrc = fileio_srec(&fio, fname, f, p, mem, seglist + i, where);
-      break;
-
-    case FMT_RBIN:
-      thisrc = fileio_rbin(&fio, fname, f, mem, seglist + i);
-      break;
-
-    case FMT_ELF:
-
-#ifdef HAVE_LIBELF
-      thisrc = fileio_elf(&fio, fname, f, mem, p, seglist + i);
-      break;
-#else
-      pmsg_error("cannot handle ELF file %s, ELF file support was not compiled in\n", fname);
-      return -1;
-#endif
-
-    case FMT_IMM:
-      thisrc = fileio_imm(&fio, fname, f, mem, seglist + i);
-      break;
+    int thisrc = fileio_segment(&fio, fname, f, format, p, mem, seglist + i, mem->buf + addr, where);
 
-    case FMT_HEX:
-    case FMT_DEC:
-    case FMT_OCT:
-    case FMT_BIN:
-    case FMT_EEGG:
-      thisrc = fileio_num(&fio, fname, f, mem, seglist + i, format);
-      break;
-
-    default:
-      pmsg_error("invalid %s file format: %d\n", fio.iodesc, format);
-      return -1;
-    }
     if(thisrc < 0)
       return thisrc;
     if(thisrc > rc)
@@ -1851,3 +2002,88 @@ int fileio_segments(int oprwv, const char *filename, FILEFMT format,
 
   return ret;
 }
+
+// Read file via a flat memory for formats that cannot express multi-memory layouts
+static int flat2img(struct fioparms *fio, const char *fname, FILE *f, FILEFMT format,
+  const AVRPART *p, Memimage *img) {
+
+  AVRMEM *flat = fileio_any_memory("any");
+  const Segment seg = { 0, flat->size };
+  int rc = fileio_segment(fio, fname, f, format, p, flat, &seg, NULL, FIRST_SEG | LAST_SEG);
+
+  for(int i = 0, n; rc > 0 && (i = avr_tag_find(flat, i, flat->size, 1)) < flat->size; i += n) {
+    n = avr_tag_find(flat, i, flat->size, 0) - i;
+    fileio_image_put(img, i, flat->buf + i, n);
+  }
+  avr_free_mem(flat);
+
+  return rc;
+}
+
+/*
+ * Read a multi-memory file into the sparse image img or write the extents of
+ * img to a file, one segment each in the order they were added.
+ *
+ * Return the highest address read or written plus one. On error, return -1.
+ */
+int fileio_image(int oprwv, const char *filename, FILEFMT format, const AVRPART *p, Memimage *img) {
+  int rc, using_stdio;
+  FILE *f;
+  const char *fname;
+  struct fioparms fio;
+  AVRMEM *any = avr_new_mem();  // Descriptor of the flat address space without contents
+
+  any->desc = cache_string("any");
+  any->size = ANY_MEM_SIZE;
+
+  if(fileio_setparms(oprwv == FIO_READ_FOR_VERIFY? FIO_READ: oprwv, &fio, p, any) < 0 ||
+    (using_stdio = fileio_open(&fio, filename, &format, &fname, &f)) < 0) {
+
+    avr_free_mem(any);
+    return -1;
+  }
+
+  rc = 0;
+  if(fio.op == FIO_WRITE) {
+    for(int i = 0; i < img->n; i++) {
+      const Segment seg = { img->ext[i].addr, img->ext[i].len };
+      Segorder where = (i == 0? FIRST_SEG: 0) | (i + 1 == img->n? LAST_SEG: 0);
+      int thisrc = fileio_segment(&fio, fname, f, format, p, any, &seg, img->ext[i].buf, where);
+
+      if(thisrc < 0) {
+        rc = thisrc;
+        break;
+      }
+      if(thisrc > rc)
+        rc = thisrc;
+    }
+  } else {
+    switch(format) {
+    case FMT_IHEX:
+    case FMT_IHXC:
+      if(!(rc = ihex2img(fname, f, p, img, fio.fileoffset, format)))
+        pmsg_warning("no %s data found in Intel Hex file %s\n", any->desc, fname);
+      break;
+
+    case FMT_SREC:
+      if(!(rc = srec2img(fname, f, p, img, fio.fileoffset)))
+        pmsg_warning("no %s data found in Motorola S-Record file %s\n", any->desc, fname);
+      break;
+
+#ifdef HAVE_LIBELF
+    case FMT_ELF:
+      rc = elf2b(fname, f, any, p, NULL, fio.fileoffset, img);
+      break;
+#endif
+
+    default:
+      rc = flat2img(&fio, fname, f, format, p, img);
+    }
+  }
+
+  if(format != FMT_IMM && !using_stdio)
+    fclose(f);
+  avr_free_mem(any);
+
+  return rc < 0? -1: rc;
+}
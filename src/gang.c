@@ -0,0 +1,423 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Gang programming for avrdude -G <target>[,<target>...]
+ *
+ * Carries out the -U and -T operations of the command line on several
+ * targets at the same time, one thread per target. A target is a port for
+ * the -c programmer or programmer-id@port for a different one. All threads
+ * share the parsed configuration, the part and the input files, which are
+ * read once before the threads start, see update_preload(). Each thread has
+ * its own libavrdude context, programmer and copy of the part.
+ *
+ * Whilst the targets are being programmed a single line shows the progress
+ * of all of them. The messages of each target are collected in a log of its
+ * own and shown, target by target, once all have finished. A summary of
+ * exit codes and times concludes the output. The exit code is 0 if all
+ * targets succeeded and 1 otherwise.
+ */
+
+#include <ac_cfg.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include "avrdude.h"
+#include "libavrdude.h"
+
+#ifdef HAVE_PTHREAD
+
+typedef struct {                // Job and settings shared read-only by all targets
+  const AVRPART *part;          // Part as read from the config file(s)
+  LISTID updates, xparams;      // UPDATE * of -U and -T; -x strings
+  enum updateflags uflags;
+  int erase, explicit_e, baudrate, ispdelay;
+  double bitclock;
+  const char *exitspecs;
+  int verbose, quell_progress, disableffopt, diffprog, lowlat;
+} Gang;
+
+typedef struct {
+  const Gang *gang;
+  char *pgmid, *port;           // Programmer id and port of the target
+  const PROGRAMMER *cfgpgm;     // Programmer as read from the config file(s)
+  int is_dryrun;
+  FILE *log;                    // Messages of the target's thread
+  pthread_t tid;
+  // Shared with the main thread under gang_lock
+  char op;                      // Initial of the current operation, eg, W for Writing
+  int percent;                  // Its progress
+  int done, rc;                 // Whether the target has finished and its exit code
+  double secs;                  // Time the target took
+  Cfg_allocstats allocs;        // Allocation statistics of the thread's context
+} Target;
+
+static pthread_mutex_t gang_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gang_cond = PTHREAD_COND_INITIALIZER;
+static LIBAVRDUDE_TLS Target *this_target;
+
+// Record progress of the thread's target for the display in avrdude_gang()
+static void gang_progress(int percent, double etime, const char *hdr, int finish) {
+  pthread_mutex_lock(&gang_lock);
+  if(hdr) {
+    hdr = str_ltrim(hdr);
+    this_target->op = *hdr? *hdr: '?';
+  }
+  if(this_target->op != '-')    // Reporting starts with the first header
+    this_target->percent = percent > 100? 100: percent < 0? 0: percent;
+  pthread_mutex_unlock(&gang_lock);
+}
+
+// Program one target in a thread of its own
+static void *gang_target(void *arg) {
+  Target *t = arg;
+  const Gang *g = t->gang;
+  PROGRAMMER *pgm;
+  AVRPART *p = NULL;
+  AVR_Cache caches[4];
+  int rc = 1;
+
+  init_cx(NULL);
+  cx->avr_disableffopt = g->disableffopt;
+  cx->avr_diffprog = g->diffprog;
+  cx->ser_lowlat = g->lowlat;
+  verbose = g->verbose;
+  quell_progress = g->quell_progress;
+  msg_log = t->log;
+  this_target = t;
+  if(!quell_progress)
+    update_progress = gang_progress;
+
+  uint64_t t0 = avr_ustimestamp();
+
+  pgm = pgm_dup(t->cfgpgm);
+  memset(caches, 0, sizeof caches);     // pgm_dup() shares the caches, but each target needs its own
+  pgm->cp_flash = caches + 0;
+  pgm->cp_eeprom = caches + 1;
+  pgm->cp_bootrow = caches + 2;
+  pgm->cp_usersig = caches + 3;
+  pgm->initpgm(pgm);
+  if(pgm->setup)
+    pgm->setup(pgm);
+  if(lsize(g->xparams) && (!pgm->parseextparams || pgm->parseextparams(pgm, g->xparams) < 0)) {
+    pmsg_error("unable to parse list of -x parameters\n");
+    goto teardown;
+  }
+  if(g->exitspecs && (!pgm->parseexitspecs || pgm->parseexitspecs(pgm, g->exitspecs) < 0)) {
+    pmsg_error("unable to parse list of -E parameters\n");
+    goto teardown;
+  }
+  if(g->baudrate)
+    pgm->baudrate = g->baudrate;
+  else if(!pgm->baudrate && default_baudrate)
+    pgm->baudrate = default_baudrate;
+  if(g->bitclock > 0 || default_bitclock > 0)
+    pgm->bitclock = (g->bitclock > 0? g->bitclock: default_bitclock)*1e-6;
+  if(g->ispdelay)
+    pgm->ispdelay = g->ispdelay;
+
+  pmsg_notice("using programmer %s on port %s\n", t->pgmid, t->port);
+  if(pgm->open(pgm, t->port) < 0) {
+    pmsg_error("unable to open port %s for programmer %s\n", t->port, t->pgmid);
+    goto teardown;
+  }
+
+  p = avr_dup_part(g->part);
+  if(avr_initmem(p) != 0)
+    pmsg_error("unable to initialize memories\n");
+  else {
+    rc = process_updates(pgm, p, g->updates, g->uflags, g->erase, g->explicit_e, g->baudrate, t->is_dryrun);
+    led_set(pgm, LED_END);
+    pgm->powerdown(pgm);
+    pgm->disable(pgm);
+    pgm->reset_cache(pgm, p);
+  }
+  pgm->close(pgm);
+
+teardown:
+  if(pgm->teardown)
+    pgm->teardown(pgm);
+  pgm_free(pgm);
+  if(p)
+    avr_free_part(p);
+  fflush(t->log);
+
+  double secs = (avr_ustimestamp() - t0)/1e6;
+  Cfg_allocstats allocs = cx->cfg_allocs;
+
+  free_cx();
+  msg_log = NULL;
+
+  pthread_mutex_lock(&gang_lock);
+  t->rc = rc;
+  t->secs = secs;
+  t->allocs = allocs;
+  t->done = 1;
+  pthread_cond_signal(&gang_cond);
+  pthread_mutex_unlock(&gang_lock);
+
+  return NULL;
+}
+
+// Show the progress of all targets in one line; called under gang_lock
+static void gang_display(const Target *ts, int n, int ndone, double secs, int tty) {
+  msg_info("%sGang |", tty? "\r": "");
+  for(int i = 0; i < n; i++)
+    if(ts[i].done)
+      msg_info(" %s |", ts[i].rc? " FAIL ": "  ok  ");
+    else
+      msg_info(" %c %3d%% |", ts[i].op, ts[i].percent);
+  msg_info(" %d/%d done %.2f s%s", ndone, n, secs, tty? " ": "\n");
+}
+
+// Add the targets of the comma-separated list s to ts; return -1 on error
+static int gang_parse(Target **tsp, int *np, const char *s, const AVRPART *part) {
+  char *list = mmt_strdup(s), *next;
+  PROGRAMMER *dry = locate_programmer(programmers, "dryrun");
+  int ret = 0;
+
+  for(char *tgt = list; tgt && ret == 0; tgt = next) {
+    if((next = strchr(tgt, ',')))
+      *next++ = 0;
+
+    char *at = strchr(tgt, '@');
+    const char *id = at? tgt: pgmid;
+    const char *port = at? at + 1: tgt;
+
+    if(at)
+      *at = 0;
+    if(!id || !*id) {
+      pmsg_error("no programmer for -G target %s; use -c or programmer@port\n", port);
+      ret = -1;
+      break;
+    }
+
+    PROGRAMMER *cfgpgm = locate_programmer_starts_set(programmers, id, &id, (AVRPART *) part);
+
+    if(!cfgpgm || !is_programmer(cfgpgm) || !cfgpgm->initpgm) {
+      pmsg_error("cannot find programmer id %s\n", id);
+      ret = -1;
+      break;
+    }
+    if(!(part->prog_modes & cfgpgm->prog_modes) && !ovsigck) {
+      pmsg_error("-c %s cannot program %s for lack of a common programming mode\n", id, part->desc);
+      ret = -1;
+      break;
+    }
+
+    int is_dryrun = str_eq(cfgpgm->type, "dryrun") || (dry && cfgpgm->initpgm == dry->initpgm);
+    char *tport = *port? mmt_strdup(port): default_port(cfgpgm);
+
+    for(int i = 0; i < *np && !is_dryrun; i++)
+      if(str_eq((*tsp)[i].port, tport)) {
+        pmsg_error("port %s is given more than once with -G\n", tport);
+        ret = -1;
+      }
+    if(ret == 0 && (!*tport || str_eq(tport, "unknown")) && !is_dryrun) {
+      pmsg_error("no port has been specified for -G target %s\n", id);
+      ret = -1;
+    }
+    if(ret < 0) {
+      mmt_free(tport);
+      break;
+    }
+
+    *tsp = mmt_realloc(*tsp, (*np + 1)*sizeof **tsp);
+    Target *t = *tsp + (*np)++;
+
+    memset(t, 0, sizeof *t);
+    t->pgmid = mmt_strdup(id);
+    t->port = tport;
+    t->cfgpgm = cfgpgm;
+    t->is_dryrun = is_dryrun;
+    t->op = '-';
+  }
+  mmt_free(list);
+
+  return ret;
+}
+
+// Carry out the -U/-T updates on all targets at once; return 0 if all succeeded, 1 otherwise
+int avrdude_gang(LISTID targets, LISTID updates, enum updateflags uflags, int erase, int explicit_e,
+  int baudrate, double bitclock, int ispdelay, const char *exitspecs, LISTID xparams) {
+
+  const AVRPART *cfgp = partdesc? locate_part(part_list, partdesc): NULL;
+  AVRPART *p;
+  Target *ts = NULL;
+  int n = 0, nfail = 0, nstarted = 0, rc = 1;
+
+  if(!cfgp) {
+    pmsg_error("AVR part %s not found\n", partdesc? partdesc: "(no -p)");
+    return 1;
+  }
+  for(LNODEID ln = lfirst(updates); ln; ln = lnext(ln)) {
+    UPDATE *upd = ldata(ln);
+
+    if(upd->cmdline && str_eq(upd->cmdline, "interactive terminal")) {
+      pmsg_error("-t interactive terminal cannot be used with -G\n");
+      return 1;
+    }
+    if(!upd->cmdline && upd->op == DEVICE_READ) {
+      pmsg_error("-U %s:r:%s cannot be used with -G as all targets would write to it\n",
+        upd->memstr? upd->memstr: "flash", upd->filename);
+      return 1;
+    }
+  }
+
+  // Check the updates and read their input files once for all targets
+  p = avr_dup_part(cfgp);
+  if(avr_initmem(p) != 0) {
+    pmsg_error("unable to initialize memories\n");
+    goto done;
+  }
+  int doexit = 0;
+
+  for(LNODEID ln = lfirst(updates); ln; ln = lnext(ln)) {
+    UPDATE *upd = ldata(ln);
+
+    if(upd->memstr == NULL && upd->cmdline == NULL)
+      upd->memstr = mmt_strdup(is_pdi(p)? "application": "flash");
+    int urc = update_dryrun(p, upd);
+
+    if(urc && urc != LIBAVRDUDE_SOFTFAIL)
+      doexit = 1;
+  }
+  for(LNODEID ln = lfirst(updates); ln && !doexit; ln = lnext(ln))
+    if(update_preload(p, ldata(ln)) < 0)
+      doexit = 1;
+  if(doexit)
+    goto done;
+
+  for(LNODEID ln = lfirst(targets); ln; ln = lnext(ln))
+    if(gang_parse(&ts, &n, ldata(ln), cfgp) < 0)
+      goto done;
+
+  Gang g = {
+    .part = cfgp, .updates = updates, .xparams = xparams, .uflags = uflags,
+    .erase = erase, .explicit_e = explicit_e, .baudrate = baudrate, .ispdelay = ispdelay,
+    .bitclock = bitclock, .exitspecs = exitspecs, .verbose = verbose, .quell_progress = quell_progress,
+    .disableffopt = cx->avr_disableffopt, .diffprog = cx->avr_diffprog, .lowlat = cx->ser_lowlat,
+  };
+  uint64_t t0 = avr_ustimestamp();
+
+  for(int i = 0; i < n; i++) {
+    ts[i].gang = &g;
+    if(!(ts[i].log = tmpfile())) {
+      pmsg_ext_error("cannot create log for target %s on %s\n", ts[i].pgmid, ts[i].port);
+      break;
+    }
+    if(pthread_create(&ts[i].tid, NULL, gang_target, ts + i)) {
+      pmsg_error("cannot create thread for target %s on %s\n", ts[i].pgmid, ts[i].port);
+      break;
+    }
+    nstarted++;
+  }
+  for(int i = nstarted; i < n; i++)     // Not started: count as failed
+    ts[i].done = ts[i].rc = 1;
+
+  // Show progress until all targets are done
+  int tty = isatty(STDERR_FILENO), shown = -1;
+
+  pthread_mutex_lock(&gang_lock);
+  for(;;) {
+    int ndone = 0;
+
+    for(int i = 0; i < n; i++)
+      ndone += ts[i].done;
+    if(!quell_progress && (tty || ndone != shown)) {
+      gang_display(ts, n, ndone, (avr_ustimestamp() - t0)/1e6, tty);
+      shown = ndone;
+    }
+    if(ndone == n)
+      break;
+
+    struct timespec ts_wait;
+
+    clock_gettime(CLOCK_REALTIME, &ts_wait);
+    ts_wait.tv_nsec += 100*1000*1000;   // Update display every 100 ms
+    if(ts_wait.tv_nsec >= 1000*1000*1000) {
+      ts_wait.tv_sec++;
+      ts_wait.tv_nsec -= 1000*1000*1000;
+    }
+    pthread_cond_timedwait(&gang_cond, &gang_lock, &ts_wait);
+  }
+  pthread_mutex_unlock(&gang_lock);
+  if(!quell_progress && tty)
+    lmsg_info("");
+
+  double secs = (avr_ustimestamp() - t0)/1e6;
+
+  for(int i = 0; i < nstarted; i++) {
+    pthread_join(ts[i].tid, NULL);
+    cfg_alloc_add(&ts[i].allocs); // For AVRDUDE_MEMSTATS
+  }
+
+  // Show the log of each target followed by a summary
+  for(int i = 0; i < n; i++) {
+    if(ts[i].log) {
+      char buf[4096];
+      size_t len;
+
+      if(ftell(ts[i].log) > 0) {
+        lmsg_info("");
+        pmsg_info("log of target %d, %s on %s\n", i + 1, ts[i].pgmid, ts[i].port);
+        fflush(stderr);
+        rewind(ts[i].log);
+        while((len = fread(buf, 1, sizeof buf, ts[i].log)) > 0)
+          fwrite(buf, 1, len, stderr);
+      }
+      fclose(ts[i].log);
+    }
+    nfail += ts[i].rc != 0;
+  }
+
+  lmsg_info("");
+  pmsg_info("%d target%s programmed in %.2f s, %d failed\n", n, str_plural(n), secs, nfail);
+  for(int i = 0; i < n; i++)
+    msg_info("%*d  %-20s  %-20s  %-6s  %.2f s\n", (int) strlen(progname) + 2, i + 1, ts[i].pgmid,
+      ts[i].port, ts[i].rc? "failed": "ok", ts[i].secs);
+  rc = nfail > 0;
+
+done:
+  for(int i = 0; i < n; i++) {
+    mmt_free(ts[i].pgmid);
+    mmt_free(ts[i].port);
+  }
+  mmt_free(ts);
+  avr_free_part(p);
+
+  return rc;
+}
+
+#else
+
+int avrdude_gang(LISTID targets, LISTID updates, enum updateflags uflags, int erase, int explicit_e,
+  int baudrate, double bitclock, int ispdelay, const char *exitspecs, LISTID xparams) {
+
+  pmsg_error("gang programming -G needs POSIX threads, which this build lacks\n");
+  return 1;
+}
+#endif
@@ -3236,6 +3236,7 @@ void jtag3_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = jtag3_paged_write;
   pgm->paged_load = jtag3_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = jtag3_page_erase;
   pgm->print_parms = jtag3_print_parms;
   pgm->set_sck_period = jtag3_set_sck_period;
@@ -3274,6 +3275,7 @@ void jtag3_dw_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = jtag3_paged_write;
   pgm->paged_load = jtag3_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = NULL;
   pgm->print_parms = jtag3_print_parms;
   pgm->parseextparams = jtag3_parseextparms;
@@ -3309,6 +3311,7 @@ void jtag3_pdi_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = jtag3_paged_write;
   pgm->paged_load = jtag3_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = jtag3_page_erase;
   pgm->print_parms = jtag3_print_parms;
   pgm->set_sck_period = jtag3_set_sck_period;
@@ -3347,6 +3350,7 @@ void jtag3_updi_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = jtag3_paged_write;
   pgm->paged_load = jtag3_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = jtag3_page_erase;
   pgm->print_parms = jtag3_print_parms;
   pgm->set_sck_period = jtag3_set_sck_period;
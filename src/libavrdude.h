@@ -29,6 +29,21 @@
 #include <termios.h>
 #endif
 
+/*
+ * Storage class of the context pointer cx and of the few remaining globals
+ * that change during a session: each thread has its own, so that threads can
+ * drive independent programmer/part pairs at the same time
+ */
+#if defined(_MSC_VER)
+#define LIBAVRDUDE_TLS __declspec(thread)
+#elif defined(__cplusplus) && __cplusplus >= 201103L
+#define LIBAVRDUDE_TLS thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define LIBAVRDUDE_TLS _Thread_local
+#else
+#define LIBAVRDUDE_TLS __thread
+#endif
+
 #ifdef LIBAVRDUDE_INCLUDE_INTERNAL_HEADERS
 #error LIBAVRDUDE_INCLUDE_INTERNAL_HEADERS is defined. Do not do that.
 #endif
@@ -298,7 +313,11 @@ typedef struct opcode {
 #define FLASH_INSTR_SIZE      3
 #define EEPROM_INSTR_SIZE    20
 
-#define TAG_ALLOCATED         1 // Memory byte is allocated
+// Allocation tags of AVRMEM: bit a%64 of tags[a/64] is set if byte a is allocated
+#define TAG_WORDS(size)       (((size) + 63)/64)  // Number of uint64_t tag words for size bytes
+#define avr_tag_get(mem, a)   ((int) (((mem)->tags[(unsigned) (a)/64] >> ((unsigned) (a)%64)) & 1))
+#define avr_tag_set(mem, a)   ((mem)->tags[(unsigned) (a)/64] |= (uint64_t) 1 << ((unsigned) (a)%64))
+#define avr_tag_clr(mem, a)   ((mem)->tags[(unsigned) (a)/64] &= ~((uint64_t) 1 << ((unsigned) (a)%64)))
 
 /*
  * Any changes in AVRPART or AVRMEM, please also ensure changes are made in
@@ -393,6 +412,7 @@ typedef struct avrpart {
   LISTID mem_alias;             // Memory alias definitions
   const char *config_file;      // Config file where defined
   int lineno;                   // Config file line number
+  struct avrmem_index *mem_index; // Memory lookup tables, see index_avrparts()
 } AVRPART;
 
 typedef unsigned int Memtype;
@@ -568,7 +588,7 @@ typedef struct avrmem {
   int pollindex;                // Stk500 v2 xml file parameter
 
   unsigned char *buf;           // Pointer to memory buffer
-  unsigned char *tags;          // Allocation tags
+  uint64_t *tags;               // Allocation tags, one bit per byte, see avr_tag_get()
   OPCODE *op[AVR_OP_MAX];       // Opcodes
 } AVRMEM;
 
@@ -608,6 +628,11 @@ extern "C" {
   AVRMEM *avr_dup_mem(const AVRMEM *m);
   void avr_free_mem(AVRMEM *m);
   void avr_free_memalias(AVRMEM_ALIAS *m);
+  void avr_tag_range(const AVRMEM *mem, int addr, int len, int set);
+  int avr_tag_any(const AVRMEM *mem, int addr, int len);
+  int avr_tag_all(const AVRMEM *mem, int addr, int len);
+  int avr_tag_count(const AVRMEM *mem, int addr, int len);
+  int avr_tag_find(const AVRMEM *mem, int addr, int end, int set);
   AVRMEM *avr_locate_mem(const AVRPART *p, const char *desc);
   AVRMEM *avr_locate_mem_noalias(const AVRPART *p, const char *desc);
   AVRMEM *avr_locate_fuse_by_offset(const AVRPART *p, unsigned int off);
@@ -635,6 +660,7 @@ extern "C" {
     const char *cfgname, int cfglineno, void *cookie);
   void walk_avrparts(LISTID avrparts, walk_avrparts_cb cb, void *cookie);
   void sort_avrparts(LISTID avrparts);
+  void index_avrparts(LISTID avrparts);
 
   // cmp can be, eg, str_caseeq or str_casematch
   int part_eq(AVRPART *p, const char *string, int (*cmp)(const char *, const char *));
@@ -817,8 +843,8 @@ const char *pinmask_to_str(const Pinmask *const pinmask);
  * The target file will be selected at configure time.
  */
 
-extern long serial_recv_timeout;        // ms
-extern long serial_drain_timeout;       // ms
+extern LIBAVRDUDE_TLS long serial_recv_timeout;        // ms
+extern LIBAVRDUDE_TLS long serial_drain_timeout;       // ms
 
 union filedescriptor {
   int ifd;
@@ -889,7 +915,7 @@ struct serial_device {
 #define SERDEV_FL_CANSETSPEED 1 // Device can change speed
 };
 
-extern struct serial_device *serdev;
+extern LIBAVRDUDE_TLS struct serial_device *serdev;
 extern struct serial_device serial_serdev;
 extern struct serial_device usb_serdev;
 extern struct serial_device usb_serdev_frame;
@@ -911,6 +937,7 @@ typedef struct {                // Memory cache for a subset of cached pages
   unsigned int offset;          // Offset of flash/eeprom memory
   unsigned char *cont, *copy;   // Current memory contens and device copy of it
   unsigned char *iscached;      // iscached[i] set when page i has been loaded
+  unsigned char *isdirty;       // Bit i set when page i of cont may differ from copy
 } AVR_Cache;
 
 // Formerly pgm.h
@@ -1003,6 +1030,7 @@ typedef struct programmer {
   int ppictrl;
   int ispdelay;                 // ISP clock delay
   int page_size;                // Page size if the programmer supports paged write/load
+  int paged_burst;              // Max n_bytes of one paged_write/load call spanning pages, 0 if one page only
   double bitclock;              // JTAG ICE clock period in microseconds
   Leds *leds;                   // State of LEDs as tracked by led_...()  functions in leds.c
 
@@ -1038,6 +1066,9 @@ typedef struct programmer {
   int (*read_sig_bytes)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m);
   int (*read_sib)(const PROGRAMMER *pgm, const AVRPART *p, char *sib);
   int (*read_chip_rev)(const PROGRAMMER *pgm, const AVRPART *p, unsigned char *chip_rev);
+  // Device-side avr_crc32() for verification; so far only dryrun -x checksum provides it
+  int (*checksum)(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+    unsigned int addr, unsigned int len, uint32_t *crc);
   int (*term_keep_alive)(const PROGRAMMER *pgm, const AVRPART *p);
   int (*end_programming)(const PROGRAMMER *pgm, const AVRPART *p);
 
@@ -1118,6 +1149,7 @@ extern "C" {
   void walk_programmers(LISTID programmers, walk_programmers_cb cb, void *cookie);
 
   void sort_programmers(LISTID programmers);
+  void index_programmers(LISTID programmers);
 
 #ifdef __cplusplus
 }
@@ -1130,7 +1162,7 @@ typedef void (*FP_UpdateProgress)(int percent, double etime, const char *hdr, in
 extern struct avrpart parts[];
 extern Memtable avr_mem_order[100];
 
-extern FP_UpdateProgress update_progress;
+extern LIBAVRDUDE_TLS FP_UpdateProgress update_progress;
 
 #ifdef __cplusplus
 extern "C" {
@@ -1151,6 +1183,7 @@ extern "C" {
   uint64_t avr_mstimestamp(void);
   double avr_timestamp(void);
   void init_cx(PROGRAMMER *pgm);
+  void free_cx(void);
   int avr_write_byte(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
     unsigned long addr, unsigned char data);
   int avr_read_byte_silent(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
@@ -1165,6 +1198,7 @@ extern "C" {
   int avr_mem_bitmask(const AVRPART *p, const AVRMEM *mem, int addr);
   int avr_verify(const PROGRAMMER *pgm, const AVRPART *p, const AVRPART *v, const char *m, int size);
   int avr_verify_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRPART *v, const AVRMEM *a, int size);
+  int avr_read_verify_mem(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, int size);
   int avr_get_cycle_count(const PROGRAMMER *pgm, const AVRPART *p, int *cycles);
   int avr_put_cycle_count(const PROGRAMMER *pgm, const AVRPART *p, int cycles);
 
@@ -1185,17 +1219,23 @@ extern "C" {
   void report_progress(int completed, int total, const char *hdr);
   void trace_buffer(const char *funstr, const unsigned char *buf, size_t buflen);
   int avr_has_paged_access(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m);
+  int avr_burst_pages(const PROGRAMMER *pgm, const AVRMEM *m);
   int avr_read_page_default(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
     int addr, unsigned char *buf);
   int avr_write_page_default(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
     int addr, unsigned char *data);
   int avr_is_and(const unsigned char *s1, const unsigned char *s2, const unsigned char *s3, size_t n);
+  uint32_t avr_crc32(uint32_t crc, const unsigned char *buf, size_t len);
 
-  // Bytewise cached read/write API
+  // Cached read/write API
   int avr_read_byte_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
     unsigned long addr, unsigned char *value);
   int avr_write_byte_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
     unsigned long addr, unsigned char data);
+  int avr_read_range_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
+    int addr, int len, unsigned char *buf);
+  int avr_write_range_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
+    int addr, int len, const unsigned char *data);
   int avr_chip_erase_cached(const PROGRAMMER *pgm, const AVRPART *p);
   int avr_page_erase_cached(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
     unsigned int addr);
@@ -1237,6 +1277,17 @@ typedef struct {
   int addr, len;
 } Segment;
 
+typedef struct {                // Run of consecutive set bytes in multi-memory flat address space
+  unsigned addr;                // Address of first byte
+  int len, cap;                 // Number of bytes in buf and allocated size of buf
+  unsigned char *buf;
+} Extent;
+
+typedef struct {                // Sparse multi-memory image, see fileio_image_put()
+  int n, nalloc;                // Number of extents and allocated size of ext
+  Extent *ext;
+} Memimage;
+
 enum {
   FIO_READ,
   FIO_WRITE,
@@ -1261,6 +1312,12 @@ extern "C" {
   int segment_normalise(const AVRMEM *mem, Segment *segp);
   int fileio_segments(int oprwv, const char *filename, FILEFMT format,
     const AVRPART *p, const AVRMEM *mem, int n, const Segment *seglist);
+  Memimage *fileio_new_image(void);
+  void fileio_free_image(Memimage *img);
+  void fileio_image_put(Memimage *img, unsigned addr, const unsigned char *data, int len);
+  void fileio_image_add(Memimage *img, unsigned addr, const unsigned char *data, int len);
+  int fileio_image_get(const Memimage *img, unsigned addr, int len, const AVRMEM *mem, int memaddr);
+  int fileio_image(int oprwv, const char *filename, FILEFMT format, const AVRPART *p, Memimage *img);
 
 #ifdef __cplusplus
 }
@@ -1288,6 +1345,8 @@ typedef struct update {
   int op;                       // Symbolic memory operation DEVICE_... for -U
   char *filename;               // Filename for -U, can be -
   int format;                   // File format FMT_...
+  Memimage *image;              // Input file read beforehand, see update_preload()
+  int imagesize;                // What reading the input file into image returned
 } UPDATE;
 
 typedef struct {                // File reads for flash can exclude trailing 0xff, which are cut off
@@ -1321,6 +1380,7 @@ extern "C" {
   int update_is_readable(const char *fn);
 
   int update_dryrun(const AVRPART *p, UPDATE *upd);
+  int update_preload(const AVRPART *p, UPDATE *upd);
 
   AVRMEM **memory_list(const char *mstr, const PROGRAMMER *pgm, const AVRPART *p,
     int *np, int *rwvsoftp, int *dry);
@@ -1368,6 +1428,28 @@ extern int allow_subshells;
 // This name is fixed, it's only here for symmetry with default_parallel and default_serial
 #define DEFAULT_USB       "usb"
 
+// Hash table entry for lookups by name, see hash_put() in config.c
+typedef struct {
+  const void *key;              // Key bytes owned by the caller, NULL for empty slot
+  size_t len;                   // Length of key
+  void *first;                  // First item stored under this key
+  void *exact;                  // First item for which this key is the full name
+  int n;                        // Number of items stored under this key
+} Hash_entry;
+
+typedef struct {
+  int size, used, nocase;
+  Hash_entry *e;
+} Hash_table;
+
+// Allocation statistics of a context
+typedef struct {
+  long nallocs;                 // Number of fresh allocations
+  long nreallocs;               // Number of reallocations of existing blocks
+  uint64_t bytes;               // Total bytes requested by fresh allocations
+  size_t max;                   // Largest single request, including reallocations
+} Cfg_allocstats;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -1376,10 +1458,18 @@ extern "C" {
   void *cfg_realloc(const char *funcname, void *p, size_t n);
   char *cfg_strdup(const char *funcname, const char *s);
   void mmt_f_free(void *ptr);
+  void cfg_alloc_add(const Cfg_allocstats *a);
+  void cfg_alloc_stats(void);
   int init_config(void);
   void cleanup_config(void);
   int read_config(const char *file);
+  int cfg_cache_load(const char *cachefile, LISTID files);
+  int cfg_cache_save(const char *cachefile, LISTID files);
   const char *cache_string(const char *file);
+  Hash_table *hash_new(int nocase);
+  void hash_free(Hash_table *t);
+  Hash_entry *hash_get(const Hash_table *t, const void *key, size_t len);
+  Hash_entry *hash_put(Hash_table *t, const void *key, size_t len);
   unsigned char *cfg_unescapeu(unsigned char *d, const unsigned char *s);
   char *cfg_unescape(char *d, const char *s);
   char *cfg_escape(const char *s);
@@ -1720,6 +1810,7 @@ extern "C" {
   int ldi_Rd(int op16);
   int ldi_K(int op16);
   AVR_mnemo opcode_mnemo(int op16, int avrlevel);
+  void opcode_zap_tables();
   int op16_is_valid(int op16, int avrlevel);
   int op16_is_benign(int op16, int avrlevel);
   int avr_get_archlevel(const AVRPART *p);
@@ -1742,10 +1833,16 @@ extern "C" {
  * Context structure
  *
  * Global and static variables should go here; the only remaining static
- * variables ought to be read-only tables. Access should be via a global
- * pointer libavrdude_context *cx; applications using libavrdude ought to
- * allocate cx = mmt_malloc(sizeof *cx) for each instantiation (and set initial
- * values if needed) and deallocate with mmt_free(cx).
+ * variables ought to be read-only tables. Access should be via the
+ * thread-local pointer libavrdude_context *cx; applications using libavrdude
+ * ought to allocate cx = mmt_malloc(sizeof *cx) for each instantiation (and
+ * set initial values if needed) and deallocate with free_cx(). Each thread
+ * that uses libavrdude needs its own cx, eg, from init_cx(NULL).
+ *
+ * Threads can drive independent programmers and parts concurrently provided
+ * each has its own copy from pgm_dup() and avr_dup_part(). The configuration
+ * (part_list, programmers, default_* and avr_mem_order[]) is shared: it must
+ * be read before threads are started and is read-only thereafter.
  */
 
 typedef struct {
@@ -1755,11 +1852,18 @@ typedef struct {
 
   // Static variables from avr.c
   int avr_disableffopt;         // Disables trailing 0xff flash optimisation
+  int avr_diffprog;             // Differential programming: skip pages that need not be written
+  int avr_erased;               // Flash known to be erased by the last chip erase and not written since
   uint64_t avr_epoch;           // Epoch for avr_ustimestamp()
   int avr_epoch_init;           // Whether above epoch is initialised
   int avr_last_percent;         // Last valid percentage for report_progress()
   double avr_start_time;        // Start time in s of report_progress() activity
 
+  // Static variables from avrpart.c
+  LISTID avr_ixparts;           // Part list indexed by index_avrparts()
+  int avr_ixnparts;             // Number of parts at the time
+  Hash_table *avr_ixname, *avr_ixsig, *avr_ixdevcode;   // Part lookup tables
+
   // Static variables from bitbang.c
   int bb_delay_decrement;
 
@@ -1781,6 +1885,7 @@ typedef struct {
   LISTID cfg_pushedcomms;       // Temporarily pushed main comments
   int cfg_pushed;               // ... for memory sections
   int cfg_init_search;          // Used in cfg_comp_search()
+  Cfg_allocstats cfg_allocs;    // See cfg_alloc_stats()
 
   // Static variable from dfu.c
   uint16_t dfu_wIndex;          // A running number for USB messages
@@ -1791,18 +1896,30 @@ typedef struct {
   // Static variable from ppi.c
   unsigned char ppi_shadow[3];
 
+  // Static variables from pgm.c
+  LISTID pgm_ixpgms;            // Programmer list indexed by index_programmers()
+  int pgm_ixnpgms;              // Number of programmers at the time
+  Hash_table *pgm_ixid;         // Programmer lookup table by id
+
   // Static variables from ser_avrdoper.c
   unsigned char sad_avrdoperRxBuffer[280];      // Buffer for receiving data
   int sad_avrdoperRxLength;     // Amount of valid bytes in rx buffer
   int sad_avrdoperRxPosition;   // Amount of bytes already consumed in rx buffer
 
   // Static variables from ser_win32.c/ser_posix.c
+  int ser_lowlat;               // Opt-in low-latency mode for serial ports (-L)
 
 #if defined(WIN32)
   unsigned char ser_serial_over_ethernet;
 #else
   struct termios ser_original_termios;
   int ser_saved_original_termios;
+  char *ser_latency_file;       // FTDI latency_timer changed by -L, NULL if none
+  int ser_latency_timer;        // Its original value in ms
+  char *ser_port;               // Port of the round-trip statistics below
+  uint64_t ser_sent_us;         // Time of last send awaiting a response, 0 if none
+  long ser_nrt;                 // Number of round trips from send to first received byte
+  uint64_t ser_rtsum, ser_rtmin, ser_rtmax; // Their total, min and max latency in us
 #endif
 
   // Static variables from term.c
@@ -1826,6 +1943,12 @@ typedef struct {
   // Static variable from fileio.c
   int reccount;
 
+  // Static variables from avr_opcodes.c
+#define OPC_NTABLES 4
+  int opc_ntables, opc_next;    // Number of decode tables in use, next slot to be recycled
+  int opc_level[OPC_NTABLES];   // The avrlevel for which each table was built
+  int16_t *opc_table[OPC_NTABLES];      // Lazily built opcode to mnemonic tables, see opcode_mnemo()
+
   // Static variables from disasm.c
   int dis_initopts, dis_flashsz, dis_flashsz2, dis_addrwidth, dis_sramwidth;
   int dis_pass, dis_para, dis_cycle_index, dis_io_offset, dis_codewidth;
@@ -1847,7 +1970,7 @@ typedef struct {
   int usb_access_error;
 } libavrdude_context;
 
-extern libavrdude_context *cx;
+extern LIBAVRDUDE_TLS libavrdude_context *cx;
 
 // Formerly confwin.h
 
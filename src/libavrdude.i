@@ -42,12 +42,12 @@ The following global variables are available in `ad.cvar`:
 char * version  = AVRDUDE_FULL_VERSION;
 char * progname = "avrdude";
 char * progbuf = "       ";
-int verbose;
-int quell_progress;
+LIBAVRDUDE_TLS int verbose;
+LIBAVRDUDE_TLS int quell_progress;
 int ovsigck;
 const char *partdesc = "";
 const char *pgmid = "";
-libavrdude_context *cx;
+LIBAVRDUDE_TLS libavrdude_context *cx;
 
 static PyObject *msg_cb = NULL;
 static PyObject *progress_cb = NULL;
@@ -373,7 +373,7 @@ int avr_initmem(const AVRPART *p);
     if (offset + len > (unsigned)$self->size)
       len = $self->size - offset;
     memcpy($self->buf + offset, in, len);
-    memset($self->tags + offset, TAG_ALLOCATED, len);
+    avr_tag_range($self, offset, len, 1);
     return len;
   }
 }
@@ -389,7 +389,7 @@ int avr_initmem(const AVRPART *p);
     if (offset + len > (unsigned)$self->size)
       len = $self->size - offset;
     memset($self->buf + offset, value, len);
-    memset($self->tags + offset, 0, len);
+    avr_tag_range($self, offset, len, 0);
     return len;
   }
 }
@@ -61,10 +61,15 @@
 
 #define LINUXSPI "linuxspi"
 
+#define LINUXSPI_BUFSIZ_SYSFS "/sys/module/spidev/parameters/bufsiz"
+#define LINUXSPI_DEFAULT_BUFSIZ 4096    // spidev's compiled-in default
+#define LINUXSPI_MAX_XFERS 256          // Max transfer segments per SPI_IOC_MESSAGE() ioctl()
+
 // Private data for this programmer
 struct pdata {
   int disable_no_cs;
   int fd_spidev, fd_gpiochip, fd_linehandle;
+  int bufsiz;                   // Max number of bytes per SPI message as allowed by spidev
 };
 
 // Use private programmer data as if they were a global structure my
@@ -103,6 +108,76 @@ static int linuxspi_spi_duplex(const PROGRAMMER *pgm, const unsigned char *tx, u
   return ret == -1? -1: 0;
 }
 
+/*
+ * @brief Sends/receives a stream of 4-byte ISP commands in full duplex mode
+ *
+ * Each command is a transfer segment of its own; the segments are batched into
+ * as few multi-segment SPI_IOC_MESSAGE() ioctl() calls as the spidev bufsiz
+ * permits, instead of one ioctl() per command.
+ * @return -1 on failure, otherwise 0
+ */
+static int linuxspi_spi_stream(const PROGRAMMER *pgm, const unsigned char *tx, unsigned char *rx, int len) {
+  struct spi_ioc_transfer tr[LINUXSPI_MAX_XFERS];
+  int maxn = my.bufsiz/4;
+
+  if(maxn > LINUXSPI_MAX_XFERS)
+    maxn = LINUXSPI_MAX_XFERS;
+  if(maxn < 1)
+    maxn = 1;
+
+  for(int done = 0; done < len;) {
+    int n, nbytes, ret;
+
+    for(n = 0, nbytes = 0; n < maxn && done + nbytes < len; n++) {
+      int seglen = len - done - nbytes < 4? len - done - nbytes: 4;
+
+      tr[n] = (struct spi_ioc_transfer) {
+        .tx_buf = (unsigned long) (tx + done + nbytes),
+        .rx_buf = (unsigned long) (rx + done + nbytes),
+        .len = seglen,
+        .delay_usecs = 1,
+        .speed_hz = 1.0/pgm->bitclock,
+        .bits_per_word = 8,
+      };
+      nbytes += seglen;
+    }
+
+    errno = 0;
+    ret = ioctl(my.fd_spidev, SPI_IOC_MESSAGE(n), tr);
+    if(ret != nbytes) {
+      int ioctl_errno = errno;
+
+      msg_error("\n");
+      pmsg_error("unable to send SPI message of %d segments", n);
+      if(ioctl_errno)
+        msg_error(": %s", strerror(ioctl_errno));
+      msg_error("\n");
+      return -1;
+    }
+    done += nbytes;
+  }
+
+  return 0;
+}
+
+// Read the maximum SPI message size from the spidev module parameters
+static int linuxspi_bufsiz(void) {
+  int bufsiz = 0;
+  FILE *fp = fopen(LINUXSPI_BUFSIZ_SYSFS, "r");
+
+  if(fp) {
+    if(fscanf(fp, "%d", &bufsiz) != 1)
+      bufsiz = 0;
+    fclose(fp);
+  }
+  if(bufsiz < 4) {
+    pmsg_debug("cannot read %s, assuming spidev bufsiz of %d\n", LINUXSPI_BUFSIZ_SYSFS, LINUXSPI_DEFAULT_BUFSIZ);
+    bufsiz = LINUXSPI_DEFAULT_BUFSIZ;
+  }
+
+  return bufsiz;
+}
+
 static void linuxspi_setup(PROGRAMMER *pgm) {
   pgm->cookie = mmt_malloc(sizeof(struct pdata));
 }
@@ -192,6 +267,9 @@ static int linuxspi_open(PROGRAMMER *pgm, const char *pt) {
   if(!my.disable_no_cs)
     mode |= SPI_NO_CS;
 
+  my.bufsiz = linuxspi_bufsiz();
+  pmsg_debug("using spidev bufsiz of %d bytes\n", my.bufsiz);
+
   ret = ioctl(my.fd_spidev, SPI_IOC_WR_MODE32, &mode);
   if(ret == -1) {
     int ioctl_errno = errno;
@@ -381,6 +459,194 @@ static int linuxspi_chip_erase(const PROGRAMMER *pgm, const AVRPART *p) {
   return 0;
 }
 
+// Set up the ISP read command for the byte at addr of memory m; return its opcode or NULL
+static OPCODE *linuxspi_readop(const AVRMEM *m, unsigned int addr, unsigned char *cmd) {
+  OPCODE *readop;
+
+  if(m->op[AVR_OP_READ_LO]) {   // Implies flash
+    readop = m->op[addr & 1? AVR_OP_READ_HI: AVR_OP_READ_LO];
+    addr /= 2;
+  } else {
+    readop = m->op[AVR_OP_READ];
+  }
+
+  if(readop) {
+    memset(cmd, 0, 4);
+    avr_set_bits(readop, cmd);
+    avr_set_addr(readop, cmd, addr);
+  }
+
+  return readop;
+}
+
+/*
+ * Wait for a page write to complete by polling the last byte in the page
+ * that reads back differently while the page is being programmed; only sleep
+ * for max_write_delay if there is no such byte in the page.
+ */
+static int linuxspi_poll_page(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int addr, unsigned int n_bytes) {
+
+  unsigned char cmd[4], res[4], data;
+  unsigned int i;
+  OPCODE *readop = NULL;
+
+  for(i = addr + n_bytes; i > addr; i--) {
+    unsigned char b = m->buf[i - 1];
+
+    if(b != 0xff && b != m->readback[0] && b != m->readback[1])
+      break;
+  }
+
+  if(i > addr)
+    readop = linuxspi_readop(m, --i, cmd);
+
+  if(!readop) {
+    usleep(m->max_write_delay);
+    return 0;
+  }
+
+  uint64_t start = avr_ustimestamp();
+
+  do {
+    if(linuxspi_spi_duplex(pgm, cmd, res, 4) < 0)
+      return -1;
+    data = 0;
+    avr_get_output(readop, res, &data);
+    if(data == m->buf[i])
+      return 0;
+  } while(avr_ustimestamp() - start < (uint64_t) (m->max_write_delay > 0? m->max_write_delay: 0) + 1000);
+
+  pmsg_error("%s page write at %s timed out: read back 0x%02x instead of 0x%02x\n",
+    m->desc, str_ccaddress(i, m->size), data, m->buf[i]);
+  return -1;
+}
+
+/*
+ * Write whole pages of paged memory: each page is a single command stream of
+ * load extended address (if needed), load page low/high bytes and write page
+ */
+static int linuxspi_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  OPCODE *lext = m->op[AVR_OP_LOAD_EXT_ADDR], *wp = m->op[AVR_OP_WRITEPAGE];
+  OPCODE *lo = m->op[AVR_OP_LOADPAGE_LO], *hi = m->op[AVR_OP_LOADPAGE_HI];
+  unsigned int end = addr + n_bytes;
+
+  if(!m->paged || !lo || !wp || m->page_size < 2)
+    return -2;                  // Let avr_write_mem() write byte by byte
+
+  if(end > (unsigned int) m->size) {
+    pmsg_error("%s write of %u bytes at %s exceeds memory size\n", m->desc, n_bytes, str_ccaddress(addr, m->size));
+    return -1;
+  }
+
+  page_size = m->page_size;
+  int bufsize = 4*(page_size + 2);
+  unsigned char *tx = mmt_malloc(bufsize), *rx = mmt_malloc(bufsize);
+  int rc = n_bytes;
+
+  led_clr(pgm, LED_ERR);
+  led_set(pgm, LED_PGM);
+
+  for(unsigned int pa = addr; pa < end; pa += page_size) {
+    unsigned int n = end - pa < page_size? end - pa: page_size;
+    unsigned char *cp = tx;
+
+    memset(tx, 0, bufsize);
+    if(lext) {
+      avr_set_bits(lext, cp);
+      avr_set_addr(lext, cp, hi? pa/2: pa);
+      cp += 4;
+    }
+    for(unsigned int a = pa; a < pa + n; a++, cp += 4) {
+      OPCODE *lp = hi && (a & 1)? hi: lo;
+
+      avr_set_bits(lp, cp);
+      avr_set_addr(lp, cp, hi? a/2: a);
+      avr_set_input(lp, cp, m->buf[a]);
+    }
+    avr_set_bits(wp, cp);
+    avr_set_addr(wp, cp, hi? pa/2: pa);
+    cp += 4;
+
+    if(verbose >= MSG_TRACE)
+      trace_buffer(__func__, tx, cp - tx);
+
+    if(linuxspi_spi_stream(pgm, tx, rx, cp - tx) < 0 || linuxspi_poll_page(pgm, p, m, pa, n) < 0) {
+      led_set(pgm, LED_ERR);
+      rc = -1;
+      break;
+    }
+  }
+
+  led_clr(pgm, LED_PGM);
+  mmt_free(tx);
+  mmt_free(rx);
+
+  return rc;
+}
+
+// Read n_bytes from addr onwards as a single stream of read commands
+static int linuxspi_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
+
+  OPCODE *lext = m->op[AVR_OP_LOAD_EXT_ADDR];
+  unsigned int end = addr + n_bytes, off = avr_sigrow_offset(p, m, addr);
+  int wordwise = m->op[AVR_OP_READ_LO] != NULL;
+
+  if(!(wordwise? m->op[AVR_OP_READ_HI] != NULL: m->op[AVR_OP_READ] != NULL))
+    return -2;
+
+  if(end > (unsigned int) m->size) {
+    pmsg_error("%s read of %u bytes at %s exceeds memory size\n", m->desc, n_bytes, str_ccaddress(addr, m->size));
+    return -1;
+  }
+
+  // One read command per byte plus one load extended address per 64 k words
+  int maxcmds = n_bytes + n_bytes/0x10000 + 2;
+  unsigned char *tx = mmt_malloc(4*maxcmds), *rx = mmt_malloc(4*maxcmds);
+  OPCODE **ops = mmt_malloc(maxcmds*sizeof *ops);
+  int nc = 0, rc = n_bytes;
+  unsigned int lext_byte = ~0U;
+
+  led_clr(pgm, LED_ERR);
+  led_set(pgm, LED_PGM);
+
+  for(unsigned int a = addr; a < end; a++) {
+    unsigned int da = wordwise? (a + off)/2: a + off;
+
+    if(lext && da >> 16 != lext_byte) { // Issue load extended address at start and when needed
+      lext_byte = da >> 16;
+      avr_set_bits(lext, tx + 4*nc);
+      avr_set_addr(lext, tx + 4*nc, da);
+      ops[nc++] = NULL;
+    }
+    ops[nc] = linuxspi_readop(m, a + off, tx + 4*nc);
+    nc++;
+  }
+
+  if(linuxspi_spi_stream(pgm, tx, rx, 4*nc) < 0) {
+    led_set(pgm, LED_ERR);
+    rc = -1;
+  } else {
+    unsigned char *bp = m->buf + addr;
+
+    for(int i = 0; i < nc; i++)
+      if(ops[i]) {
+        *bp = 0;
+        avr_get_output(ops[i], rx + 4*i, bp++);
+      }
+  }
+
+  led_clr(pgm, LED_PGM);
+  mmt_free(ops);
+  mmt_free(tx);
+  mmt_free(rx);
+
+  return rc;
+}
+
 static int linuxspi_parseexitspecs(PROGRAMMER *pgm, const char *sp) {
   char *cp, *s, *str = mmt_strdup(sp);
   int rv = 0;
@@ -467,6 +733,8 @@ void linuxspi_initpgm(PROGRAMMER *pgm) {
   pgm->write_byte = avr_write_byte_default;
 
   // Optional functions
+  pgm->paged_write = linuxspi_paged_write;
+  pgm->paged_load = linuxspi_paged_load;
   pgm->setup = linuxspi_setup;
   pgm->teardown = linuxspi_teardown;
   pgm->parseexitspecs = linuxspi_parseexitspecs;
@@ -1162,36 +1162,65 @@ void *lsrch(LISTID lid, void *p, int (*compare)(void *p1, void *p2)) {
 /*----------------------------------------------------------------------
 |  lsort
 |
-|  sort list - sorts list inplace (using bubble sort)
+|  sort list - sorts list inplace (using bottom-up merge sort)
 |
+|  The sort is stable: elements that compare equal keep their relative
+|  order. Nodes are relinked rather than their data swapped, so an LNODEID
+|  keeps pointing to the same data. Runs in O(n log n) time and O(1) space.
  ----------------------------------------------------------------------*/
 void lsort(LISTID lid, int (*compare)(void *p1, void *p2)) {
   LIST *l;
-  LISTNODE *lt;                 // This
-  LISTNODE *ln;                 // Next
-  int unsorted = 1;
+  LISTNODE *head, *tail, *p, *q, *e;
+  int insize, nmerges, psize, qsize;
 
   l = (LIST *) lid;
 
   CKLMAGIC(l);
 
-  while(unsorted) {
-    lt = l->top;
-    unsorted = 0;
-    while(lt != NULL) {
-      CKMAGIC(lt);
-      ln = lt->next;
-      if(ln != NULL && compare(lt->data, ln->data) > 0) {
-        void *p = ln->data;
-
-        ln->data = lt->data;
-        lt->data = p;
-        unsorted = 1;
+  if((head = l->top) == NULL)
+    return;
+
+  // Merge adjacent runs of length insize; stop after a pass with one merge
+  for(insize = 1;; insize *= 2) {
+    p = head;
+    head = tail = NULL;
+    nmerges = 0;
+
+    while(p != NULL) {
+      nmerges++;
+      // Step q insize places along from p
+      for(q = p, psize = 0; q != NULL && psize < insize; psize++)
+        q = q->next;
+      qsize = insize;
+
+      // Merge run at p with run at q, taking from p on ties for stability
+      while(psize > 0 || (qsize > 0 && q != NULL)) {
+        if(psize == 0) {
+          e = q, q = q->next, qsize--;
+        } else if(qsize == 0 || q == NULL || compare(p->data, q->data) <= 0) {
+          e = p, p = p->next, psize--;
+        } else {
+          e = q, q = q->next, qsize--;
+        }
+        CKMAGIC(e);
+        if(tail != NULL)
+          tail->next = e;
+        else
+          head = e;
+        e->prev = tail;
+        tail = e;
       }
-      lt = ln;
+      p = q;
     }
+    tail->next = NULL;
+
+    if(nmerges <= 1)
+      break;
   }
 
+  l->top = head;
+  l->bottom = tail;
+
   CKLMAGIC(l);
 }
 
@@ -92,13 +92,16 @@ int avrdude_message2(FILE *fp, int lno, const char *file, const char *func,
   int rc = 0;
   va_list ap;
 
-  static struct {               // Memorise whether last print ended at beginning of line
+  static LIBAVRDUDE_TLS struct {        // Memorise whether last print ended at beginning of line
     FILE *fp;
     int bol;                    // Are we at the beginning of a line for this fp stream?
   } bols[5 + 1];                // Cater for up to 5 different FILE pointers plus one catch-all
 
   size_t bi = 0;                // bi is index to bols[] array
 
+  if(msg_log && (fp == stdout || fp == stderr))
+    fp = msg_log;
+
   for(bi = 0; bi < sizeof bols/sizeof *bols - 1; bi++) {      // Note the -1, so bi is valid after loop
     if(!bols[bi].fp) {          // First free space
       bols[bi].fp = fp;         // Insert fp in first free space
@@ -209,7 +212,7 @@ struct list_walk_cookie {
   const char *prefix;
 };
 
-libavrdude_context *cx;         // Context pointer, eventually the only global variable
+LIBAVRDUDE_TLS libavrdude_context *cx; // Context pointer, eventually the only global variable
 
 static LISTID updates = NULL;
 
@@ -217,11 +220,16 @@ static LISTID extended_params = NULL;
 
 static LISTID additional_config_files = NULL;
 
+static LISTID job_args = NULL;  // Options a -S client passes on to the server
+
+static LISTID gang_targets = NULL;      // -G targets for gang programming
+
 static PROGRAMMER *pgm;
 
 // Global options
-int verbose;                    // Verbose output
-int quell_progress;             // Quell progress report and un-verbose output
+LIBAVRDUDE_TLS int verbose;     // Verbose output
+LIBAVRDUDE_TLS int quell_progress; // Quell progress report and un-verbose output
+LIBAVRDUDE_TLS FILE *msg_log;   // Where this thread's messages go instead of stdout/stderr
 int ovsigck;                    // 1 = override sig check, 0 = don't
 const char *partdesc;           // Part -p string
 const char *pgmid;              // Programmer -c string
@@ -250,10 +258,12 @@ static void usage(void) {
     "                         e.g., -c 'ur*'/s for programmer info/definition\n"
     "  -A                     Disable trailing-0xff removal for file/AVR read\n"
     "  -D                     Disable auto-erase for flash memory; implies -A\n"
+    "  -d                     Differential programming: skip unchanged pages\n"
     "  -i <delay>             ISP Clock Delay [in microseconds]\n"
     "  -P <port>              Connection; -P ?s or -P ?sa lists serial ones\n"
     "  -r                     Reconnect to -P port after \"touching\" it; wait\n"
     "                         400 ms for each -r; needed for some USB boards\n"
+    "  -L                     Low-latency mode for serial ports (POSIX only)\n"
     "  -F                     Override invalid signature or initial checks\n"
     "  -e                     Perform a chip erase at the beginning\n"
     "  -O                     Perform RC oscillator calibration (see AVR053)\n"
@@ -263,6 +273,10 @@ static void usage(void) {
     "                         Carry out memory operation when it is its turn\n"
     "                         Multiple -t, -T and -U options can be specified\n"
     "  -n                     Do not write to the device whilst processing -U\n"
+    "  -G <[programmer@]port>[,...]\n"
+    "                         Gang mode: carry out -U/-T on all targets at once\n"
+    "  -S <socket>            Serve jobs on a Unix-domain socket; with -U or -T\n"
+    "                         send the job to the server on that socket instead\n"
     "  -V                     Do not automatically verify during -U\n"
     "  -E <exitsp>[,<exitsp>] List programmer exit specifications\n"
     "  -x <extended_param>    Pass <extended_param> to programmer, see -x help\n"
@@ -456,6 +470,14 @@ static void list_parts(FILE *f, const char *prefix, LISTID avrparts, int pm) {
   }
 }
 
+// Print allocation statistics if AVRDUDE_MEMSTATS is set
+static void alloc_stats(void) {
+  const char *env = getenv("AVRDUDE_MEMSTATS");
+
+  if(env && *env)
+    cfg_alloc_stats();
+}
+
 static void exithook(void) {
   if(pgm->teardown)
     pgm->teardown(pgm);
@@ -474,6 +496,14 @@ static void cleanup_main(void) {
     ldestroy(additional_config_files);
     additional_config_files = NULL;
   }
+  if(job_args) {
+    ldestroy_cb(job_args, mmt_f_free);
+    job_args = NULL;
+  }
+  if(gang_targets) {
+    ldestroy(gang_targets);
+    gang_targets = NULL;
+  }
 
   cleanup_config();
 }
@@ -646,6 +676,61 @@ static void part_not_found(const char *partdesc) {
   msg_error("\n");
 }
 
+// Parse bit clock period in us or, with unit Hz, kHz or MHz, frequency; return -1 on error
+double parse_bitclock(const char *str) {
+  char *e;
+  double bitclock = strtod(str, &e);
+
+  if((e == str) || bitclock <= 0.0) {
+    pmsg_error("invalid bit clock period %s\n", str);
+    return -1;
+  }
+  while(*e && isascii(*e & 0xff) && isspace(*e & 0xff))
+    e++;
+  if(*e == 0 || str_caseeq(e, "us"))    // us is optional and the default
+    ;
+  else if(str_caseeq(e, "m") || str_caseeq(e, "mhz"))
+    bitclock = 1/bitclock;
+  else if(str_caseeq(e, "k") || str_caseeq(e, "khz"))
+    bitclock = 1e3/bitclock;
+  else if(str_caseeq(e, "hz"))
+    bitclock = 1e6/bitclock;
+  else {
+    pmsg_error("invalid bit clock unit %s\n", e);
+    return -1;
+  }
+
+  return bitclock;
+}
+
+// Return mmt_malloc'd port from the configuration for a programmer used without -P
+char *default_port(const PROGRAMMER *pgm) {
+  switch(pgm->conntype) {
+  case CONNTYPE_PARALLEL:
+    return mmt_strdup(default_parallel);
+
+  case CONNTYPE_SERIAL:
+    return mmt_strdup(default_serial);
+
+  case CONNTYPE_USB:
+    return mmt_strdup(DEFAULT_USB);
+
+  case CONNTYPE_SPI:
+
+#ifdef HAVE_LINUXSPI
+    return mmt_strdup(*default_spi? default_spi: "unknown");
+#else
+    return mmt_strdup("unknown");
+#endif
+
+  case CONNTYPE_LINUXGPIO:
+    return mmt_strdup(default_linuxgpio);
+
+  default:
+    return mmt_strdup("unknown");
+  }
+}
+
 #if !defined(WIN32)
 // Safely concatenate dir/file into dst that has size n
 static char *concatpath(char *dst, char *dir, char *file, size_t n) {
@@ -672,151 +757,438 @@ static char *concatpath(char *dst, char *dir, char *file, size_t n) {
 #endif
 
 
-int main(int argc, char *argv[]) {
-  int rc;                       // General return code checking
-  int exitrc;                   // Exit code for main()
-  int i;                        // General loop counter
-  int ch;                       // Options flag
-  struct avrpart *p;            // Which avr part we are programming
-  AVRMEM *sig;                  // Signature data
-  struct stat sb;
-  UPDATE *upd;
-  LNODEID *ln;
-
-  // Options/operating mode variables
-  int erase;                    // 1=erase chip, 0=don't
-  int flashread;                // 1=flash is going to be read, 0=no flash reads
-  int calibrate;                // 1=calibrate RC oscillator, 0=don't
-  int no_avrduderc;             // 1=don't load personal conf file
-  char *port;                   // Device port (/dev/xxx)
-  const char *exitspecs;        // Exit specs string from command line
-  int explicit_c;               // 1=explicit -c on command line, 0=not specified there
-  int explicit_e;               // 1=explicit -e on command line, 0=not specified there
-  char sys_config[PATH_MAX];    // System wide config file
-  char executable_abspath[PATH_MAX];     // Absolute path to avrdude executable
-  char executable_dirpath[PATH_MAX];     // Absolute path to folder with executable
-  bool executable_abspath_found = false; // Absolute path to executable found
-  bool sys_config_found = false;         // avrdude.conf file found
-  char *e;                      // For strtod() error checking
-  const char *errstr;           // For str_int() error checking
-  int baudrate;                 // Override default programmer baud rate
-  int touch_1200bps;            // Touch serial port prior to programming
-  double bitclock;              // Specify programmer bit clock (JTAG ICE)
-  int ispdelay;                 // Specify the delay for ISP clock
-  int init_ok;                  // Device initialization worked well
-  int is_open;                  // Device open succeeded
-  int ce_delayed;               // Chip erase delayed
-  char *logfile;                // Use logfile rather than stderr for diagnostics
-  enum updateflags uflags = UF_AUTO_ERASE | UF_VERIFY;  // Flags for do_op()
-
-  init_cx(NULL);
+/*
+ * Initialise part p with the opened programmer, check its signature, erase
+ * the chip if needed and carry out the -U, -T and -t updates in order;
+ * return the exit code for main(), which is 1 on failure or if a delayed
+ * chip erase has not been redeemed by a successful flash write
+ */
+int process_updates(PROGRAMMER *pgm, AVRPART *p, LISTID updates, enum updateflags uflags,
+  int erase, int explicit_e, int baudrate, int is_dryrun) {
 
-#ifdef _MSC_VER
-  _set_printf_count_output(1);
-#endif
+  int rc, i, init_ok, exitrc = 0, flashread = 0, ce_delayed = 0;
+  AVRMEM *sig;
+  UPDATE *upd;
+  LNODEID ln;
 
-  // Set line buffering for file descriptors so we see stdout and stderr properly interleaved
-  setvbuf(stdout, (char *) NULL, _IOLBF, 0);
-  setvbuf(stderr, (char *) NULL, _IOLBF, 0);
+  // Enable the programmer
+  pgm->enable(pgm, p);
 
-  sys_config[0] = '\0';
+  // Turn off all the status LEDs and reset LED states
+  led_set(pgm, LED_BEG);
 
-  progname = strrchr(argv[0], '/');
+  // Initialize the chip in preparation for accepting commands
+  init_ok = (rc = pgm->initialize(pgm, p)) >= 0;
+  if(!init_ok) {
+    if(rc == LIBAVRDUDE_EXIT)
+      return 0;
+    pmsg_error("initialization failed  (rc = %d)\n", rc);
+    if(rc == -2)
+      imsg_error(" - the programmer ISP clock is too fast for the target\n");
+    else
+      imsg_error(" - double check the connections and try again\n");
 
-#if defined (WIN32)
-  // Take care of backslash as dir sep in W32
-  if(!progname)
-    progname = strrchr(argv[0], '\\');
-#endif                          // WIN32
+    if(str_eq(pgm->type, "serialupdi") || str_eq(pgm->type, "SERBB"))
+      imsg_error(" - use -b to set lower baud rate, e.g. -b %d\n", baudrate? baudrate/2: 57600);
+    else
+      imsg_error(" - use -B to set lower the bit clock frequency, e.g. -B 125kHz\n");
 
-  if(progname)
-    progname++;
-  else
-    progname = argv[0];
+    if(str_starts(pgm->type, "pickit5"))
+      imsg_error(" - reset the programmer by unplugging it");
 
-  // Remove trailing .exe
-  if(str_ends(progname, ".exe")) {
-    progname = mmt_strdup(progname);    // Don't write to argv[0]
-    progname[strlen(progname) - 4] = 0;
+    if(!ovsigck) {
+      imsg_error(" - use -F to override this check\n");
+      return 1;
+    }
   }
 
-  avrdude_conf_version = "";
+  // Indicate programmer is ready
+  led_set(pgm, LED_RDY);
 
-  default_programmer = "";
-  default_parallel = "";
-  default_serial = "";
-  default_spi = "";
-  default_baudrate = 0;
-  default_bitclock = 0.0;
-  default_linuxgpio = "";
-  allow_subshells = 0;
+  msg_notice("\n");
+  pmsg_notice("AVR device initialized and ready to accept instructions\n");
 
-  init_config();
+  /*
+   * Let's read the signature bytes to make sure there is at least a chip on
+   * the other end that is responding correctly.  A check against
+   * 0xffffff/0x000000 should ensure that the signature bytes are valid.
+   */
+  if(!is_awire(p)) {            // Not AVR32
+    int attempt = 0;
+    int waittime = 10000;       // 10 ms
 
-  atexit(cleanup_main);
+  sig_again:
+    usleep(waittime);
+    if(init_ok) {
+      rc = avr_signature(pgm, p);
+      if(rc == LIBAVRDUDE_EXIT)
+        return 0;
+      if(rc != LIBAVRDUDE_SUCCESS) {
+        if(rc == LIBAVRDUDE_SOFTFAIL && is_updi(p) && attempt < 1) {
+          attempt++;
+          if(pgm->read_sib) {
+            // Read SIB and compare FamilyID
+            char sib[AVR_SIBLEN + 1];
 
-  updates = lcreat(NULL, 0);
-  if(updates == NULL) {
-    pmsg_error("cannot initialize updater list\n");
-    exit(1);
-  }
+            pgm->read_sib(pgm, p, sib);
+            pmsg_notice("System Information Block: %s\n", sib);
+            if(strncmp(p->family_id, sib, AVR_FAMILYIDLEN)) {
+              pmsg_warning("received FamilyID: \"%.*s\"\n", AVR_FAMILYIDLEN, sib);
+              imsg_warning("expected FamilyID: \"%s\"\n", p->family_id);
+            } else
+              pmsg_notice("received FamilyID: \"%.*s\"\n", AVR_FAMILYIDLEN, sib);
+          }
+          if(erase) {
+            erase = 0;
+            if(uflags & UF_NOWRITE) {
+              pmsg_warning("conflicting -e and -n options specified, NOT erasing chip\n");
+            } else {
+              pmsg_notice("trying to unlock the chip\n");
+              exitrc = avr_unlock(pgm, p);
+              if(exitrc)
+                return exitrc;
+              goto sig_again;
+            }
+          }
+          if(!ovsigck) {
+            pmsg_error("double check chip or use -F to override this check\n");
+            return 1;
+          }
+        }
+        pmsg_error("unable to read signature data (rc = %d)\n", rc);
+        if(!ovsigck) {
+          imsg_error("use -F to override this check\n");
+          return 1;
+        }
+      }
+    }
 
-  extended_params = lcreat(NULL, 0);
-  if(extended_params == NULL) {
-    pmsg_error("cannot initialize extended parameter list\n");
-    exit(1);
-  }
+    sig = avr_locate_signature(p);
+    if(sig == NULL)
+      pmsg_warning("signature memory not defined for device %s\n", p->desc);
+    else {
+      const char *mculist = str_ccmcunames_signature(sig->buf, pgm->prog_modes);
 
-  additional_config_files = lcreat(NULL, 0);
-  if(additional_config_files == NULL) {
-    pmsg_error("cannot initialize additional config files list\n");
-    exit(1);
-  }
+      if(!*mculist) {           // No matching signatures?
+        if(is_updi(p)) {        // UPDI parts have different(!) offsets for signature
+          int k, n = 0;         // Gather list of known different signature offsets
+          unsigned myoff = sig->offset, offlist[10];
 
-  partdesc = NULL;
-  port = NULL;
-  erase = 0;
-  flashread = 0;
-  calibrate = 0;
-  no_avrduderc = 0;
-  p = NULL;
-  ovsigck = 0;
-  quell_progress = 0;
-  exitspecs = NULL;
-  pgm = NULL;
-  pgmid = "";
-  explicit_c = 0;
-  explicit_e = 0;
-  verbose = 0;
-  baudrate = 0;
-  touch_1200bps = 0;
-  bitclock = 0.0;
-  ispdelay = 0;
-  is_open = 0;
-  ce_delayed = 0;
-  logfile = NULL;
+          for(LNODEID ln1 = lfirst(part_list); ln1; ln1 = lnext(ln1)) {
+            AVRMEM *m = avr_locate_signature(ldata(ln1));
 
-  if(argc == 1) {               // No arguments?
-    usage();
-    return 0;
-  }
+            if(m && m->offset != myoff) {
+              for(k = 0; k < n; k++)
+                if(m->offset == offlist[k])
+                  break;
+              if(k == n && k < (int) (sizeof offlist/sizeof *offlist))
+                offlist[n++] = m->offset;
+            }
+          }
+          // Now go through the list of other(!) sig offsets and try these
+          for(k = 0; k < n; k++) {
+            sig->offset = offlist[k];
+            if(avr_signature(pgm, p) >= 0)
+              if(*(mculist = str_ccmcunames_signature(sig->buf, pgm->prog_modes)))
+                break;
+          }
+          sig->offset = myoff;
+        }
+      }
 
-  // Determine the location of personal configuration file
+      int ff = 1, zz = 1;
 
-#if defined(WIN32)
-  win_set_path(usr_config, sizeof usr_config, USER_CONF_FILE);
-#else
-  usr_config[0] = 0;
-  if(!concatpath(usr_config, getenv("XDG_CONFIG_HOME"), XDG_USER_CONF_FILE, sizeof usr_config))
-    concatpath(usr_config, getenv("HOME"), ".config/" XDG_USER_CONF_FILE, sizeof usr_config);
-  if(stat(usr_config, &sb) < 0 || (sb.st_mode & S_IFREG) == 0)
-    concatpath(usr_config, getenv("HOME"), USER_CONF_FILE, sizeof usr_config);
-#endif
+      for(i = 0; i < sig->size; i++) {
+        if(sig->buf[i] != 0xff)
+          ff = 0;
+        if(sig->buf[i] != 0x00)
+          zz = 0;
+      }
+      bool signature_matches = sig->size >= 3 && !memcmp(sig->buf, p->signature, 3);
+      int showsig = !signature_matches || ff || zz || verbose > 0;
 
-  // Process command line arguments
-  while((ch = getopt(argc, argv, "?Ab:B:c:C:DeE:Fi:l:nNp:OP:qrtT:U:vVx:")) != -1) {
-    switch(ch) {
-    case 'b':                  // Override default programmer baud rate
+      if(showsig)
+        pmsg_info("device signature =%s", str_cchex(sig->buf, sig->size, 1));
+      if(*mculist && showsig)
+        msg_info(" (%s)", is_dryrun? p->desc: mculist);
+
+      if(ff || zz) {            // All three bytes are 0xff or all three bytes are 0x00
+        if(++attempt < 3) {
+          waittime *= 5;
+          msg_info(" (retrying)\n");
+          goto sig_again;
+        }
+        msg_info("\n");
+        pmsg_error("invalid device signature\n");
+        if(!ovsigck) {
+          pmsg_error("expected signature for %s is%s\n", p->desc, str_cchex(p->signature, 3, 1));
+          imsg_error("  - double check connections and try again, or use -F to carry on regardless\n");
+          return 1;
+        }
+      } else if(showsig) {
+        msg_info("\n");
+      }
+
+      if(!signature_matches) {
+        if(ovsigck) {
+          pmsg_warning("expected signature for %s is%s\n", p->desc, str_cchex(p->signature, 3, 1));
+        } else {
+          pmsg_error("expected signature for %s is%s\n", p->desc, str_cchex(p->signature, 3, 1));
+          imsg_error("  - double check chip or use -F to carry on regardless\n");
+          return 1;
+        }
+      }
+    }
+  }
+
+  if(uflags & UF_AUTO_ERASE) {
+    if((p->prog_modes & (PM_PDI | PM_UPDI)) && pgm->page_erase && lsize(updates) > 0) {
+      for(ln = lfirst(updates); ln; ln = lnext(ln)) {
+        upd = ldata(ln);
+        if(upd->memstr && upd->op == DEVICE_WRITE && memlist_contains_flash(upd->memstr, p)) {
+          cx->avr_disableffopt = 1;     // Must write full flash file including trailing 0xff
+          pmsg_notice("NOT erasing chip as page erase will be used for new flash%s contents;\n",
+            avr_locate_bootrow(p)? "/bootrow": "");
+          imsg_notice("unprogrammed flash contents remains: use -e for an explicit chip-erase\n");
+          break;
+        }
+      }
+    } else {
+      uflags &= ~UF_AUTO_ERASE;
+      for(ln = lfirst(updates); ln; ln = lnext(ln)) {
+        upd = ldata(ln);
+        if(upd->cmdline && *str_ltrim(upd->cmdline) && str_starts("erase", str_ltrim(upd->cmdline)))
+          break;                // -T erase already erases the chip: no auto-erase needed
+
+        if(upd->cmdline || (upd->memstr &&      // Might be reading flash?
+            (upd->op == DEVICE_READ || upd->op == DEVICE_VERIFY) && memlist_contains_flash(upd->memstr, p)))
+          flashread = 1;
+
+        if(upd->memstr && upd->op == DEVICE_WRITE && memlist_contains_flash(upd->memstr, p)) {
+          if(flashread) {
+            pmsg_info("NOT auto-erasing chip as flash might need reading before writing to it\n");
+          } else {
+            erase = 1;
+            pmsg_notice("auto-erasing chip as flash memory needs programming (-U %s:w:...)\n", upd->memstr);
+            imsg_notice("specify the -D option to disable this feature\n");
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  if(init_ok && erase) {
+    /*
+     * Erase the chip's flash and eeprom memories, this is required before the
+     * chip can accept new programming
+     */
+    if(uflags & UF_NOWRITE) {
+      if(explicit_e)
+        pmsg_warning("conflicting -e and -n specified, NOT erasing chip\n");
+      else
+        pmsg_notice("-n specified, NOT erasing chip\n");
+    } else {
+      exitrc = avr_chip_erase(pgm, p);
+      if(exitrc == LIBAVRDUDE_SOFTFAIL) {
+        pmsg_notice("delaying chip erase until first -U upload to flash\n");
+        ce_delayed = 1;
+        exitrc = 0;
+      } else if(exitrc) {
+        pmsg_error("chip erase failed\n");
+        return exitrc;
+      } else
+        pmsg_notice("erased chip\n");
+    }
+  }
+
+  if(!init_ok && !ovsigck) {    // Bail out on failed initialisation unless -F was given
+    return 1;
+  }
+
+  int wrmem = 0, terminal = 0;
+
+  if(lsize(updates) <= 1)
+    uflags |= UF_NOHEADING;
+  for(ln = lfirst(updates); ln; ln = lnext(ln)) {
+    const AVRMEM *m;
+
+    upd = ldata(ln);
+    if(upd->cmdline && wrmem) { // Invalidate cache if device was written to
+      wrmem = 0;
+      pgm->reset_cache(pgm, p);
+    } else if(!upd->cmdline) {  // Flush cache before any device memory access
+      pgm->flush_cache(pgm, p);
+      wrmem |= upd->op == DEVICE_WRITE;
+    }
+    if((uflags & UF_NOWRITE) && upd->cmdline && !terminal++)
+      pmsg_warning("the terminal ignores option -n, that is, it writes to the device\n");
+    rc = do_op(pgm, p, upd, uflags);
+    if(rc && rc != LIBAVRDUDE_SOFTFAIL) {
+      exitrc = 1;
+      break;
+    } else if(rc == 0 && upd->op == DEVICE_WRITE && (m = avr_locate_mem(p, upd->memstr)) && mem_is_in_flash(m))
+      ce_delayed = 0;           // Redeemed chip erase promise
+  }
+  pgm->flush_cache(pgm, p);
+
+  if(pgm->end_programming)
+    if(pgm->end_programming(pgm, p) < 0)
+      pmsg_error("could not end programming, aborting\n");
+
+  return ce_delayed? 1: exitrc;
+}
+
+int main(int argc, char *argv[]) {
+  int rc;                       // General return code checking
+  int exitrc;                   // Exit code for main()
+  int i;                        // General loop counter
+  int ch;                       // Options flag
+  struct avrpart *p;            // Which avr part we are programming
+  struct stat sb;
+  UPDATE *upd;
+  LNODEID *ln;
+
+  // Options/operating mode variables
+  int erase;                    // 1=erase chip, 0=don't
+  int calibrate;                // 1=calibrate RC oscillator, 0=don't
+  int no_avrduderc;             // 1=don't load personal conf file
+  char *port;                   // Device port (/dev/xxx)
+  const char *exitspecs;        // Exit specs string from command line
+  int explicit_c;               // 1=explicit -c on command line, 0=not specified there
+  int explicit_e;               // 1=explicit -e on command line, 0=not specified there
+  char sys_config[PATH_MAX];    // System wide config file
+  char executable_abspath[PATH_MAX];     // Absolute path to avrdude executable
+  char executable_dirpath[PATH_MAX];     // Absolute path to folder with executable
+  bool executable_abspath_found = false; // Absolute path to executable found
+  bool sys_config_found = false;         // avrdude.conf file found
+  const char *errstr;           // For str_int() error checking
+  int baudrate;                 // Override default programmer baud rate
+  int touch_1200bps;            // Touch serial port prior to programming
+  double bitclock;              // Specify programmer bit clock (JTAG ICE)
+  int ispdelay;                 // Specify the delay for ISP clock
+  int is_open;                  // Device open succeeded
+  char *logfile;                // Use logfile rather than stderr for diagnostics
+  const char *server;           // Unix-domain socket for -S server mode
+  enum updateflags uflags = UF_AUTO_ERASE | UF_VERIFY;  // Flags for do_op()
+
+  init_cx(NULL);
+
+#ifdef _MSC_VER
+  _set_printf_count_output(1);
+#endif
+
+  // Set line buffering for file descriptors so we see stdout and stderr properly interleaved
+  setvbuf(stdout, (char *) NULL, _IOLBF, 0);
+  setvbuf(stderr, (char *) NULL, _IOLBF, 0);
+
+  sys_config[0] = '\0';
+
+  progname = strrchr(argv[0], '/');
+
+#if defined (WIN32)
+  // Take care of backslash as dir sep in W32
+  if(!progname)
+    progname = strrchr(argv[0], '\\');
+#endif                          // WIN32
+
+  if(progname)
+    progname++;
+  else
+    progname = argv[0];
+
+  // Remove trailing .exe
+  if(str_ends(progname, ".exe")) {
+    progname = mmt_strdup(progname);    // Don't write to argv[0]
+    progname[strlen(progname) - 4] = 0;
+  }
+
+  avrdude_conf_version = "";
+
+  default_programmer = "";
+  default_parallel = "";
+  default_serial = "";
+  default_spi = "";
+  default_baudrate = 0;
+  default_bitclock = 0.0;
+  default_linuxgpio = "";
+  allow_subshells = 0;
+
+  init_config();
+
+  atexit(cleanup_main);
+
+  updates = lcreat(NULL, 0);
+  if(updates == NULL) {
+    pmsg_error("cannot initialize updater list\n");
+    exit(1);
+  }
+
+  extended_params = lcreat(NULL, 0);
+  if(extended_params == NULL) {
+    pmsg_error("cannot initialize extended parameter list\n");
+    exit(1);
+  }
+
+  additional_config_files = lcreat(NULL, 0);
+  if(additional_config_files == NULL) {
+    pmsg_error("cannot initialize additional config files list\n");
+    exit(1);
+  }
+
+  job_args = lcreat(NULL, 0);
+  gang_targets = lcreat(NULL, 0);
+
+  partdesc = NULL;
+  port = NULL;
+  erase = 0;
+  calibrate = 0;
+  no_avrduderc = 0;
+  p = NULL;
+  ovsigck = 0;
+  quell_progress = 0;
+  exitspecs = NULL;
+  pgm = NULL;
+  pgmid = "";
+  explicit_c = 0;
+  explicit_e = 0;
+  verbose = 0;
+  baudrate = 0;
+  touch_1200bps = 0;
+  bitclock = 0.0;
+  ispdelay = 0;
+  is_open = 0;
+  logfile = NULL;
+  server = NULL;
+
+  if(argc == 1) {               // No arguments?
+    usage();
+    return 0;
+  }
+
+  // Determine the location of personal configuration file
+
+#if defined(WIN32)
+  win_set_path(usr_config, sizeof usr_config, USER_CONF_FILE);
+#else
+  usr_config[0] = 0;
+  if(!concatpath(usr_config, getenv("XDG_CONFIG_HOME"), XDG_USER_CONF_FILE, sizeof usr_config))
+    concatpath(usr_config, getenv("HOME"), ".config/" XDG_USER_CONF_FILE, sizeof usr_config);
+  if(stat(usr_config, &sb) < 0 || (sb.st_mode & S_IFREG) == 0)
+    concatpath(usr_config, getenv("HOME"), USER_CONF_FILE, sizeof usr_config);
+#endif
+
+  // Process command line arguments
+  const char *optstring = "?Ab:B:c:C:dDeE:FG:i:l:LnNp:OP:qrS:tT:U:vVx:";
+
+  while((ch = getopt(argc, argv, optstring)) != -1) {
+    if(!strchr("CNlLS?", ch)) { // Record job options for a -S client
+      ladd(job_args, mmt_sprintf("-%c", ch));
+      if(strchr(optstring, ch) && strchr(optstring, ch)[1] == ':')
+        ladd(job_args, mmt_strdup(optarg));
+    }
+    switch(ch) {
+    case 'b':                  // Override default programmer baud rate
       baudrate = str_int(optarg, STR_INT32, &errstr);
       if(errstr) {
         pmsg_error("invalid baud rate %s specified: %s\n", optarg, errstr);
@@ -825,25 +1197,8 @@ int main(int argc, char *argv[]) {
       break;
 
     case 'B':                  // Specify bit clock period
-      bitclock = strtod(optarg, &e);
-      if((e == optarg) || bitclock <= 0.0) {
-        pmsg_error("invalid bit clock period %s\n", optarg);
+      if((bitclock = parse_bitclock(optarg)) <= 0.0)
         exit(1);
-      }
-      while(*e && isascii(*e & 0xff) && isspace(*e & 0xff))
-        e++;
-      if(*e == 0 || str_caseeq(e, "us"))        // us is optional and the default
-        ;
-      else if(str_caseeq(e, "m") || str_caseeq(e, "mhz"))
-        bitclock = 1/bitclock;
-      else if(str_caseeq(e, "k") || str_caseeq(e, "khz"))
-        bitclock = 1e3/bitclock;
-      else if(str_caseeq(e, "hz"))
-        bitclock = 1e6/bitclock;
-      else {
-        pmsg_error("invalid bit clock unit %s\n", e);
-        exit(1);
-      }
       break;
 
     case 'i':                  // Specify isp clock delay
@@ -880,6 +1235,14 @@ int main(int argc, char *argv[]) {
       cx->avr_disableffopt = 1;
       break;
 
+    case 'd':                  // Differential programming
+      cx->avr_diffprog = 1;
+      break;
+
+    case 'L':                  // Low-latency serial port mode
+      cx->ser_lowlat = 1;
+      break;
+
     case 'e':                  // Perform a chip erase
       erase = 1;
       explicit_e = 1;
@@ -926,6 +1289,14 @@ int main(int argc, char *argv[]) {
       touch_1200bps++;
       break;
 
+    case 'S':                  // Serve jobs on a Unix-domain socket
+      server = optarg;
+      break;
+
+    case 'G':                  // Gang programming of several targets
+      ladd(gang_targets, optarg);
+      break;
+
     case 't':                  // Enter terminal mode
       ladd(updates, cmd_update("interactive terminal"));
       break;
@@ -978,6 +1349,9 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if(server && lsize(updates))  // Hand the job to a running server
+    exit(avrdude_client(server, job_args));
+
   msg_debug("$ ");              // Record command line
   for(int i = 0; i < argc; i++)
     msg_debug("%s%c", str_ccsharg(argv[i]), i == argc - 1? '\n': ' ');
@@ -1074,769 +1448,495 @@ int main(int argc, char *argv[]) {
       }
     }
   }
-  // Debug output
-  msg_trace2("sys_config = %s\n", sys_config);
-  msg_trace2("sys_config_found = %s\n", sys_config_found? "true": "false");
-  msg_trace2("\n");
-
-  if(quell_progress == 0)
-    terminal_setup_update_progress();
-
-  // Print out an identifying string so folks can tell what version they are running
-  pmsg_notice("%s version %s\n", progname, AVRDUDE_FULL_VERSION);
-  pmsg_notice("Copyright see https://github.com/avrdudes/avrdude/blob/main/AUTHORS\n\n");
-
-  if(*sys_config) {
-    char *real_sys_config = realpath(sys_config, NULL);
-
-    if(real_sys_config) {
-      pmsg_notice("system wide configuration file is %s\n", real_sys_config);
-    } else
-      pmsg_warning("cannot determine realpath() of config file %s: %s\n", sys_config, strerror(errno));
-
-    rc = read_config(real_sys_config);
-    if(rc) {
-      pmsg_error("unable to process system wide configuration file %s\n", real_sys_config);
-      exit(1);
-    }
-    mmt_free(real_sys_config);
-  }
-
-  if(usr_config[0] != 0 && !no_avrduderc) {
-    int ok = (rc = stat(usr_config, &sb)) >= 0 && (sb.st_mode & S_IFREG);
-
-    pmsg_notice("user configuration file %s%s%s\n", ok? "is ": "", usr_config,
-      rc < 0? " does not exist": !(sb.st_mode & S_IFREG)? " is not a regular file, skipping": "");
-
-    if(ok) {
-      rc = read_config(usr_config);
-      if(rc) {
-        pmsg_error("unable to process user configuration file %s\n", usr_config);
-        exit(1);
-      }
-    }
-  }
-
-  if(!str_eq(avrdude_conf_version, AVRDUDE_FULL_VERSION)) {
-    pmsg_warning("system wide configuration file version (%s)\n", avrdude_conf_version);
-    imsg_warning("does not match Avrdude build version (%s)\n", AVRDUDE_FULL_VERSION);
-  }
-
-  if(lsize(additional_config_files) > 0) {
-    LNODEID ln1;
-    const char *p = NULL;
-
-    for(ln1 = lfirst(additional_config_files); ln1; ln1 = lnext(ln1)) {
-      p = ldata(ln1);
-      pmsg_notice("additional configuration file is %s\n", p);
-
-      rc = read_config(p);
-      if(rc) {
-        pmsg_error("unable to process additional configuration file %s\n", p);
-        exit(1);
-      }
-    }
-  }
-
-  // Sort memories of all parts in canonical order
-  for(LNODEID ln1 = lfirst(part_list); ln1; ln1 = lnext(ln1))
-    if((p = ldata(ln1))->mem)
-      lsort(p->mem, avr_mem_cmp);
-
-  // Set bitclock from configuration files unless changed by command line
-  if(default_bitclock > 0 && bitclock == 0.0) {
-    bitclock = default_bitclock;
-  }
-
-  if(!(pgmid && *pgmid) && *default_programmer)
-    pgmid = cache_string(default_programmer);
-
-  // Developer options to print parts and/or programmer entries of avrdude.conf
-  int dev_opt_c = dev_opt(pgmid);       // -c <wildcard>/[duASsrtiBUPTIJWHQ]
-  int dev_opt_p = dev_opt(partdesc);    // -p <wildcard>/[cdoASsrw*tiBUPTIJWHQ]
-
-  if(dev_opt_c || dev_opt_p) {  // See -c/h and or -p/h
-    dev_output_pgm_part(dev_opt_c, pgmid, dev_opt_p, partdesc);
-    exit(0);
-  }
-
-  PROGRAMMER *dry = locate_programmer(programmers, "dryrun");
-
-  for(LNODEID ln1 = lfirst(part_list); ln1; ln1 = lnext(ln1)) {
-    AVRPART *p = ldata(ln1);
-
-    for(LNODEID ln2 = lfirst(programmers); ln2; ln2 = lnext(ln2)) {
-      PROGRAMMER *pgm = ldata(ln2);
-
-      if(!is_programmer(pgm))
-        continue;
-      const char *pnam = pgm->id? ldata(lfirst(pgm->id)): "???";
-      int pm = pgm->prog_modes & p->prog_modes;
-
-      if((pm & (pm - 1)) && !str_eq(pnam, "dryrun") && !(dry && pgm->initpgm == dry->initpgm))
-        pmsg_warning("%s and %s share multiple modes (%s)\n", pnam, p->desc, avr_prog_modes(pm));
-    }
-  }
-
-  if(port) {
-    if(str_eq(port, "?s")) {
-      list_available_serialports(programmers);
-      exit(0);
-    } else if(str_eq(port, "?sa")) {
-      lmsg_error("Valid serial adapters are:\n");
-      list_serialadapters(stderr, "  ", programmers);
-      exit(0);
-    }
-  }
-
-  if(partdesc) {
-    if(str_eq(partdesc, "?")) {
-      if(pgmid && *pgmid && explicit_c) {
-        PROGRAMMER *pgm = locate_programmer_starts_set(programmers, pgmid, &pgmid, NULL);
-
-        if(!pgm || !is_programmer(pgm)) {
-          programmer_not_found(pgmid, pgm, NULL);
-          exit(1);
-        }
-        msg_error("\nValid parts for programmer %s are:\n", pgmid);
-        list_parts(stderr, "  ", part_list, pgm->prog_modes);
-      } else {
-        msg_error("\nValid parts are:\n");
-        list_parts(stderr, "  ", part_list, ~0);
-      }
-      msg_error("\n");
-      exit(1);
-    }
-  }
-
-  if(pgmid) {
-    if(str_eq(pgmid, "?")) {
-      if(partdesc && *partdesc) {
-        AVRPART *p = locate_part(part_list, partdesc);
-
-        if(!p) {
-          part_not_found(partdesc);
-          exit(1);
-        }
-        msg_error("\nValid programmers for part %s are:\n", p->desc);
-        list_programmers(stderr, "  ", programmers, p->prog_modes);
-      } else {
-        msg_error("\nValid programmers are:\n");
-        list_programmers(stderr, "  ", programmers, ~0);
-      }
-      msg_error("\n");
-      exit(1);
-    }
-
-    if(str_eq(pgmid, "?type")) {
-      msg_error("\nValid programmer types are:\n");
-      list_programmer_types(stderr, "  ");
-      msg_error("\n");
-      exit(1);
-    }
-  }
-
-  msg_notice("\n");
-
-  if(!pgmid || !*pgmid) {
-    programmer_not_found(NULL, NULL, NULL);
-    exit(1);
-  }
-
-  p = partdesc && *partdesc? locate_part(part_list, partdesc): NULL;
-  pgm = locate_programmer_starts_set(programmers, pgmid, &pgmid, p);
-  if(pgm == NULL || !is_programmer(pgm)) {
-    programmer_not_found(pgmid, pgm, p);
-    exit(1);
-  }
-
-  if(p && !(p->prog_modes & pgm->prog_modes)) {
-    pmsg_error("-c %s cannot program %s for lack of a common programming mode\n", pgmid, p->desc);
-    if(!ovsigck) {
-      imsg_error("use -F to override this check\n");
-      exit(1);
-    }
-  }
-
-  if(pgm->initpgm) {
-    pgm->initpgm(pgm);
-  } else {
-    msg_error("\n");
-    pmsg_error("cannot initialize the programmer\n\n");
-    exit(1);
-  }
-
-  if(pgm->setup) {
-    pgm->setup(pgm);
-  }
-  if(pgm->teardown) {
-    atexit(exithook);
-  }
-
-  if(lsize(extended_params) > 0) {
-    if(pgm->parseextparams == NULL) {
-      for(LNODEID ln = lfirst(extended_params); ln; ln = lnext(ln)) {
-        const char *extended_param = ldata(ln);
-
-        if(str_eq(extended_param, "help")) {
-          msg_error("%s -c %s extended options:\n", progname, pgmid);
-          msg_error("  -x help  Show this help menu and exit\n");
-          exit(0);
-        } else
-          pmsg_error("programmer does not support extended parameter -x %s, option ignored\n", extended_param);
-      }
-    } else {
-      int rc = pgm->parseextparams(pgm, extended_params);
-
-      if(rc == LIBAVRDUDE_EXIT)
-        exit(0);
-      if(rc < 0) {
-        pmsg_error("unable to parse list of -x parameters\n");
-        exit(1);
-      }
-    }
-  }
+  // Debug output
+  msg_trace2("sys_config = %s\n", sys_config);
+  msg_trace2("sys_config_found = %s\n", sys_config_found? "true": "false");
+  msg_trace2("\n");
 
-  if(port == NULL) {
-    switch(pgm->conntype) {
-    case CONNTYPE_PARALLEL:
-      port = mmt_strdup(default_parallel);
-      break;
+  if(quell_progress == 0)
+    terminal_setup_update_progress();
 
-    case CONNTYPE_SERIAL:
-      port = mmt_strdup(default_serial);
-      break;
+  // Print out an identifying string so folks can tell what version they are running
+  pmsg_notice("%s version %s\n", progname, AVRDUDE_FULL_VERSION);
+  pmsg_notice("Copyright see https://github.com/avrdudes/avrdude/blob/main/AUTHORS\n\n");
 
-    case CONNTYPE_USB:
-      port = mmt_strdup(DEFAULT_USB);
-      break;
+  // Optional binary cache of the parsed configuration files, see confcache.c
+  const char *conf_cache = getenv("AVRDUDE_CONF_CACHE");
+  LISTID cfg_files = lcreat(NULL, 0);
+  int cached = 0;
+
+  if(conf_cache && *conf_cache) {
+    if(*sys_config)
+      ladd(cfg_files, sys_config);
+    if(usr_config[0] != 0 && !no_avrduderc && stat(usr_config, &sb) >= 0 && (sb.st_mode & S_IFREG))
+      ladd(cfg_files, usr_config);
+    for(LNODEID ln1 = lfirst(additional_config_files); ln1; ln1 = lnext(ln1))
+      ladd(cfg_files, ldata(ln1));
+    cached = cfg_cache_load(conf_cache, cfg_files) == 0;
+  } else
+    conf_cache = NULL;
 
-    case CONNTYPE_SPI:
+  if(*sys_config) {
+    char *real_sys_config = realpath(sys_config, NULL);
 
-#ifdef HAVE_LINUXSPI
-      port = mmt_strdup(*default_spi? default_spi: "unknown");
-#else
-      port = mmt_strdup("unknown");
-#endif
+    if(real_sys_config) {
+      pmsg_notice("system wide configuration file is %s\n", real_sys_config);
+    } else
+      pmsg_warning("cannot determine realpath() of config file %s: %s\n", sys_config, strerror(errno));
 
-      break;
+    rc = cached? 0: read_config(real_sys_config);
+    if(rc) {
+      pmsg_error("unable to process system wide configuration file %s\n", real_sys_config);
+      exit(1);
+    }
+    mmt_free(real_sys_config);
+  }
 
-    case CONNTYPE_LINUXGPIO:
-      port = mmt_strdup(default_linuxgpio);
-      break;
+  if(usr_config[0] != 0 && !no_avrduderc) {
+    int ok = (rc = stat(usr_config, &sb)) >= 0 && (sb.st_mode & S_IFREG);
 
-    default:
-      port = mmt_strdup("unknown");
-      break;
+    pmsg_notice("user configuration file %s%s%s\n", ok? "is ": "", usr_config,
+      rc < 0? " does not exist": !(sb.st_mode & S_IFREG)? " is not a regular file, skipping": "");
 
+    if(ok) {
+      rc = cached? 0: read_config(usr_config);
+      if(rc) {
+        pmsg_error("unable to process user configuration file %s\n", usr_config);
+        exit(1);
+      }
     }
   }
 
-  int is_dryrun = str_eq(pgm->type, "dryrun") || (dry && pgm->initpgm == dry->initpgm);
-
-  if((port[0] == 0 || str_eq(port, "unknown")) && !is_dryrun) {
-    msg_error("\n");
-    pmsg_error("no port has been specified on the command line or in the config file;\n");
-    imsg_error("specify a port using the -P option and try again\n");
-    exit(1);
+  if(!str_eq(avrdude_conf_version, AVRDUDE_FULL_VERSION)) {
+    pmsg_warning("system wide configuration file version (%s)\n", avrdude_conf_version);
+    imsg_warning("does not match Avrdude build version (%s)\n", AVRDUDE_FULL_VERSION);
   }
 
-  /*
-   * Divide a serialadapter port string into tokens separated by colons.
-   * There are two ways such a port string can be presented:
-   *   1) -P <serialadapter>[:<sernum>]
-   *   2) -P usb:<usbvid>:<usbpid>[:<sernum>]
-   * In either case the serial number is optional. The USB vendor and
-   * product ids are hexadecimal numbers.
-   */
-  bool print_ports = true;
-  SERIALADAPTER *ser = NULL;
-
-  if(pgm->conntype == CONNTYPE_SERIAL) {
-    char *portdup = mmt_strdup(port);
-    char *port_tok[4], *tok = portdup;
+  if(lsize(additional_config_files) > 0) {
+    LNODEID ln1;
+    const char *p = NULL;
 
-    for(int t = 0, maxt = str_starts(portdup, DEFAULT_USB ":")? 4: 2; t < 4; t++) {
-      char *save = tok && t < maxt? tok: "";
+    for(ln1 = lfirst(additional_config_files); ln1; ln1 = lnext(ln1)) {
+      p = ldata(ln1);
+      pmsg_notice("additional configuration file is %s\n", p);
 
-      if(t < maxt - 1 && tok && (tok = strchr(tok, ':')))
-        *tok++ = 0;
-      port_tok[t] = mmt_strdup(save);
+      rc = cached? 0: read_config(p);
+      if(rc) {
+        pmsg_error("unable to process additional configuration file %s\n", p);
+        exit(1);
+      }
     }
-    mmt_free(portdup);
+  }
 
-    // Use libserialport to find the actual serial port
-    ser = locate_programmer(programmers, port_tok[0]);
-    if(is_serialadapter(ser)) {
+  // Sort memories of all parts in canonical order (cached parts are already sorted)
+  if(!cached) {
+    for(LNODEID ln1 = lfirst(part_list); ln1; ln1 = lnext(ln1))
+      if((p = ldata(ln1))->mem)
+        lsort(p->mem, avr_mem_cmp);
+    if(conf_cache)
+      cfg_cache_save(conf_cache, cfg_files);
+  }
+  ldestroy(cfg_files);
+  index_avrparts(part_list);
+  index_programmers(programmers);
 
-#ifdef HAVE_LIBSERIALPORT
-      int rv = setport_from_serialadapter(&port, ser, port_tok[1]);
+  // Set bitclock from configuration files unless changed by command line
+  if(default_bitclock > 0 && bitclock == 0.0) {
+    bitclock = default_bitclock;
+  }
 
-      if(rv == -1) {
-        pmsg_warning("serial adapter %s", port_tok[0]);
-        if(port_tok[1][0])
-          msg_warning(" with serial number %s", port_tok[1]);
-        else if(ser->usbsn && ser->usbsn[0])
-          msg_warning(" with serial number %s", ser->usbsn);
-        msg_warning(" not connected to host\n");
-      } else if(rv == -2)
-        print_ports = false;
-      if(rv)
-        ser = NULL;
-#endif
-    } else if(str_eq(port_tok[0], DEFAULT_USB)) {
-      // Port or usb:[vid]:[pid]
-      int vid, pid;
+  if(!(pgmid && *pgmid) && *default_programmer)
+    pgmid = cache_string(default_programmer);
 
-      if(sscanf(port_tok[1], "%x", &vid) > 0 && sscanf(port_tok[2], "%x", &pid) > 0) {
-        int rv = setport_from_vid_pid(&port, vid, pid, port_tok[3]);
+  // Developer options to print parts and/or programmer entries of avrdude.conf
+  int dev_opt_c = dev_opt(pgmid);       // -c <wildcard>/[duASsrtiBUPTIJWHQ]
+  int dev_opt_p = dev_opt(partdesc);    // -p <wildcard>/[cdoASsrw*tiBUPTIJWHQ]
 
-        if(rv == -1) {
-          if(port_tok[3][0])
-            pmsg_warning("serial adapter with USB VID %s and PID %s and serial number %s not connected\n", port_tok[1],
-              port_tok[2], port_tok[3]);
-          else
-            pmsg_warning("serial adapter with USB VID %s and PID %s not connected\n", port_tok[1], port_tok[2]);
-        } else if(rv == -2)
-          print_ports = false;
-      }
-    }
-    for(int i = 0; i < 4; i++)
-      mmt_free(port_tok[i]);
-    if(touch_1200bps && touch_serialport(&port, 1200, touch_1200bps) < 0)
-      goto skipopen;
+  if(dev_opt_c || dev_opt_p) {  // See -c/h and or -p/h
+    dev_output_pgm_part(dev_opt_c, pgmid, dev_opt_p, partdesc);
+    exit(0);
   }
 
-  // Open the programmer
-  if(verbose > 0) {
-    if(!is_dryrun)
-      pmsg_notice("using port            : %s\n", port);
-    pmsg_notice("using programmer      : %s\n", pgmid);
-  }
+  PROGRAMMER *dry = locate_programmer(programmers, "dryrun");
 
-  if(baudrate && !pgm->baudrate && !default_baudrate) { // None set
-    pmsg_notice("setting baud rate     : %d\n", baudrate);
-    pgm->baudrate = baudrate;
-  } else if(baudrate && ((pgm->baudrate && pgm->baudrate != baudrate)
-      || (!pgm->baudrate && default_baudrate != baudrate))) {
-    pmsg_notice("overriding baud rate  : %d\n", baudrate);
-    pgm->baudrate = baudrate;
-  } else if(!pgm->baudrate && default_baudrate) {
-    pmsg_notice("default baud rate     : %d\n", default_baudrate);
-    pgm->baudrate = default_baudrate;
-  } else if(ser && ser->baudrate) {
-    pmsg_notice("serial baud rate      : %d\n", ser->baudrate);
-    pgm->baudrate = ser->baudrate;
-  } else if(pgm->baudrate != 0)
-    pmsg_notice("programmer baud rate  : %d\n", pgm->baudrate);
+  for(LNODEID ln1 = lfirst(part_list); ln1; ln1 = lnext(ln1)) {
+    AVRPART *p = ldata(ln1);
 
-  if(bitclock != 0.0) {
-    pmsg_notice("setting bit clk period: %.1f us\n", bitclock);
-    pgm->bitclock = bitclock*1e-6;
-  }
+    for(LNODEID ln2 = lfirst(programmers); ln2; ln2 = lnext(ln2)) {
+      PROGRAMMER *pgm = ldata(ln2);
 
-  if(ispdelay != 0) {
-    pmsg_notice("setting ISP clk delay : %3i us\n", ispdelay);
-    pgm->ispdelay = ispdelay;
-  }
+      if(!is_programmer(pgm))
+        continue;
+      const char *pnam = pgm->id? ldata(lfirst(pgm->id)): "???";
+      int pm = pgm->prog_modes & p->prog_modes;
 
-  rc = pgm->open(pgm, port);
-  if(rc < 0) {
-    if(rc == LIBAVRDUDE_EXIT) {
-      exitrc = 0;
-      goto main_exit;
+      if((pm & (pm - 1)) && !str_eq(pnam, "dryrun") && !(dry && pgm->initpgm == dry->initpgm))
+        pmsg_warning("%s and %s share multiple modes (%s)\n", pnam, p->desc, avr_prog_modes(pm));
     }
+  }
 
-    pmsg_error("unable to open port %s for programmer %s\n", port, pgmid);
-  skipopen:
-    if(print_ports && pgm->conntype == CONNTYPE_SERIAL) {
+  if(server)                    // Keep config and programmers resident for jobs, see server.c
+    exit(avrdude_server(server));
 
-#ifdef HAVE_LIBSERIALPORT
+  if(port) {
+    if(str_eq(port, "?s")) {
       list_available_serialports(programmers);
-      if(touch_1200bps == 1)
-        pmsg_info("alternatively, try -rr or -rrr for longer delays\n");
-#endif
+      exit(0);
+    } else if(str_eq(port, "?sa")) {
+      lmsg_error("Valid serial adapters are:\n");
+      list_serialadapters(stderr, "  ", programmers);
+      exit(0);
     }
-    exitrc = 1;
-    pgm->ppidata = 0;           // Clear all bits at exit
-    goto main_exit;
   }
-  is_open = 1;
 
-  if(partdesc == NULL) {
-    part_not_found(NULL);
-    exitrc = 1;
-    goto main_exit;
-  }
+  if(partdesc) {
+    if(str_eq(partdesc, "?")) {
+      if(pgmid && *pgmid && explicit_c) {
+        PROGRAMMER *pgm = locate_programmer_starts_set(programmers, pgmid, &pgmid, NULL);
 
-  p = locate_part(part_list, partdesc);
-  if(p == NULL) {
-    part_not_found(partdesc);
-    exitrc = 1;
-    goto main_exit;
+        if(!pgm || !is_programmer(pgm)) {
+          programmer_not_found(pgmid, pgm, NULL);
+          exit(1);
+        }
+        msg_error("\nValid parts for programmer %s are:\n", pgmid);
+        list_parts(stderr, "  ", part_list, pgm->prog_modes);
+      } else {
+        msg_error("\nValid parts are:\n");
+        list_parts(stderr, "  ", part_list, ~0);
+      }
+      msg_error("\n");
+      exit(1);
+    }
   }
 
-  if(exitspecs != NULL) {
-    if(pgm->parseexitspecs == NULL) {
-      pmsg_warning("-E option not supported by this programmer type\n");
-      exitspecs = NULL;
-    } else {
-      int rc = pgm->parseexitspecs(pgm, exitspecs);
+  if(pgmid) {
+    if(str_eq(pgmid, "?")) {
+      if(partdesc && *partdesc) {
+        AVRPART *p = locate_part(part_list, partdesc);
 
-      if(rc == LIBAVRDUDE_EXIT)
-        exit(0);
-      if(rc < 0) {
-        pmsg_error("unable to parse list of -E parameters\n");
-        exit(1);
+        if(!p) {
+          part_not_found(partdesc);
+          exit(1);
+        }
+        msg_error("\nValid programmers for part %s are:\n", p->desc);
+        list_programmers(stderr, "  ", programmers, p->prog_modes);
+      } else {
+        msg_error("\nValid programmers are:\n");
+        list_programmers(stderr, "  ", programmers, ~0);
       }
+      msg_error("\n");
+      exit(1);
     }
-  }
-
-  if(avr_initmem(p) != 0) {
-    msg_error("\n");
-    pmsg_error("unable to initialize memories\n");
-    exitrc = 1;
-    goto main_exit;
-  }
 
-  if(verbose > 0) {
-    if((str_eq(pgm->type, "avr910"))) {
-      imsg_notice("avr910_devcode (avrdude.conf) : ");
-      if(p->avr910_devcode)
-        msg_notice("0x%02x\n", (uint8_t) p->avr910_devcode);
-      else
-        msg_notice("none\n");
+    if(str_eq(pgmid, "?type")) {
+      msg_error("\nValid programmer types are:\n");
+      list_programmer_types(stderr, "  ");
+      msg_error("\n");
+      exit(1);
     }
   }
 
-  /*
-   * Now that we know which part we are going to program, locate any -U options
-   * using the default memory region, fill in the device-dependent default
-   * region name ("application" for Xmega parts or "flash" otherwise) and check
-   * for basic problems with memory names or file access with a view to exit
-   * before programming.
-   */
-  int doexit = 0;
+  if(lsize(gang_targets)) {     // Program all targets concurrently, see gang.c
+    exitrc = avrdude_gang(gang_targets, updates, uflags, erase, explicit_e, baudrate, bitclock, ispdelay, exitspecs,
+      extended_params);
+    alloc_stats();
+    exit(exitrc);
+  }
 
-  for(ln = lfirst(updates); ln; ln = lnext(ln)) {
-    upd = ldata(ln);
-    if(upd->memstr == NULL && upd->cmdline == NULL) {
-      const char *mtype = is_pdi(p)? "application": "flash";
+  msg_notice("\n");
 
-      pmsg_notice2("defaulting memstr in -U %c:%s option to \"%s\"\n",
-        (upd->op == DEVICE_READ)? 'r': (upd->op == DEVICE_WRITE)? 'w': 'v', upd->filename, mtype);
-      upd->memstr = mmt_strdup(mtype);
-    }
-    rc = update_dryrun(p, upd);
-    if(rc && rc != LIBAVRDUDE_SOFTFAIL)
-      doexit = 1;
+  if(!pgmid || !*pgmid) {
+    programmer_not_found(NULL, NULL, NULL);
+    exit(1);
   }
-  if(doexit) {
-    exitrc = 1;
-    goto main_exit;
+
+  p = partdesc && *partdesc? locate_part(part_list, partdesc): NULL;
+  pgm = locate_programmer_starts_set(programmers, pgmid, &pgmid, p);
+  if(pgm == NULL || !is_programmer(pgm)) {
+    programmer_not_found(pgmid, pgm, p);
+    exit(1);
   }
 
-  if(calibrate) {
-    // Perform an RC oscillator calibration as outlined in appnote AVR053
-    if(pgm->perform_osccal == 0) {
-      pmsg_error("programmer does not support RC oscillator calibration\n");
-      exitrc = 1;
-    } else {
-      pmsg_notice2("performing RC oscillator calibration\n");
-      exitrc = pgm->perform_osccal(pgm);
+  if(p && !(p->prog_modes & pgm->prog_modes)) {
+    pmsg_error("-c %s cannot program %s for lack of a common programming mode\n", pgmid, p->desc);
+    if(!ovsigck) {
+      imsg_error("use -F to override this check\n");
+      exit(1);
     }
-    if(exitrc)
-      pmsg_error("RC calibration unsuccesful\n");
-    else
-      pmsg_notice("calibration value is now stored in EEPROM at address 0\n");
-
-    goto main_exit;
   }
 
-  if(verbose > 0 && quell_progress < 2) {
-    avr_display(stderr, pgm, p, progbuf, verbose);
-    msg_notice2("\n");
-    programmer_display(pgm, progbuf);
+  if(pgm->initpgm) {
+    pgm->initpgm(pgm);
+  } else {
+    msg_error("\n");
+    pmsg_error("cannot initialize the programmer\n\n");
+    exit(1);
   }
 
-  lmsg_info("");
-
-  exitrc = 0;
+  if(pgm->setup) {
+    pgm->setup(pgm);
+  }
+  if(pgm->teardown) {
+    atexit(exithook);
+  }
 
-  // Enable the programmer
-  pgm->enable(pgm, p);
+  if(lsize(extended_params) > 0) {
+    if(pgm->parseextparams == NULL) {
+      for(LNODEID ln = lfirst(extended_params); ln; ln = lnext(ln)) {
+        const char *extended_param = ldata(ln);
 
-  // Turn off all the status LEDs and reset LED states
-  led_set(pgm, LED_BEG);
+        if(str_eq(extended_param, "help")) {
+          msg_error("%s -c %s extended options:\n", progname, pgmid);
+          msg_error("  -x help  Show this help menu and exit\n");
+          exit(0);
+        } else
+          pmsg_error("programmer does not support extended parameter -x %s, option ignored\n", extended_param);
+      }
+    } else {
+      int rc = pgm->parseextparams(pgm, extended_params);
 
-  // Initialize the chip in preparation for accepting commands
-  init_ok = (rc = pgm->initialize(pgm, p)) >= 0;
-  if(!init_ok) {
-    if(rc == LIBAVRDUDE_EXIT) {
-      exitrc = 0;
-      goto main_exit;
+      if(rc == LIBAVRDUDE_EXIT)
+        exit(0);
+      if(rc < 0) {
+        pmsg_error("unable to parse list of -x parameters\n");
+        exit(1);
+      }
     }
-    pmsg_error("initialization failed  (rc = %d)\n", rc);
-    if(rc == -2)
-      imsg_error(" - the programmer ISP clock is too fast for the target\n");
-    else
-      imsg_error(" - double check the connections and try again\n");
+  }
 
-    if(str_eq(pgm->type, "serialupdi") || str_eq(pgm->type, "SERBB"))
-      imsg_error(" - use -b to set lower baud rate, e.g. -b %d\n", baudrate? baudrate/2: 57600);
-    else
-      imsg_error(" - use -B to set lower the bit clock frequency, e.g. -B 125kHz\n");
+  if(port == NULL)
+    port = default_port(pgm);
 
-    if(str_starts(pgm->type, "pickit5"))
-      imsg_error(" - reset the programmer by unplugging it");
+  int is_dryrun = str_eq(pgm->type, "dryrun") || (dry && pgm->initpgm == dry->initpgm);
 
-    if(!ovsigck) {
-      imsg_error(" - use -F to override this check\n");
-      exitrc = 1;
-      goto main_exit;
-    }
+  if((port[0] == 0 || str_eq(port, "unknown")) && !is_dryrun) {
+    msg_error("\n");
+    pmsg_error("no port has been specified on the command line or in the config file;\n");
+    imsg_error("specify a port using the -P option and try again\n");
+    exit(1);
   }
 
-  // Indicate programmer is ready
-  led_set(pgm, LED_RDY);
-
-  msg_notice("\n");
-  pmsg_notice("AVR device initialized and ready to accept instructions\n");
-
   /*
-   * Let's read the signature bytes to make sure there is at least a chip on
-   * the other end that is responding correctly.  A check against
-   * 0xffffff/0x000000 should ensure that the signature bytes are valid.
+   * Divide a serialadapter port string into tokens separated by colons.
+   * There are two ways such a port string can be presented:
+   *   1) -P <serialadapter>[:<sernum>]
+   *   2) -P usb:<usbvid>:<usbpid>[:<sernum>]
+   * In either case the serial number is optional. The USB vendor and
+   * product ids are hexadecimal numbers.
    */
-  if(!is_awire(p)) {            // Not AVR32
-    int attempt = 0;
-    int waittime = 10000;       // 10 ms
+  bool print_ports = true;
+  SERIALADAPTER *ser = NULL;
 
-  sig_again:
-    usleep(waittime);
-    if(init_ok) {
-      rc = avr_signature(pgm, p);
-      if(rc == LIBAVRDUDE_EXIT) {
-        exitrc = 0;
-        goto main_exit;
-      }
-      if(rc != LIBAVRDUDE_SUCCESS) {
-        if(rc == LIBAVRDUDE_SOFTFAIL && is_updi(p) && attempt < 1) {
-          attempt++;
-          if(pgm->read_sib) {
-            // Read SIB and compare FamilyID
-            char sib[AVR_SIBLEN + 1];
+  if(pgm->conntype == CONNTYPE_SERIAL) {
+    char *portdup = mmt_strdup(port);
+    char *port_tok[4], *tok = portdup;
 
-            pgm->read_sib(pgm, p, sib);
-            pmsg_notice("System Information Block: %s\n", sib);
-            if(strncmp(p->family_id, sib, AVR_FAMILYIDLEN)) {
-              pmsg_warning("received FamilyID: \"%.*s\"\n", AVR_FAMILYIDLEN, sib);
-              imsg_warning("expected FamilyID: \"%s\"\n", p->family_id);
-            } else
-              pmsg_notice("received FamilyID: \"%.*s\"\n", AVR_FAMILYIDLEN, sib);
-          }
-          if(erase) {
-            erase = 0;
-            if(uflags & UF_NOWRITE) {
-              pmsg_warning("conflicting -e and -n options specified, NOT erasing chip\n");
-            } else {
-              pmsg_notice("trying to unlock the chip\n");
-              exitrc = avr_unlock(pgm, p);
-              if(exitrc)
-                goto main_exit;
-              goto sig_again;
-            }
-          }
-          if(!ovsigck) {
-            pmsg_error("double check chip or use -F to override this check\n");
-            exitrc = 1;
-            goto main_exit;
-          }
-        }
-        pmsg_error("unable to read signature data (rc = %d)\n", rc);
-        if(!ovsigck) {
-          imsg_error("use -F to override this check\n");
-          exitrc = 1;
-          goto main_exit;
-        }
-      }
-    }
+    for(int t = 0, maxt = str_starts(portdup, DEFAULT_USB ":")? 4: 2; t < 4; t++) {
+      char *save = tok && t < maxt? tok: "";
 
-    sig = avr_locate_signature(p);
-    if(sig == NULL)
-      pmsg_warning("signature memory not defined for device %s\n", p->desc);
-    else {
-      const char *mculist = str_ccmcunames_signature(sig->buf, pgm->prog_modes);
+      if(t < maxt - 1 && tok && (tok = strchr(tok, ':')))
+        *tok++ = 0;
+      port_tok[t] = mmt_strdup(save);
+    }
+    mmt_free(portdup);
 
-      if(!*mculist) {           // No matching signatures?
-        if(is_updi(p)) {        // UPDI parts have different(!) offsets for signature
-          int k, n = 0;         // Gather list of known different signature offsets
-          unsigned myoff = sig->offset, offlist[10];
+    // Use libserialport to find the actual serial port
+    ser = locate_programmer(programmers, port_tok[0]);
+    if(is_serialadapter(ser)) {
 
-          for(LNODEID ln1 = lfirst(part_list); ln1; ln1 = lnext(ln1)) {
-            AVRMEM *m = avr_locate_signature(ldata(ln1));
+#ifdef HAVE_LIBSERIALPORT
+      int rv = setport_from_serialadapter(&port, ser, port_tok[1]);
 
-            if(m && m->offset != myoff) {
-              for(k = 0; k < n; k++)
-                if(m->offset == offlist[k])
-                  break;
-              if(k == n && k < (int) (sizeof offlist/sizeof *offlist))
-                offlist[n++] = m->offset;
-            }
-          }
-          // Now go through the list of other(!) sig offsets and try these
-          for(k = 0; k < n; k++) {
-            sig->offset = offlist[k];
-            if(avr_signature(pgm, p) >= 0)
-              if(*(mculist = str_ccmcunames_signature(sig->buf, pgm->prog_modes)))
-                break;
-          }
-          sig->offset = myoff;
-        }
-      }
+      if(rv == -1) {
+        pmsg_warning("serial adapter %s", port_tok[0]);
+        if(port_tok[1][0])
+          msg_warning(" with serial number %s", port_tok[1]);
+        else if(ser->usbsn && ser->usbsn[0])
+          msg_warning(" with serial number %s", ser->usbsn);
+        msg_warning(" not connected to host\n");
+      } else if(rv == -2)
+        print_ports = false;
+      if(rv)
+        ser = NULL;
+#endif
+    } else if(str_eq(port_tok[0], DEFAULT_USB)) {
+      // Port or usb:[vid]:[pid]
+      int vid, pid;
 
-      int ff = 1, zz = 1;
+      if(sscanf(port_tok[1], "%x", &vid) > 0 && sscanf(port_tok[2], "%x", &pid) > 0) {
+        int rv = setport_from_vid_pid(&port, vid, pid, port_tok[3]);
 
-      for(i = 0; i < sig->size; i++) {
-        if(sig->buf[i] != 0xff)
-          ff = 0;
-        if(sig->buf[i] != 0x00)
-          zz = 0;
+        if(rv == -1) {
+          if(port_tok[3][0])
+            pmsg_warning("serial adapter with USB VID %s and PID %s and serial number %s not connected\n", port_tok[1],
+              port_tok[2], port_tok[3]);
+          else
+            pmsg_warning("serial adapter with USB VID %s and PID %s not connected\n", port_tok[1], port_tok[2]);
+        } else if(rv == -2)
+          print_ports = false;
       }
-      bool signature_matches = sig->size >= 3 && !memcmp(sig->buf, p->signature, 3);
-      int showsig = !signature_matches || ff || zz || verbose > 0;
+    }
+    for(int i = 0; i < 4; i++)
+      mmt_free(port_tok[i]);
+    if(touch_1200bps && touch_serialport(&port, 1200, touch_1200bps) < 0)
+      goto skipopen;
+  }
 
-      if(showsig)
-        pmsg_info("device signature =%s", str_cchex(sig->buf, sig->size, 1));
-      if(*mculist && showsig)
-        msg_info(" (%s)", is_dryrun? p->desc: mculist);
+  // Open the programmer
+  if(verbose > 0) {
+    if(!is_dryrun)
+      pmsg_notice("using port            : %s\n", port);
+    pmsg_notice("using programmer      : %s\n", pgmid);
+  }
 
-      if(ff || zz) {            // All three bytes are 0xff or all three bytes are 0x00
-        if(++attempt < 3) {
-          waittime *= 5;
-          msg_info(" (retrying)\n");
-          goto sig_again;
-        }
-        msg_info("\n");
-        pmsg_error("invalid device signature\n");
-        if(!ovsigck) {
-          pmsg_error("expected signature for %s is%s\n", p->desc, str_cchex(p->signature, 3, 1));
-          imsg_error("  - double check connections and try again, or use -F to carry on regardless\n");
-          exitrc = 1;
-          goto main_exit;
-        }
-      } else if(showsig) {
-        msg_info("\n");
-      }
+  if(baudrate && !pgm->baudrate && !default_baudrate) { // None set
+    pmsg_notice("setting baud rate     : %d\n", baudrate);
+    pgm->baudrate = baudrate;
+  } else if(baudrate && ((pgm->baudrate && pgm->baudrate != baudrate)
+      || (!pgm->baudrate && default_baudrate != baudrate))) {
+    pmsg_notice("overriding baud rate  : %d\n", baudrate);
+    pgm->baudrate = baudrate;
+  } else if(!pgm->baudrate && default_baudrate) {
+    pmsg_notice("default baud rate     : %d\n", default_baudrate);
+    pgm->baudrate = default_baudrate;
+  } else if(ser && ser->baudrate) {
+    pmsg_notice("serial baud rate      : %d\n", ser->baudrate);
+    pgm->baudrate = ser->baudrate;
+  } else if(pgm->baudrate != 0)
+    pmsg_notice("programmer baud rate  : %d\n", pgm->baudrate);
 
-      if(!signature_matches) {
-        if(ovsigck) {
-          pmsg_warning("expected signature for %s is%s\n", p->desc, str_cchex(p->signature, 3, 1));
-        } else {
-          pmsg_error("expected signature for %s is%s\n", p->desc, str_cchex(p->signature, 3, 1));
-          imsg_error("  - double check chip or use -F to carry on regardless\n");
-          exitrc = 1;
-          goto main_exit;
-        }
-      }
-    }
+  if(bitclock != 0.0) {
+    pmsg_notice("setting bit clk period: %.1f us\n", bitclock);
+    pgm->bitclock = bitclock*1e-6;
   }
 
-  if(uflags & UF_AUTO_ERASE) {
-    if((p->prog_modes & (PM_PDI | PM_UPDI)) && pgm->page_erase && lsize(updates) > 0) {
-      for(ln = lfirst(updates); ln; ln = lnext(ln)) {
-        upd = ldata(ln);
-        if(upd->memstr && upd->op == DEVICE_WRITE && memlist_contains_flash(upd->memstr, p)) {
-          cx->avr_disableffopt = 1;     // Must write full flash file including trailing 0xff
-          pmsg_notice("NOT erasing chip as page erase will be used for new flash%s contents;\n",
-            avr_locate_bootrow(p)? "/bootrow": "");
-          imsg_notice("unprogrammed flash contents remains: use -e for an explicit chip-erase\n");
-          break;
-        }
-      }
-    } else {
-      uflags &= ~UF_AUTO_ERASE;
-      for(ln = lfirst(updates); ln; ln = lnext(ln)) {
-        upd = ldata(ln);
-        if(upd->cmdline && *str_ltrim(upd->cmdline) && str_starts("erase", str_ltrim(upd->cmdline)))
-          break;                // -T erase already erases the chip: no auto-erase needed
+  if(ispdelay != 0) {
+    pmsg_notice("setting ISP clk delay : %3i us\n", ispdelay);
+    pgm->ispdelay = ispdelay;
+  }
 
-        if(upd->cmdline || (upd->memstr &&      // Might be reading flash?
-            (upd->op == DEVICE_READ || upd->op == DEVICE_VERIFY) && memlist_contains_flash(upd->memstr, p)))
-          flashread = 1;
+  rc = pgm->open(pgm, port);
+  if(rc < 0) {
+    if(rc == LIBAVRDUDE_EXIT) {
+      exitrc = 0;
+      goto main_exit;
+    }
 
-        if(upd->memstr && upd->op == DEVICE_WRITE && memlist_contains_flash(upd->memstr, p)) {
-          if(flashread) {
-            pmsg_info("NOT auto-erasing chip as flash might need reading before writing to it\n");
-          } else {
-            erase = 1;
-            pmsg_notice("auto-erasing chip as flash memory needs programming (-U %s:w:...)\n", upd->memstr);
-            imsg_notice("specify the -D option to disable this feature\n");
-          }
-          break;
-        }
-      }
+    pmsg_error("unable to open port %s for programmer %s\n", port, pgmid);
+  skipopen:
+    if(print_ports && pgm->conntype == CONNTYPE_SERIAL) {
+
+#ifdef HAVE_LIBSERIALPORT
+      list_available_serialports(programmers);
+      if(touch_1200bps == 1)
+        pmsg_info("alternatively, try -rr or -rrr for longer delays\n");
+#endif
     }
+    exitrc = 1;
+    pgm->ppidata = 0;           // Clear all bits at exit
+    goto main_exit;
   }
+  is_open = 1;
 
-  if(init_ok && erase) {
-    /*
-     * Erase the chip's flash and eeprom memories, this is required before the
-     * chip can accept new programming
-     */
-    if(uflags & UF_NOWRITE) {
-      if(explicit_e)
-        pmsg_warning("conflicting -e and -n specified, NOT erasing chip\n");
-      else
-        pmsg_notice("-n specified, NOT erasing chip\n");
+  if(partdesc == NULL) {
+    part_not_found(NULL);
+    exitrc = 1;
+    goto main_exit;
+  }
+
+  p = locate_part(part_list, partdesc);
+  if(p == NULL) {
+    part_not_found(partdesc);
+    exitrc = 1;
+    goto main_exit;
+  }
+
+  if(exitspecs != NULL) {
+    if(pgm->parseexitspecs == NULL) {
+      pmsg_warning("-E option not supported by this programmer type\n");
+      exitspecs = NULL;
     } else {
-      exitrc = avr_chip_erase(pgm, p);
-      if(exitrc == LIBAVRDUDE_SOFTFAIL) {
-        pmsg_notice("delaying chip erase until first -U upload to flash\n");
-        ce_delayed = 1;
-        exitrc = 0;
-      } else if(exitrc) {
-        pmsg_error("chip erase failed\n");
-        goto main_exit;
-      } else
-        pmsg_notice("erased chip\n");
+      int rc = pgm->parseexitspecs(pgm, exitspecs);
+
+      if(rc == LIBAVRDUDE_EXIT)
+        exit(0);
+      if(rc < 0) {
+        pmsg_error("unable to parse list of -E parameters\n");
+        exit(1);
+      }
     }
   }
 
-  if(!init_ok && !ovsigck) {    // Bail out on failed initialisation unless -F was given
+  if(avr_initmem(p) != 0) {
+    msg_error("\n");
+    pmsg_error("unable to initialize memories\n");
     exitrc = 1;
     goto main_exit;
   }
 
-  int wrmem = 0, terminal = 0;
+  if(verbose > 0) {
+    if((str_eq(pgm->type, "avr910"))) {
+      imsg_notice("avr910_devcode (avrdude.conf) : ");
+      if(p->avr910_devcode)
+        msg_notice("0x%02x\n", (uint8_t) p->avr910_devcode);
+      else
+        msg_notice("none\n");
+    }
+  }
 
-  if(lsize(updates) <= 1)
-    uflags |= UF_NOHEADING;
-  for(ln = lfirst(updates); ln; ln = lnext(ln)) {
-    const AVRMEM *m;
+  /*
+   * Now that we know which part we are going to program, locate any -U options
+   * using the default memory region, fill in the device-dependent default
+   * region name ("application" for Xmega parts or "flash" otherwise) and check
+   * for basic problems with memory names or file access with a view to exit
+   * before programming.
+   */
+  int doexit = 0;
 
+  for(ln = lfirst(updates); ln; ln = lnext(ln)) {
     upd = ldata(ln);
-    if(upd->cmdline && wrmem) { // Invalidate cache if device was written to
-      wrmem = 0;
-      pgm->reset_cache(pgm, p);
-    } else if(!upd->cmdline) {  // Flush cache before any device memory access
-      pgm->flush_cache(pgm, p);
-      wrmem |= upd->op == DEVICE_WRITE;
+    if(upd->memstr == NULL && upd->cmdline == NULL) {
+      const char *mtype = is_pdi(p)? "application": "flash";
+
+      pmsg_notice2("defaulting memstr in -U %c:%s option to \"%s\"\n",
+        (upd->op == DEVICE_READ)? 'r': (upd->op == DEVICE_WRITE)? 'w': 'v', upd->filename, mtype);
+      upd->memstr = mmt_strdup(mtype);
     }
-    if((uflags & UF_NOWRITE) && upd->cmdline && !terminal++)
-      pmsg_warning("the terminal ignores option -n, that is, it writes to the device\n");
-    rc = do_op(pgm, p, upd, uflags);
-    if(rc && rc != LIBAVRDUDE_SOFTFAIL) {
+    rc = update_dryrun(p, upd);
+    if(rc && rc != LIBAVRDUDE_SOFTFAIL)
+      doexit = 1;
+  }
+  if(doexit) {
+    exitrc = 1;
+    goto main_exit;
+  }
+
+  if(calibrate) {
+    // Perform an RC oscillator calibration as outlined in appnote AVR053
+    if(pgm->perform_osccal == 0) {
+      pmsg_error("programmer does not support RC oscillator calibration\n");
       exitrc = 1;
-      break;
-    } else if(rc == 0 && upd->op == DEVICE_WRITE && (m = avr_locate_mem(p, upd->memstr)) && mem_is_in_flash(m))
-      ce_delayed = 0;           // Redeemed chip erase promise
+    } else {
+      pmsg_notice2("performing RC oscillator calibration\n");
+      exitrc = pgm->perform_osccal(pgm);
+    }
+    if(exitrc)
+      pmsg_error("RC calibration unsuccesful\n");
+    else
+      pmsg_notice("calibration value is now stored in EEPROM at address 0\n");
+
+    goto main_exit;
   }
-  pgm->flush_cache(pgm, p);
 
-  if(pgm->end_programming)
-    if(pgm->end_programming(pgm, p) < 0)
-      pmsg_error("could not end programming, aborting\n");
+  if(verbose > 0 && quell_progress < 2) {
+    avr_display(stderr, pgm, p, progbuf, verbose);
+    msg_notice2("\n");
+    programmer_display(pgm, progbuf);
+  }
+
+  lmsg_info("");
+
+  exitrc = process_updates(pgm, p, updates, uflags, erase, explicit_e, baudrate, is_dryrun);
 
 main_exit:
 
@@ -1869,5 +1969,7 @@ main_exit:
   msg_info("\n");
   pmsg_info("%s done.  Thank you.\n", progname);
 
-  return ce_delayed? 1: exitrc;
+  alloc_stats();
+
+  return exitrc;
 }
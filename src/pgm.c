@@ -100,6 +100,7 @@ void pgm_init_functions(PROGRAMMER *pgm) {
   pgm->read_sig_bytes = NULL;
   pgm->read_sib = NULL;
   pgm->read_chip_rev = NULL;
+  pgm->checksum = NULL;
   pgm->term_keep_alive = NULL;
   pgm->end_programming = NULL;
   pgm->print_parms = NULL;
@@ -302,6 +303,16 @@ PROGRAMMER *locate_programmer_starts_set(const LISTID programmers, const char *p
     return NULL;
 
   l = strlen(pgid);
+  if(programmers && programmers == cx->pgm_ixpgms && lsize(programmers) == cx->pgm_ixnpgms) {
+    Hash_entry *e = hash_get(cx->pgm_ixid, pgid, l);   // Exact match in index of all entries?
+
+    if(e && is_programmer(pgm = e->first) && (pgm->prog_modes & pmode)) {
+      if(setid)
+        *setid = e->key;
+      return pgm;
+    }
+  }
+
   matches = 0;
   matchp = NULL;
   for(LNODEID ln1 = lfirst(programmers); ln1; ln1 = lnext(ln1)) {
@@ -340,6 +351,14 @@ done:
 
 // Locate a programmer (or serial adapter) by full name and set the matching id
 PROGRAMMER *locate_programmer_set(const LISTID programmers, const char *configid, const char **setid) {
+  if(programmers && programmers == cx->pgm_ixpgms && lsize(programmers) == cx->pgm_ixnpgms) {
+    Hash_entry *e = configid? hash_get(cx->pgm_ixid, configid, strlen(configid)): NULL;
+
+    if(e && setid)
+      *setid = e->key;
+    return e? e->first: NULL;
+  }
+
   for(LNODEID ln1 = lfirst(programmers); ln1; ln1 = lnext(ln1)) {
     PROGRAMMER *p = ldata(ln1);
 
@@ -395,6 +414,38 @@ static int sort_programmer_compare(const PROGRAMMER *p1, const PROGRAMMER *p2) {
 // Sort the list of programmers given as "programmers"
 void sort_programmers(LISTID programmers) {
   lsort(programmers, (int (*)(void *, void *)) sort_programmer_compare);
+  if(programmers && programmers == cx->pgm_ixpgms)      // First match in list order may have changed
+    index_programmers(programmers);
+}
+
+/*
+ * Build a lookup table from id to the first entry in the list programmers
+ * with that id (irrespective of case) for locate_programmer_set() and for
+ * exact matches in locate_programmer_starts_set(). Call once all configuration
+ * files have been read; index_programmers(NULL) drops the table.
+ */
+void index_programmers(LISTID programmers) {
+  hash_free(cx->pgm_ixid);
+  cx->pgm_ixid = NULL;
+  cx->pgm_ixpgms = NULL;
+
+  if(!programmers)
+    return;
+
+  cx->pgm_ixpgms = programmers;
+  cx->pgm_ixnpgms = lsize(programmers);
+  cx->pgm_ixid = hash_new(1);
+  for(LNODEID ln1 = lfirst(programmers); ln1; ln1 = lnext(ln1)) {
+    PROGRAMMER *pgm = ldata(ln1);
+
+    for(LNODEID ln2 = lfirst(pgm->id); ln2; ln2 = lnext(ln2)) {
+      const char *id = (const char *) ldata(ln2);
+      Hash_entry *e = hash_put(cx->pgm_ixid, id, strlen(id));
+
+      if(!e->n++)
+        e->first = pgm;
+    }
+  }
 }
 
 // Soft assignment: some PROGRAMMER entries can be both programmers and serial adapters
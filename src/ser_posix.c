@@ -36,9 +36,14 @@
 #include <netdb.h>
 
 #include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
 #ifdef __APPLE__
 #include <IOKit/serial/ioss.h>
 #endif
@@ -46,8 +51,8 @@
 #include "avrdude.h"
 #include "libavrdude.h"
 
-long serial_recv_timeout = 5000;        // ms
-long serial_drain_timeout = 250;        // ms
+LIBAVRDUDE_TLS long serial_recv_timeout = 5000;        // ms
+LIBAVRDUDE_TLS long serial_drain_timeout = 250;        // ms
 
 struct baud_mapping {
   long baud;
@@ -253,6 +258,12 @@ static int ser_setparams(const union filedescriptor *fd, long baud, unsigned lon
   termios.c_iflag &= ~CNEW_RTSCTS;
 #endif                          // CRTSCTS
 
+  // In low-latency mode reads return what is there at once, the timing is up to poll()
+  if(cx->ser_lowlat) {
+    termios.c_cc[VMIN] = 0;
+    termios.c_cc[VTIME] = 0;
+  }
+
   rc = tcsetattr(fd->ifd, TCSANOW, &termios);
   if(rc < 0) {
     int ret = -errno;
@@ -372,6 +383,97 @@ static int ser_set_dtr_rts(const union filedescriptor *fdp, int is_on) {
   return 0;
 }
 
+// Ask the driver for low latency and shorten the latency timer of FTDI adapters
+static void ser_set_lowlat(const char *port, int fd) {
+#if defined(TIOCGSERIAL) && defined(TIOCSSERIAL) && defined(ASYNC_LOW_LATENCY)
+  struct serial_struct ss;
+
+  if(ioctl(fd, TIOCGSERIAL, &ss) < 0)
+    pmsg_notice2("%s(): cannot get serial info of %s: %s\n", __func__, port, strerror(errno));
+  else if(!(ss.flags & ASYNC_LOW_LATENCY)) {
+    ss.flags |= ASYNC_LOW_LATENCY;
+    if(ioctl(fd, TIOCSSERIAL, &ss) < 0)
+      pmsg_notice2("%s(): cannot set low latency for %s: %s\n", __func__, port, strerror(errno));
+  }
+#endif
+
+#ifdef __linux__
+  char *path = realpath(port, NULL);
+
+  if(path) {
+    const char *tty = strrchr(path, '/');
+    char *sysfs = mmt_sprintf("/sys/class/tty/%s/device/latency_timer", tty? tty + 1: path);
+    FILE *f = fopen(sysfs, "r");
+    int ms = 0;
+
+    if(f) {
+      if(fscanf(f, "%d", &ms) != 1)
+        ms = 0;
+      fclose(f);
+    }
+    if(ms > 1) {
+      if((f = fopen(sysfs, "w")) && fprintf(f, "1\n") > 0 && fclose(f) == 0) {
+        pmsg_notice2("%s(): latency timer of %s changed from %d ms to 1 ms\n", __func__, port, ms);
+        mmt_free(cx->ser_latency_file);
+        cx->ser_latency_file = sysfs;
+        cx->ser_latency_timer = ms;
+        sysfs = NULL;
+      } else {
+        pmsg_notice2("%s(): cannot change latency timer of %s: %s\n", __func__, port, strerror(errno));
+      }
+    }
+    mmt_free(sysfs);
+    free(path);
+  }
+#endif
+}
+
+static void ser_restore_latency(void) {
+  if(cx->ser_latency_file) {
+    FILE *f = fopen(cx->ser_latency_file, "w");
+
+    if(!f || fprintf(f, "%d\n", cx->ser_latency_timer) < 0)
+      pmsg_notice2("%s(): cannot restore %s: %s\n", __func__, cx->ser_latency_file, strerror(errno));
+    if(f)
+      fclose(f);
+    mmt_free(cx->ser_latency_file);
+    cx->ser_latency_file = NULL;
+  }
+}
+
+// Round-trip statistics of the port: time from a send to the first byte received thereafter
+static void ser_stats_reset(const char *port) {
+  mmt_free(cx->ser_port);
+  cx->ser_port = mmt_strdup(port);
+  cx->ser_sent_us = 0;
+  cx->ser_nrt = 0;
+  cx->ser_rtsum = cx->ser_rtmin = cx->ser_rtmax = 0;
+}
+
+static void ser_stats_received(void) {
+  if(cx->ser_sent_us) {
+    uint64_t us = avr_ustimestamp() - cx->ser_sent_us;
+
+    if(!cx->ser_nrt || us < cx->ser_rtmin)
+      cx->ser_rtmin = us;
+    if(us > cx->ser_rtmax)
+      cx->ser_rtmax = us;
+    cx->ser_rtsum += us;
+    cx->ser_nrt++;
+    cx->ser_sent_us = 0;
+  }
+}
+
+static void ser_stats_report(int display) {
+  if(display && cx->ser_nrt)
+    pmsg_notice("%s: %ld round trips, latency %.3f ms on average, %.3f ms min, %.3f ms max%s\n",
+      cx->ser_port? cx->ser_port: "serial port", cx->ser_nrt, cx->ser_rtsum/1000.0/cx->ser_nrt,
+      cx->ser_rtmin/1000.0, cx->ser_rtmax/1000.0, cx->ser_lowlat? " in low-latency mode": "");
+  mmt_free(cx->ser_port);
+  cx->ser_port = NULL;
+  cx->ser_nrt = 0;
+}
+
 static int ser_open(const char *port, union pinfo pinfo, union filedescriptor *fdp) {
   int rc;
   int fd;
@@ -380,6 +482,7 @@ static int ser_open(const char *port, union pinfo pinfo, union filedescriptor *f
    * If the port is of the form "net:<host>:<port>", then handle it as a TCP
    * connection to a terminal server.
    */
+  ser_stats_reset(port);
   if(str_starts(port, "net:")) {
     return net_open(port + strlen("net:"), fdp);
   }
@@ -400,6 +503,9 @@ static int ser_open(const char *port, union pinfo pinfo, union filedescriptor *f
     close(fd);
     return -1;
   }
+  if(cx->ser_lowlat)
+    ser_set_lowlat(port, fd);
+
   return 0;
 }
 
@@ -412,6 +518,8 @@ static void ser_close(union filedescriptor *fd) {
       pmsg_ext_error("cannot reset attributes for device: %s\n", strerror(errno));
     cx->ser_saved_original_termios = 0;
   }
+  ser_restore_latency();
+  ser_stats_report(1);
 
   close(fd->ifd);
 }
@@ -419,6 +527,8 @@ static void ser_close(union filedescriptor *fd) {
 // Close but don't restore attributes
 static void ser_rawclose(union filedescriptor *fd) {
   cx->ser_saved_original_termios = 0;
+  ser_restore_latency();
+  ser_stats_report(0);
   close(fd->ifd);
 }
 
@@ -437,10 +547,29 @@ static int ser_send(const union filedescriptor *fd, const unsigned char *buf, si
     buf += rc;
     len -= rc;
   }
+  if(!cx->ser_sent_us)
+    cx->ser_sent_us = avr_ustimestamp();
 
   return 0;
 }
 
+// Wait for input until the deadline (ms timestamp); return 1 if readable, 0 on timeout, -1 on error
+static int ser_poll(int fd, uint64_t deadline) {
+  struct pollfd pfd;
+  int rc;
+
+  do {
+    uint64_t now = avr_mstimestamp();
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    rc = poll(&pfd, 1, now < deadline? (int) (deadline - now): 0);
+  } while(rc == -1 && (errno == EINTR || errno == EAGAIN));
+
+  return rc;
+}
+
 static int ser_recv(const union filedescriptor *fd, unsigned char *buf, size_t buflen) {
   struct timeval timeout, to2;
   fd_set rfds;
@@ -448,35 +577,50 @@ static int ser_recv(const union filedescriptor *fd, unsigned char *buf, size_t b
   int rc;
   unsigned char *p = buf;
   size_t len = 0;
+  uint64_t deadline = avr_mstimestamp() + serial_recv_timeout;
 
   timeout.tv_sec = serial_recv_timeout/1000L;
   timeout.tv_usec = (serial_recv_timeout%1000L)*1000;
   to2 = timeout;
 
   while(len < buflen) {
-  reselect:
-    FD_ZERO(&rfds);
-    FD_SET(fd->ifd, &rfds);
-
-    nfds = select(fd->ifd + 1, &rfds, NULL, NULL, &to2);
-    if(nfds == 0) {
-      pmsg_notice2("%s(): programmer is not responding\n", __func__);
-      return -1;
-    } else if(nfds == -1) {
-      if(errno == EINTR || errno == EAGAIN) {
-        pmsg_warning("programmer is not responding, reselecting\n");
-        goto reselect;
-      } else {
-        pmsg_ext_error("select(): %s\n", strerror(errno));
+    if(cx->ser_lowlat) {
+      nfds = ser_poll(fd->ifd, deadline);
+      if(nfds == 0) {
+        pmsg_notice2("%s(): programmer is not responding\n", __func__);
+        return -1;
+      } else if(nfds == -1) {
+        pmsg_ext_error("poll(): %s\n", strerror(errno));
+        return -1;
+      }
+    } else {
+    reselect:
+      FD_ZERO(&rfds);
+      FD_SET(fd->ifd, &rfds);
+
+      nfds = select(fd->ifd + 1, &rfds, NULL, NULL, &to2);
+      if(nfds == 0) {
+        pmsg_notice2("%s(): programmer is not responding\n", __func__);
         return -1;
+      } else if(nfds == -1) {
+        if(errno == EINTR || errno == EAGAIN) {
+          pmsg_warning("programmer is not responding, reselecting\n");
+          goto reselect;
+        } else {
+          pmsg_ext_error("select(): %s\n", strerror(errno));
+          return -1;
+        }
       }
     }
 
-    rc = read(fd->ifd, p, buflen - len > 1024? 1024: buflen - len);
+    // Low-latency mode takes all there is in one read()
+    rc = read(fd->ifd, p, cx->ser_lowlat || buflen - len <= 1024? buflen - len: 1024);
     if(rc < 0) {
       pmsg_ext_error("unable to read: %s\n", strerror(errno));
       return -1;
     }
+    if(rc > 0)
+      ser_stats_received();
     p += rc;
     len += rc;
   }
@@ -492,7 +636,7 @@ static int ser_drain(const union filedescriptor *fd, int display) {
   fd_set rfds;
   int nfds;
   int rc;
-  unsigned char buf;
+  unsigned char buf[256];
 
   timeout.tv_sec = 0;
   timeout.tv_usec = serial_drain_timeout*1000L;
@@ -522,15 +666,18 @@ static int ser_drain(const union filedescriptor *fd, int display) {
       }
     }
 
-    rc = read(fd->ifd, &buf, 1);
+    // Discard all that has arrived at once rather than byte by byte
+    rc = read(fd->ifd, buf, sizeof buf);
     if(rc < 0) {
       pmsg_ext_error("unable to read: %s\n", strerror(errno));
       return -1;
     }
     if(display) {
-      msg_info("%02x ", buf);
+      for(int i = 0; i < rc; i++)
+        msg_info("%02x ", buf[i]);
     }
   }
+  cx->ser_sent_us = 0;          // Responses to earlier sends have gone
 
   return 0;
 }
@@ -547,5 +694,5 @@ struct serial_device serial_serdev = {
   .flags = SERDEV_FL_CANSETSPEED,
 };
 
-struct serial_device *serdev = &serial_serdev;
+LIBAVRDUDE_TLS struct serial_device *serdev = &serial_serdev;
 #endif                          // WIN32
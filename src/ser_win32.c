@@ -33,8 +33,8 @@
 #include "avrdude.h"
 #include "libavrdude.h"
 
-long serial_recv_timeout = 5000;        // ms
-long serial_drain_timeout = 250;        // ms
+LIBAVRDUDE_TLS long serial_recv_timeout = 5000;        // ms
+LIBAVRDUDE_TLS long serial_drain_timeout = 250;        // ms
 
 #define W32SERBUFSIZE 1024
 
@@ -583,5 +583,5 @@ struct serial_device serial_serdev = {
   .flags = SERDEV_FL_CANSETSPEED,
 };
 
-struct serial_device *serdev = &serial_serdev;
+LIBAVRDUDE_TLS struct serial_device *serdev = &serial_serdev;
 #endif                          // WIN32
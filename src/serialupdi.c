@@ -789,6 +789,14 @@ static int serialupdi_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const
     return -1;
   }
 
+  if((int) n_bytes > m->readsize && (mem_is_flash(m) || mem_is_eeprom(m))) {
+    int rc = updi_read_data_bulk(pgm, m->offset + addr, m->buf + addr, n_bytes);
+
+    if(rc < 0) {
+      pmsg_error("paged load operation failed\n");
+    }
+    return rc;
+  }
   if((int) n_bytes > m->readsize) {
     unsigned int read_offset = addr;
     int remaining_bytes = n_bytes;
@@ -821,6 +829,13 @@ static int serialupdi_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const
     pmsg_error("%s() called with implausibly high n_bytes = %u\n", __func__, n_bytes);
     return -1;
   }
+  if((int) n_bytes > m->page_size && mem_is_flash(m)) {
+    rc = updi_nvm_write_flash_pages(pgm, p, m->offset + addr, m->buf + addr, n_bytes, m->page_size);
+    if(rc < 0) {
+      pmsg_error("paged write operation failed\n");
+    }
+    return rc;
+  }
   if((int) n_bytes > m->page_size) {
     unsigned int write_offset = addr;
     int remaining_bytes = n_bytes;
@@ -1064,6 +1079,7 @@ void serialupdi_initpgm(PROGRAMMER *pgm) {
   pgm->read_sig_bytes = serialupdi_read_signature;
   pgm->read_sib = serialupdi_read_sib;
   pgm->paged_load = serialupdi_paged_load;
+  pgm->paged_burst = 32768;     // Paged routines loop over pages but reject n_bytes > 65535
   pgm->page_erase = serialupdi_page_erase;
   pgm->setup = serialupdi_setup;
   pgm->teardown = serialupdi_teardown;
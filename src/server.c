@@ -0,0 +1,796 @@
+/*
+ * avrdude - A Downloader/Uploader for AVR device programmers
+ * Copyright (C) 2026 The AVRDUDE authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Programming server for avrdude -S <socket>
+ *
+ * Keeps the parsed configuration and opened programmers resident and carries
+ * out one job after the other that clients send over a local Unix-domain
+ * socket, so that a test station only pays for the target-specific work of
+ * each board: the device initialisation, the signature check and the -U/-T
+ * updates. A job is a list of avrdude options; its programmer (-c, -P, -b,
+ * -B, -i, -x and -E) is opened on first use and kept open as a session for
+ * later jobs with the same options. A session that fails a job is closed, so
+ * that the next job starts afresh; a job for a different programmer on the
+ * same port closes the old session first.
+ *
+ * Requests are text lines; each answer is one line of JSON:
+ *
+ *   cwd <dir>      Directory against which relative file names of the job resolve
+ *   arg <arg>      Next command line argument of the job, eg, arg -U
+ *   run            Carry out the job of the preceding cwd and arg lines, then
+ *                  answer with its exit code, session reuse, timing, device
+ *                  signature and what the job printed to stdout and stderr
+ *                  {"rc": 0, "part": "ATmega328P", "programmer": "dryrun",
+ *                   "port": "usb", "reused": true, "jobs": 2, "open_secs": 0,
+ *                   "job_secs": 0.012, "signature": "1E950F", "stdout": "",
+ *                   "stderr": "..."}
+ *   status         List open sessions {"sessions": [{"programmer": ...}, ...]}
+ *   close          Close all sessions {"closed": <n>}
+ *   quit           Close all sessions and stop the server {"quit": true}
+ *
+ * A client can send any number of requests over the same connection; the
+ * server deals with one connection at a time. Job options -p, -c, -P, -b,
+ * -B, -i, -x, -E, -U, -T, -e, -D, -A, -d, -n, -V, -F, -v and -q have the
+ * same meaning as on the command line; -v and -q add to the verbosity of the
+ * server. The socket is created readable and writable by the owner only as
+ * jobs can read and write any file the server can.
+ *
+ * avrdude -S <socket> with -U or -T is the client: it sends its options, bar
+ * -C, -N, -l and -L, as a job to the server and reproduces the job's output
+ * and exit code as if it had carried out the job itself. Jobs cannot run the
+ * interactive terminal, so the server refuses jobs with -t.
+ */
+
+#include <ac_cfg.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if !defined(WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "avrdude.h"
+#include "libavrdude.h"
+
+#if !defined(WIN32)
+
+typedef struct {
+  PROGRAMMER *pgm;              // Opened programmer
+  char *pgmid, *port;           // Programmer id and port it was opened with
+  char *key;                    // Programmer, port and connection options
+  int is_dryrun;                // Whether the programmer is dryrun or derived from it
+  int njobs;                    // Number of jobs carried out so far
+} Session;
+
+typedef struct {
+  const char *partdesc, *pgmid, *port, *exitspecs;
+  int baudrate, ispdelay, erase, explicit_e, ovsigck, nverbose, nquell, disableffopt, diffprog;
+  double bitclock;
+  enum updateflags uflags;
+  LISTID xparams, updates;      // -x strings and UPDATE * of -U and -T
+} Job;
+
+static volatile sig_atomic_t srv_stop;
+
+static void srv_sighandler(int signo) {
+  srv_stop = 1;
+}
+
+// Return the contents of the temporary file f and close it; NULL if empty
+static char *slurp(FILE *f, size_t *lenp) {
+  char *ret = NULL;
+  long len;
+
+  *lenp = 0;
+  if(!f)
+    return NULL;
+  if((len = ftell(f)) > 0) {
+    ret = mmt_malloc(len);
+    rewind(f);
+    *lenp = fread(ret, 1, len, f);
+  }
+  fclose(f);
+
+  return ret;
+}
+
+// Print n bytes of s as JSON string
+static void json_str(FILE *f, const char *s, size_t n) {
+  fputc('"', f);
+  for(size_t i = 0; i < n; i++) {
+    unsigned char c = s[i];
+
+    if(c == '"' || c == '\\')
+      fprintf(f, "\\%c", c);
+    else if(c == '\n')
+      fputs("\\n", f);
+    else if(c == '\r')
+      fputs("\\r", f);
+    else if(c == '\t')
+      fputs("\\t", f);
+    else if(c < 0x20 || c == 0x7f)
+      fprintf(f, "\\u%04x", c);
+    else
+      fputc(c, f);
+  }
+  fputc('"', f);
+}
+
+static void json_field(FILE *f, const char *key, const char *s) {
+  fprintf(f, ", \"%s\": ", key);
+  if(s)
+    json_str(f, s, strlen(s));
+  else
+    fputs("null", f);
+}
+
+static void close_session(LISTID sessions, Session *s) {
+  pmsg_notice("closing session %s on %s\n", s->pgmid, s->port);
+  s->pgm->close(s->pgm);
+  if(s->pgm->teardown)
+    s->pgm->teardown(s->pgm);
+  pgm_free(s->pgm);
+  mmt_free(s->pgmid);
+  mmt_free(s->port);
+  mmt_free(s->key);
+  lrmv_d(sessions, s);
+  mmt_free(s);
+}
+
+static int close_sessions(LISTID sessions) {
+  int n = 0;
+
+  while(lsize(sessions)) {
+    close_session(sessions, ldata(lfirst(sessions)));
+    n++;
+  }
+
+  return n;
+}
+
+// Parse the arguments of a job into *job; return -1 on error
+static int parse_job(Job *job, LISTID args) {
+  const char *errstr;
+
+  for(LNODEID ln = lfirst(args); ln; ln = lnext(ln)) {
+    const char *arg = ldata(ln), *val;
+
+    if(*arg != '-' || !arg[1]) {
+      pmsg_error("unexpected argument %s in job\n", arg);
+      return -1;
+    }
+    for(const char *o = arg + 1; *o; o++) {
+      if(strchr("pcPbBixEUT", *o)) {    // Options with a value
+        if(o[1])
+          val = o + 1;
+        else if((ln = lnext(ln)))
+          val = ldata(ln);
+        else {
+          pmsg_error("option -%c requires an argument\n", *o);
+          return -1;
+        }
+        switch(*o) {
+        case 'p':
+          job->partdesc = val;
+          break;
+        case 'c':
+          job->pgmid = val;
+          break;
+        case 'P':
+          job->port = val;
+          break;
+        case 'b':
+          job->baudrate = str_int(val, STR_INT32, &errstr);
+          if(errstr) {
+            pmsg_error("invalid baud rate %s specified: %s\n", val, errstr);
+            return -1;
+          }
+          break;
+        case 'B':
+          if((job->bitclock = parse_bitclock(val)) <= 0.0)
+            return -1;
+          break;
+        case 'i':
+          job->ispdelay = str_int(val, STR_INT32, &errstr);
+          if(errstr || job->ispdelay == 0) {
+            pmsg_error("invalid isp clock delay %s specified\n", val);
+            return -1;
+          }
+          break;
+        case 'x':
+          ladd(job->xparams, (char *) val);
+          break;
+        case 'E':
+          job->exitspecs = val;
+          break;
+        case 'U':
+          {
+            UPDATE *upd = parse_op(val);
+
+            if(!upd) {
+              pmsg_error("unable to parse update operation %s\n", val);
+              return -1;
+            }
+            ladd(job->updates, upd);
+          }
+          break;
+        case 'T':
+          ladd(job->updates, cmd_update(val));
+          break;
+        }
+        break;
+      }
+
+      switch(*o) {              // Flags
+      case 'e':
+        job->erase = 1;
+        job->explicit_e = 1;
+        job->uflags &= ~UF_AUTO_ERASE;
+        break;
+      case 'D':
+        job->uflags &= ~UF_AUTO_ERASE;
+        // Fall through
+      case 'A':
+        job->disableffopt = 1;
+        break;
+      case 'd':
+        job->diffprog = 1;
+        break;
+      case 'n':
+        job->uflags |= UF_NOWRITE;
+        break;
+      case 'V':
+        job->uflags &= ~UF_VERIFY;
+        break;
+      case 'F':
+        job->ovsigck = 1;
+        break;
+      case 'v':
+        job->nverbose++;
+        break;
+      case 'q':
+        job->nquell++;
+        break;
+      default:
+        pmsg_error("option -%c is not available in server jobs\n", *o);
+        return -1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+// Return the session for the programmer of the job, opening it if needed, or NULL on error
+static Session *job_session(LISTID sessions, const Job *job, AVRPART *p, int *reused, double *secs) {
+  const char *id = job->pgmid && *job->pgmid? job->pgmid: default_programmer;
+  PROGRAMMER *cfgpgm;
+
+  *reused = 0;
+  *secs = 0;
+  if(!id || !*id) {
+    pmsg_error("no programmer has been specified in the job or in the config file(s)\n");
+    return NULL;
+  }
+  cfgpgm = locate_programmer_starts_set(programmers, id, &id, p);
+  if(!cfgpgm || !is_programmer(cfgpgm) || !cfgpgm->initpgm) {
+    pmsg_error("cannot find programmer id %s\n", id);
+    return NULL;
+  }
+  if(!(p->prog_modes & cfgpgm->prog_modes) && !job->ovsigck) {
+    pmsg_error("-c %s cannot program %s for lack of a common programming mode\n", id, p->desc);
+    return NULL;
+  }
+
+  PROGRAMMER *dry = locate_programmer(programmers, "dryrun");
+  int is_dryrun = str_eq(cfgpgm->type, "dryrun") || (dry && cfgpgm->initpgm == dry->initpgm);
+  char *port = job->port? mmt_strdup(job->port): default_port(cfgpgm);
+
+  if((!*port || str_eq(port, "unknown")) && !is_dryrun) {
+    pmsg_error("no port has been specified in the job or in the config file\n");
+    mmt_free(port);
+    return NULL;
+  }
+
+  char *xps = mmt_strdup("");
+
+  for(LNODEID ln = lfirst(job->xparams); ln; ln = lnext(ln)) {
+    char *tmp = str_sprintf("%s -x %s", xps, (char *) ldata(ln));
+
+    mmt_free(xps);
+    xps = tmp;
+  }
+  char *key = str_sprintf("%s %s -b %d -B %g -i %d -E %s%s", id, port, job->baudrate, job->bitclock,
+    job->ispdelay, job->exitspecs? job->exitspecs: "", xps);
+
+  mmt_free(xps);
+
+  for(LNODEID ln = lfirst(sessions), next; ln; ln = next) {
+    Session *s = ldata(ln);
+
+    next = lnext(ln);
+    if(str_eq(s->key, key)) {
+      mmt_free(port);
+      mmt_free(key);
+      *reused = 1;
+      return s;
+    }
+    if(str_eq(s->port, port) && !s->is_dryrun) // Port can only be opened once
+      close_session(sessions, s);
+  }
+
+  uint64_t t0 = avr_ustimestamp();
+  PROGRAMMER *pgm = pgm_dup(cfgpgm);
+
+  pgm->initpgm(pgm);
+  if(pgm->setup)
+    pgm->setup(pgm);
+  if(lsize(job->xparams) && (!pgm->parseextparams || pgm->parseextparams(pgm, job->xparams) < 0)) {
+    pmsg_error("unable to parse list of -x parameters\n");
+    goto fail;
+  }
+  if(job->exitspecs && (!pgm->parseexitspecs || pgm->parseexitspecs(pgm, job->exitspecs) < 0)) {
+    pmsg_error("unable to parse list of -E parameters\n");
+    goto fail;
+  }
+  if(job->baudrate)
+    pgm->baudrate = job->baudrate;
+  else if(!pgm->baudrate && default_baudrate)
+    pgm->baudrate = default_baudrate;
+  if(job->bitclock > 0 || default_bitclock > 0)
+    pgm->bitclock = (job->bitclock > 0? job->bitclock: default_bitclock)*1e-6;
+  if(job->ispdelay)
+    pgm->ispdelay = job->ispdelay;
+
+  pmsg_notice("opening session %s on %s\n", id, port);
+  if(pgm->open(pgm, port) < 0) {
+    pmsg_error("unable to open port %s for programmer %s\n", port, id);
+    goto fail;
+  }
+
+  Session *s = mmt_malloc(sizeof *s);
+
+  s->pgm = pgm;
+  s->pgmid = mmt_strdup(id);
+  s->port = port;
+  s->key = key;
+  s->is_dryrun = is_dryrun;
+  ladd(sessions, s);
+  *secs = (avr_ustimestamp() - t0)/1e6;
+
+  return s;
+
+fail:
+  if(pgm->teardown)
+    pgm->teardown(pgm);
+  pgm_free(pgm);
+  mmt_free(port);
+  mmt_free(key);
+
+  return NULL;
+}
+
+// Forget per-board state of the last job, some of which points into its part and updates
+static void forget_job(void) {
+  mmt_free(cx->upd_wrote);
+  mmt_free(cx->upd_termcmds);
+  cx->upd_wrote = NULL;
+  cx->upd_termcmds = NULL;
+  cx->upd_nfwritten = cx->upd_nterms = 0;
+  memset(cx->term_rmem, 0, sizeof cx->term_rmem);
+  cx->term_mi = 0;
+  cx->avr_erased = 0;
+}
+
+// Carry out the job with arguments args in directory cwd and answer with a JSON line to out
+static void run_job(FILE *out, LISTID sessions, const char *cwd, LISTID args) {
+  Job job = {
+    .uflags = UF_AUTO_ERASE | UF_VERIFY,
+    .xparams = lcreat(NULL, 0),
+    .updates = lcreat(NULL, 0),
+  };
+  int rc = 1, reused = 0, save_verbose = verbose, save_quell = quell_progress, save_ovsigck = ovsigck;
+  double open_secs = 0, job_secs = 0;
+  const char *save_partdesc = partdesc, *save_pgmid = pgmid;
+  char home[PATH_MAX], *output[2] = { NULL, NULL }, sigstr[64] = "";
+  size_t outlen[2] = { 0, 0 };
+  AVRPART *cfgp = NULL;
+  AVRPART *p = NULL;            // Copy of the part for this job
+  Session *s = NULL;
+
+  // Capture what the job prints to stdout and stderr
+  FILE *cap1 = tmpfile(), *cap2 = tmpfile();
+  int fd1 = -1, fd2 = -1;
+
+  fflush(stdout);
+  fflush(stderr);
+  if(cap1 && cap2 && (fd1 = dup(1)) >= 0 && (fd2 = dup(2)) >= 0) {
+    dup2(fileno(cap1), 1);
+    dup2(fileno(cap2), 2);
+  }
+
+  if(!getcwd(home, sizeof home) || (cwd && chdir(cwd) < 0)) {
+    pmsg_ext_error("cannot change to directory %s: %s\n", cwd? cwd: ".", strerror(errno));
+    goto done;
+  }
+  if(parse_job(&job, args) < 0)
+    goto back;
+
+  verbose = save_verbose + job.nverbose;
+  quell_progress = save_quell + job.nquell;
+  ovsigck = job.ovsigck;
+
+  if(!job.partdesc || !(cfgp = locate_part(part_list, job.partdesc))) {
+    pmsg_error("AVR part %s not found\n", job.partdesc? job.partdesc: "(no -p)");
+    goto back;
+  }
+  if(!(s = job_session(sessions, &job, cfgp, &reused, &open_secs)))
+    goto back;
+
+  uint64_t t0 = avr_ustimestamp();
+  int doexit = 0;
+
+  partdesc = job.partdesc;
+  pgmid = s->pgmid;
+  cx->avr_disableffopt = job.disableffopt;
+  cx->avr_diffprog = job.diffprog;
+  p = avr_dup_part(cfgp);
+  if(avr_initmem(p) != 0) {
+    pmsg_error("unable to initialize memories\n");
+    goto back;
+  }
+  for(LNODEID ln = lfirst(job.updates); ln; ln = lnext(ln)) {
+    UPDATE *upd = ldata(ln);
+
+    if(upd->memstr == NULL && upd->cmdline == NULL)
+      upd->memstr = mmt_strdup(is_pdi(p)? "application": "flash");
+    int urc = update_dryrun(p, upd);
+
+    if(urc && urc != LIBAVRDUDE_SOFTFAIL)
+      doexit = 1;
+  }
+
+  if(!doexit) {
+    rc = process_updates(s->pgm, p, job.updates, job.uflags, job.erase, job.explicit_e, job.baudrate,
+      s->is_dryrun);
+
+    led_set(s->pgm, LED_END);
+    s->pgm->powerdown(s->pgm);
+    s->pgm->disable(s->pgm);
+    s->pgm->reset_cache(s->pgm, p);
+    s->njobs++;
+
+    AVRMEM *sig = avr_locate_signature(p);
+
+    if(sig && sig->size >= 3)
+      snprintf(sigstr, sizeof sigstr, "%s", str_cchex(sig->buf, sig->size, 0));
+  }
+  job_secs = (avr_ustimestamp() - t0)/1e6;
+
+back:
+  if(chdir(home) < 0)
+    pmsg_ext_error("cannot change back to directory %s: %s\n", home, strerror(errno));
+
+done:
+  fflush(stdout);
+  fflush(stderr);
+  if(fd1 >= 0 && fd2 >= 0) {
+    dup2(fd1, 1);
+    dup2(fd2, 2);
+  }
+  if(fd1 >= 0)
+    close(fd1);
+  if(fd2 >= 0)
+    close(fd2);
+  output[0] = slurp(cap1, outlen + 0);
+  output[1] = slurp(cap2, outlen + 1);
+
+  fprintf(out, "{\"rc\": %d", rc);
+  json_field(out, "part", cfgp? cfgp->desc: NULL);
+  json_field(out, "programmer", s? s->pgmid: NULL);
+  json_field(out, "port", s? s->port: NULL);
+  fprintf(out, ", \"reused\": %s, \"jobs\": %d, \"open_secs\": %.6f, \"job_secs\": %.6f",
+    reused? "true": "false", s? s->njobs: 0, open_secs, job_secs);
+  json_field(out, "signature", *sigstr? sigstr: NULL);
+  fputs(", \"stdout\": ", out);
+  json_str(out, output[0]? output[0]: "", outlen[0]);
+  fputs(", \"stderr\": ", out);
+  json_str(out, output[1]? output[1]: "", outlen[1]);
+  fputs("}\n", out);
+  fflush(out);
+
+  if(s && rc)                   // Start afresh after a failed job
+    close_session(sessions, s);
+  if(p)
+    avr_free_part(p);
+  forget_job();
+  ldestroy_cb(job.updates, (void (*)(void *)) free_update);
+  ldestroy(job.xparams);
+  mmt_free(output[0]);
+  mmt_free(output[1]);
+  verbose = save_verbose;
+  quell_progress = save_quell;
+  ovsigck = save_ovsigck;
+  partdesc = save_partdesc;
+  pgmid = save_pgmid;
+}
+
+// Serve requests of one client until it hangs up; return 1 on quit request
+static int serve_client(int fd, LISTID sessions) {
+  FILE *in = fdopen(fd, "r"), *out = NULL;
+  int wfd = dup(fd), quit = 0;
+  char *line, *cwd = NULL;
+  LISTID args = lcreat(NULL, 0);
+
+  if(!in || wfd < 0 || !(out = fdopen(wfd, "w"))) {
+    pmsg_ext_error("cannot set up client connection: %s\n", strerror(errno));
+    if(in)
+      fclose(in);
+    else
+      close(fd);
+    if(wfd >= 0)
+      close(wfd);
+    ldestroy(args);
+    return 0;
+  }
+
+  while(!quit && !srv_stop && (line = str_fgets(in, NULL))) {
+    char *eol = line + strlen(line);
+
+    while(eol > line && (eol[-1] == '\n' || eol[-1] == '\r'))
+      *--eol = 0;
+
+    if(str_starts(line, "cwd ")) {
+      mmt_free(cwd);
+      cwd = mmt_strdup(line + 4);
+    } else if(str_starts(line, "arg ")) {
+      ladd(args, mmt_strdup(line + 4));
+    } else if(str_eq(line, "run")) {
+      run_job(out, sessions, cwd, args);
+      ldestroy_cb(args, mmt_f_free);
+      args = lcreat(NULL, 0);
+      mmt_free(cwd);
+      cwd = NULL;
+    } else if(str_eq(line, "status")) {
+      fputs("{\"sessions\": [", out);
+      for(LNODEID ln = lfirst(sessions); ln; ln = lnext(ln)) {
+        Session *s = ldata(ln);
+
+        fputs(ln == lfirst(sessions)? "{": ", {", out);
+        fputs("\"programmer\": ", out);
+        json_str(out, s->pgmid, strlen(s->pgmid));
+        json_field(out, "port", s->port);
+        fprintf(out, ", \"jobs\": %d}", s->njobs);
+      }
+      fputs("]}\n", out);
+    } else if(str_eq(line, "close")) {
+      fprintf(out, "{\"closed\": %d}\n", close_sessions(sessions));
+    } else if(str_eq(line, "quit")) {
+      fputs("{\"quit\": true}\n", out);
+      quit = 1;
+    } else if(*line) {
+      fputs("{\"error\": ", out);
+      json_str(out, line, strlen(line));
+      fputs("}\n", out);
+    }
+    fflush(out);
+    mmt_free(line);
+  }
+
+  ldestroy_cb(args, mmt_f_free);
+  mmt_free(cwd);
+  fclose(out);
+  fclose(in);
+
+  return quit;
+}
+
+// Serve programming jobs on the Unix-domain socket sockpath until quit or signal
+int avrdude_server(const char *sockpath) {
+  struct sockaddr_un sa;
+  struct sigaction act;
+  int lfd, rc = 1;
+  LISTID sessions = lcreat(NULL, 0);
+
+  memset(&sa, 0, sizeof sa);
+  sa.sun_family = AF_UNIX;
+  if(strlen(sockpath) >= sizeof sa.sun_path) {
+    pmsg_error("socket path %s is too long\n", sockpath);
+    return 1;
+  }
+  strcpy(sa.sun_path, sockpath);
+
+  if((lfd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+    pmsg_ext_error("cannot create socket: %s\n", strerror(errno));
+    return 1;
+  }
+
+  struct stat sb;
+
+  if(lstat(sockpath, &sb) == 0) {       // Remove a stale socket unless a server is listening
+    if(!S_ISSOCK(sb.st_mode) || connect(lfd, (struct sockaddr *) &sa, sizeof sa) == 0) {
+      pmsg_error("%s exists and is %s\n", sockpath, S_ISSOCK(sb.st_mode)? "in use": "not a socket");
+      close(lfd);
+      return 1;
+    }
+    unlink(sockpath);
+  }
+
+  mode_t mask = umask(0177);    // Owner only
+
+  if(bind(lfd, (struct sockaddr *) &sa, sizeof sa) < 0 || listen(lfd, 4) < 0) {
+    umask(mask);
+    pmsg_ext_error("cannot listen on %s: %s\n", sockpath, strerror(errno));
+    close(lfd);
+    return 1;
+  }
+  umask(mask);
+
+  memset(&act, 0, sizeof act);
+  act.sa_handler = srv_sighandler;      // No SA_RESTART so accept() returns on signals
+  sigemptyset(&act.sa_mask);
+  sigaction(SIGINT, &act, NULL);
+  sigaction(SIGTERM, &act, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  pmsg_info("serving jobs on %s\n", sockpath);
+  while(!srv_stop) {
+    int fd = accept(lfd, NULL, NULL);
+
+    if(fd < 0) {
+      if(errno == EINTR)
+        continue;
+      pmsg_ext_error("cannot accept connection: %s\n", strerror(errno));
+      break;
+    }
+    if(serve_client(fd, sessions)) {
+      rc = 0;
+      break;
+    }
+  }
+  if(srv_stop)
+    rc = 0;
+
+  close_sessions(sessions);
+  ldestroy(sessions);
+  close(lfd);
+  unlink(sockpath);
+  pmsg_info("server on %s stopped\n", sockpath);
+
+  return rc;
+}
+
+// Write the unescaped JSON string of key in the answer ans to f; return -1 if there is none
+static int json_print_str(FILE *f, const char *ans, const char *key) {
+  char *pat = str_sprintf("\"%s\": \"", key);
+  const char *q = strstr(ans, pat);
+  unsigned int u;
+
+  if(q)
+    for(q += strlen(pat); *q && *q != '"'; q++) {
+      if(*q != '\\' || !q[1])
+        fputc(*q, f);
+      else if(*++q == 'n')
+        fputc('\n', f);
+      else if(*q == 'r')
+        fputc('\r', f);
+      else if(*q == 't')
+        fputc('\t', f);
+      else if(*q == 'u' && sscanf(q + 1, "%4x", &u) == 1)
+        fputc(u, f), q += 4;
+      else
+        fputc(*q, f);
+    }
+  mmt_free(pat);
+
+  return q? 0: -1;
+}
+
+// Return the JSON number of key in the answer ans or 0 if there is none
+static double json_num(const char *ans, const char *key) {
+  char *pat = str_sprintf("\"%s\": ", key);
+  const char *q = strstr(ans, pat);
+  double ret = q? strtod(q + strlen(pat), NULL): 0;
+
+  mmt_free(pat);
+
+  return ret;
+}
+
+// Send the job given by args to the server on sockpath and reproduce its output; return its exit code
+int avrdude_client(const char *sockpath, LISTID args) {
+  struct sockaddr_un sa;
+  char cwd[PATH_MAX], *ans;
+  int fd;
+  FILE *in;
+
+  memset(&sa, 0, sizeof sa);
+  sa.sun_family = AF_UNIX;
+  if(strlen(sockpath) >= sizeof sa.sun_path) {
+    pmsg_error("socket path %s is too long\n", sockpath);
+    return 1;
+  }
+  strcpy(sa.sun_path, sockpath);
+
+  for(LNODEID ln = lfirst(args); ln; ln = lnext(ln))
+    if(strpbrk(ldata(ln), "\r\n")) {
+      pmsg_error("job arguments for the server cannot contain line breaks\n");
+      return 1;
+    }
+
+  if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 || connect(fd, (struct sockaddr *) &sa, sizeof sa) < 0) {
+    pmsg_ext_error("cannot connect to server on %s: %s\n", sockpath, strerror(errno));
+    if(fd >= 0)
+      close(fd);
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  if(!(in = fdopen(fd, "r"))) {
+    pmsg_ext_error("cannot set up server connection: %s\n", strerror(errno));
+    close(fd);
+    return 1;
+  }
+  if(getcwd(cwd, sizeof cwd))
+    dprintf(fd, "cwd %s\n", cwd);
+  for(LNODEID ln = lfirst(args); ln; ln = lnext(ln))
+    dprintf(fd, "arg %s\n", (char *) ldata(ln));
+  dprintf(fd, "run\n");
+
+  if(!(ans = str_fgets(in, NULL)) || !str_starts(ans, "{\"rc\": ")) {
+    pmsg_error("server on %s did not answer the job\n", sockpath);
+    mmt_free(ans);
+    fclose(in);
+    return 1;
+  }
+  fclose(in);
+
+  int rc = (int) json_num(ans, "rc");
+
+  json_print_str(stdout, ans, "stdout");
+  fflush(stdout);
+  json_print_str(stderr, ans, "stderr");
+  pmsg_notice("job %d of the %s session took %.3f s\n", (int) json_num(ans, "jobs"),
+    strstr(ans, "\"reused\": true")? "reused": "new", json_num(ans, "job_secs"));
+  mmt_free(ans);
+
+  return rc;
+}
+
+#else
+
+int avrdude_server(const char *sockpath) {
+  pmsg_error("server mode -S %s is not available on Windows\n", sockpath);
+  return 1;
+}
+
+int avrdude_client(const char *sockpath, LISTID args) {
+  pmsg_error("server mode -S %s is not available on Windows\n", sockpath);
+  return 1;
+}
+#endif
@@ -42,6 +42,7 @@
 
 #define STK500_XTAL 7372800U
 #define MAX_SYNC_ATTEMPTS 10
+#define STK500_MAX_PIPELINE 64
 
 static double f_to_kHz_MHz(double f, const char **unit) {
   if(f >= 1e6) {
@@ -609,6 +610,32 @@ retry:
   return pgm->program_enable(pgm, p);
 }
 
+/*
+ * Parse -x pipeline[=<n>] into my.pipeline; return 0 if extended_param is
+ * another option, 1 otherwise with *rvp set to -1 for an invalid window
+ */
+int stk500_parse_pipeline(const PROGRAMMER *pgm, const char *extended_param, int *rvp) {
+  if(str_eq(extended_param, "pipeline")) {
+    my.pipeline = 1;
+    return 1;
+  }
+
+  if(str_starts(extended_param, "pipeline=")) {
+    const char *errstr;
+    int window = str_int(extended_param + 9, STR_INT32, &errstr);
+
+    if(errstr || window < 0 || window > STK500_MAX_PIPELINE) {
+      pmsg_error("invalid pipeline window in -x %s, expected 0..%d\n", extended_param, STK500_MAX_PIPELINE);
+      *rvp = -1;
+      return 1;
+    }
+    my.pipeline = window;
+    return 1;
+  }
+
+  return 0;
+}
+
 static int stk500_parseextparms(const PROGRAMMER *pgm, const LISTID extparms) {
   int attempts;
   int rv = 0;
@@ -623,6 +650,12 @@ static int stk500_parseextparms(const PROGRAMMER *pgm, const LISTID extparms) {
       continue;
     }
 
+    if(stk500_parse_pipeline(pgm, extended_param, &rv)) {
+      if(rv < 0)
+        break;
+      continue;
+    }
+
     if(str_starts(extended_param, "vtarg")) {
       if((pgm->extra_features & HAS_VTARG_ADJ) && (str_starts(extended_param, "vtarg="))) {
         // Set target voltage
@@ -780,6 +813,7 @@ static int stk500_parseextparms(const PROGRAMMER *pgm, const LISTID extparms) {
       msg_error("  -x fosc=<n>[unit] Set oscillator clock frequency to <n> Hz (or kHz/MHz)\n");
       msg_error("  -x fosc=off       Switch the oscillator clock off\n");
     }
+    msg_error("  -x pipeline[=<n>] Stream up to <n> paged r/w requests before reading responses\n");
     msg_error("  -x xtal=<n>[unit] Set programmer xtal frequency to <n> Hz (or kHz/MHz)\n");
     msg_error("  -x help           Show this help menu and exit\n");
     return rv;
@@ -876,17 +910,18 @@ static void stk500_close(PROGRAMMER *pgm) {
   pgm->fd.ifd = -1;
 }
 
-// Address is byte address; a_div == 2: send word address; a_div == 1: send byte address
-static int stk500_loadaddr(const PROGRAMMER *pgm, const AVRMEM *mem, unsigned int addr, int a_div) {
-  unsigned char buf[16];
-  int tries;
-  unsigned char ext_byte;
+// Whether the (divided) address addr needs sending a new extended address byte to the device
+static int stk500_needs_ext_addr(const PROGRAMMER *pgm, const AVRMEM *mem, unsigned int addr, int a_div) {
+  if(is_spm(pgm)? mem->size/a_div > 64*1024: mem->op[AVR_OP_LOAD_EXT_ADDR] != NULL)
+    return ((addr >> 16) & 0xff) != my.ext_addr_byte;
 
-  addr /= a_div;
+  return 0;
+}
 
-  tries = 0;
-retry:
-  tries++;
+// Send the extended address byte for the (divided) address addr to the device if needed
+static void stk500_set_ext_addr(const PROGRAMMER *pgm, const AVRMEM *mem, unsigned int addr, int a_div) {
+  unsigned char buf[16];
+  unsigned char ext_byte;
 
   // Support large flash by sending the correct extended address byte when needed
 
@@ -931,6 +966,20 @@ retry:
       }
     }
   }
+}
+
+// Address is byte address; a_div == 2: send word address; a_div == 1: send byte address
+static int stk500_loadaddr(const PROGRAMMER *pgm, const AVRMEM *mem, unsigned int addr, int a_div) {
+  unsigned char buf[16];
+  int tries;
+
+  addr /= a_div;
+
+  tries = 0;
+retry:
+  tries++;
+
+  stk500_set_ext_addr(pgm, mem, addr, a_div);
 
   buf[0] = Cmnd_STK_LOAD_ADDRESS;
   buf[1] = addr & 0xff;
@@ -987,6 +1036,109 @@ static int set_memchr_a_div(const PROGRAMMER *pgm, const AVRPART *p, const AVRME
   return -1;
 }
 
+// Receive the Resp_STK_INSYNC [len data bytes] Resp_STK_OK response of a pipelined command
+static int stk500_pipeline_recv(const PROGRAMMER *pgm, unsigned char *data, int len) {
+  unsigned char b;
+
+  if(stk500_recv(pgm, &b, 1) < 0)
+    return -1;
+  if(b != Resp_STK_INSYNC) {
+    pmsg_notice("protocol expects sync byte 0x%02x but got 0x%02x\n", Resp_STK_INSYNC, b);
+    return -1;
+  }
+  if(len > 0 && stk500_recv(pgm, data, len) < 0)
+    return -1;
+  if(stk500_recv(pgm, &b, 1) < 0)
+    return -1;
+  if(b != Resp_STK_OK) {
+    pmsg_notice("protocol expects OK byte 0x%02x but got 0x%02x\n", Resp_STK_OK, b);
+    return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * Pipelined paged write (write = 1) or paged load (write = 0), see -x pipeline
+ *
+ * Each block is sent as one Cmnd_STK_LOAD_ADDRESS plus Cmnd_STK_PROG_PAGE or
+ * Cmnd_STK_READ_PAGE pair. Up to my.pipeline pairs are streamed before the
+ * responses of the oldest pair are read, so that the serial round trip
+ * latency is paid once per window rather than twice per page. Responses come
+ * back in order; any unexpected response or timeout causes a resync via
+ * stk500_getsync() and resending from the oldest unacknowledged block.
+ */
+static int stk500_paged_pipelined(const PROGRAMMER *pgm, const AVRMEM *m, int memchr, int a_div,
+  unsigned int page_size, unsigned int addr, unsigned int n_bytes, int write) {
+
+  unsigned char *buf = mmt_malloc(page_size + 16);
+  unsigned int end = addr + n_bytes;
+  unsigned int head = addr;     // Oldest block not yet acknowledged
+  unsigned int next = addr;     // Next block to be sent
+  int npend = 0, tries = 0, rc = n_bytes;
+
+  while(head < end) {
+    // Stream the next pair unless the window is full or an ext addr command must go out first
+    if(next < end && npend < my.pipeline && !(npend && stk500_needs_ext_addr(pgm, m, next/a_div, a_div))) {
+      unsigned int block_size = end - next < page_size? end - next: page_size;
+      unsigned int a = next/a_div;
+      int i = 0;
+
+      stk500_set_ext_addr(pgm, m, a, a_div);
+      buf[i++] = Cmnd_STK_LOAD_ADDRESS;
+      buf[i++] = a & 0xff;
+      buf[i++] = (a >> 8) & 0xff;
+      buf[i++] = Sync_CRC_EOP;
+      buf[i++] = write? Cmnd_STK_PROG_PAGE: Cmnd_STK_READ_PAGE;
+      buf[i++] = (block_size >> 8) & 0xff;
+      buf[i++] = block_size & 0xff;
+      buf[i++] = memchr;
+      if(write) {
+        memcpy(buf + i, m->buf + next, block_size);
+        i += block_size;
+      }
+      buf[i++] = Sync_CRC_EOP;
+      stk500_send(pgm, buf, i);
+
+      next += block_size;
+      npend++;
+      continue;
+    }
+
+    // Collect responses of the oldest pair
+    unsigned int block_size = end - head < page_size? end - head: page_size;
+
+    if(stk500_pipeline_recv(pgm, NULL, 0) < 0 ||
+      stk500_pipeline_recv(pgm, write? NULL: m->buf + head, write? 0: block_size) < 0) {
+
+      if(++tries > 33) {
+        msg_error("\n");
+        pmsg_error("cannot get into sync\n");
+        rc = -3;
+        break;
+      }
+      pmsg_notice("resynchronising pipelined paged %s at %s\n", write? "write": "load",
+        str_ccaddress(head, m->size));
+      stk500_drain(pgm, 0);
+      if(stk500_getsync(pgm) < 0) {
+        rc = -1;
+        break;
+      }
+      my.ext_addr_byte = 0xff;  // Unknown device state: force loading ext addr again
+      next = head;
+      npend = 0;
+      continue;
+    }
+
+    head += block_size;
+    npend--;
+    tries = 0;                  // Retry budget is per block as in the unpipelined loops
+  }
+
+  mmt_free(buf);
+  return rc;
+}
+
 static int stk500_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *m,
   unsigned int page_size, unsigned int addr, unsigned int n_bytes) {
   unsigned char *buf = alloca(page_size + 16);
@@ -1000,6 +1152,9 @@ static int stk500_paged_write(const PROGRAMMER *pgm, const AVRPART *p, const AVR
   if(set_memchr_a_div(pgm, p, m, &memchr, &a_div) < 0)
     return -2;
 
+  if(my.pipeline > 0 && !str_eq(pgmid, "mib510"))
+    return stk500_paged_pipelined(pgm, m, memchr, a_div, page_size, addr, n_bytes, 1);
+
   n = addr + n_bytes;
 
 #if 0
@@ -1074,6 +1229,9 @@ static int stk500_paged_load(const PROGRAMMER *pgm, const AVRPART *p, const AVRM
   if(set_memchr_a_div(pgm, p, m, &memchr, &a_div) < 0)
     return -2;
 
+  if(my.pipeline > 0 && !str_eq(pgmid, "mib510"))
+    return stk500_paged_pipelined(pgm, m, memchr, a_div, page_size, addr, n_bytes, 0);
+
   n = addr + n_bytes;
   for(; addr < n; addr += block_size) {
     // MIB510 uses fixed blocks size of 256 bytes
@@ -29,6 +29,7 @@ extern "C" {
   // Used by arduino.c to avoid duplicate code
   int stk500_getsync(const PROGRAMMER *pgm);
   int stk500_drain(const PROGRAMMER *pgm, int display);
+  int stk500_parse_pipeline(const PROGRAMMER *pgm, const char *extended_param, int *rvp);
 
 #ifdef __cplusplus
 }
@@ -38,6 +39,7 @@ extern "C" {
 struct pdata {
   unsigned char ext_addr_byte;  // Record ext-addr byte set in the target device (if used)
   int retry_attempts;           // Number of connection attempts provided by the user
+  int pipeline;                 // Max number of paged r/w requests in flight (0: stop-and-wait)
   int xbeeResetPin;             // Piggy back variable used by xbee programmmer
   struct serial_device xbee_serdev;     // Piggy back device descriptor for XBee framing
 
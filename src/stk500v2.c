@@ -4730,6 +4730,7 @@ static void stk600_setup_isp(PROGRAMMER *pgm) {
   pgm->write_byte = stk500isp_write_byte;
   pgm->paged_load = stk500v2_paged_load;
   pgm->paged_write = stk500v2_paged_write;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = NULL;
   pgm->chip_erase = stk500v2_chip_erase;
 }
@@ -4755,6 +4756,7 @@ void stk500v2_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = stk500v2_paged_write;
   pgm->paged_load = stk500v2_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = NULL;
   pgm->print_parms = stk500v2_print_parms;
   pgm->set_sck_period = stk500v2_set_sck_period;
@@ -4873,6 +4875,7 @@ void stk500v2_jtagmkII_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = stk500v2_paged_write;
   pgm->paged_load = stk500v2_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = NULL;
   pgm->print_parms = stk500v2_print_parms;
   pgm->set_sck_period = stk500v2_set_sck_period_mk2;
@@ -4904,6 +4907,7 @@ void stk500v2_dragon_isp_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = stk500v2_paged_write;
   pgm->paged_load = stk500v2_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = NULL;
   pgm->print_parms = stk500v2_print_parms;
   pgm->set_sck_period = stk500v2_set_sck_period_mk2;
@@ -4991,6 +4995,7 @@ void stk600_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = stk500v2_paged_write;
   pgm->paged_load = stk500v2_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = NULL;
   pgm->print_parms = stk500v2_print_parms;
   pgm->set_vtarget = stk600_set_vtarget;
@@ -5099,6 +5104,7 @@ void stk500v2_jtag3_initpgm(PROGRAMMER *pgm) {
   // Optional functions
   pgm->paged_write = stk500v2_paged_write;
   pgm->paged_load = stk500v2_paged_load;
+  pgm->paged_burst = INT_MAX;   // Paged routines loop over pages
   pgm->page_erase = NULL;
   pgm->print_parms = stk500v2_print_parms;
   pgm->set_sck_period = stk500v2_jtag3_set_sck_period;
@@ -425,17 +425,18 @@ static unsigned char *readbuf(const PROGRAMMER *pgm, const AVRPART *p, int argc,
   }
 
   report_progress(0, 1, "Reading");
-  for(int j = 0; j < toread; j++) {
+  // Read up to the end of memory and wrap round to its start for the rest
+  for(int j = 0, n; j < toread; j += n) {
     int addr = (whence + j)%maxsize;
-    int rc = pgm->read_byte_cached(pgm, p, mem, addr, &buf[j]);
 
-    if(rc != 0) {
+    n = addr + toread - j > maxsize? maxsize - addr: toread - j;
+    if(avr_read_range_cached(pgm, p, mem, addr, n, buf + j) != 0) {
       report_progress(1, -1, NULL);
-      pmsg_error("(%s) error reading %s address 0x%05lx of part %s\n", cmd, mem->desc, (long) whence + j, p->desc);
+      pmsg_error("(%s) error reading %s interval [0x%05x, 0x%05x] of part %s\n",
+        cmd, mem->desc, addr, addr + n - 1, p->desc);
       mmt_free(buf);
       return NULL;
     }
-    report_progress(j, toread, NULL);
   }
   report_progress(1, 1, NULL);
 
@@ -645,6 +646,18 @@ typedef enum {
   WRITE_MODE_FILL = 1,
 } Write_mode;
 
+// Report if byte b read back from address a differs from the written byte in the used bits
+static void write_check(const AVRPART *p, const AVRMEM *mem, int a, uint8_t written, uint8_t b) {
+  int bitmask = avr_mem_bitmask(p, mem, a);
+
+  if((b & bitmask) != (written & bitmask)) {
+    pmsg_error("(write) verification error writing 0x%02x at 0x%05x cell=0x%02x", written, a, b);
+    if(bitmask != 0xff)
+      msg_error(" using bit mask 0x%02x", bitmask);
+    msg_error("\n");
+  }
+}
+
 static int cmd_write(const PROGRAMMER *pgm, const AVRPART *p, int argc, const char *argv[]) {
   if(argc < 3 || (argc > 1 && str_eq(argv[1], "-?"))) {
     msg_error("Syntax: write <mem> <addr> <data>[,] {<data>[,]}\n"
@@ -816,10 +829,10 @@ static int cmd_write(const PROGRAMMER *pgm, const AVRPART *p, int argc, const ch
 
       for(size_t j = 0; j < len; j++, n++) {
         buf[n] = (uint8_t) sd->str_ptr[j];
-        tags[n] = TAG_ALLOCATED;
+        tags[n] = 1;
       }
       buf[n] = 0;               // Terminating nul
-      tags[n] = TAG_ALLOCATED;
+      tags[n] = 1;
       bytes_grown += (int) len; // Sic: one less than written
     } else if(sd->type == STR_FILE && sd->mem && sd->size > 0) {
       int end = bufsz - n;      // Available buffer size
@@ -827,9 +840,9 @@ static int cmd_write(const PROGRAMMER *pgm, const AVRPART *p, int argc, const ch
       if(sd->size < end)
         end = sd->size;
       for(int j = 0; j < end; j++, n++) {
-        if(sd->mem->tags[j]) {
+        if(avr_tag_get(sd->mem, j)) {
           buf[n] = sd->mem->buf[j];
-          tags[n] = TAG_ALLOCATED;
+          tags[n] = 1;
         }
       }
       if(end > 0)               // Should always be true
@@ -837,7 +850,7 @@ static int cmd_write(const PROGRAMMER *pgm, const AVRPART *p, int argc, const ch
     } else if(sd->size > 0 && (sd->type & STR_NUMBER)) {
       for(int k = 0; k < sd->size; k++, n++) {
         buf[n] = sd->a[k];
-        tags[n] = TAG_ALLOCATED;
+        tags[n] = 1;
       }
       bytes_grown += sd->size - 1;
     } else {                    // Nothing written
@@ -872,11 +885,33 @@ static int cmd_write(const PROGRAMMER *pgm, const AVRPART *p, int argc, const ch
     msg_notice2("; remaining space filled with %s", argv[argc - 2]);
   msg_notice2("\n");
 
-  report_progress(0, 1, avr_has_paged_access(pgm, p, mem)? "Caching": "Writing");
-  for(i = 0; i < len + bytes_grown; i++) {
-    report_progress(i, len + bytes_grown, NULL);
+  int nwrite = len + bytes_grown, paged = avr_has_paged_access(pgm, p, mem);
+
+  report_progress(0, 1, paged? "Caching": "Writing");
+  if(paged) {                   // Write and read back runs of bytes in one go
+    uint8_t *back = mmt_malloc(nwrite);
+
+    for(int beg = 0, end; beg < nwrite; beg = end) {
+      for(; beg < nwrite && !tags[beg]; beg++)
+        continue;
+      for(end = beg; end < nwrite && tags[end]; end++)
+        continue;
+      // Leave the run to the bytewise loop below if it cannot be written cleanly
+      if(end == beg || avr_write_range_cached(pgm, p, mem, addr + beg, end - beg, buf + beg) ||
+        avr_read_range_cached(pgm, p, mem, addr + beg, end - beg, back + beg))
+        continue;
+      for(int k = beg; k < end; k++) {
+        write_check(p, mem, addr + k, buf[k], back[k]);
+        tags[k] = 0;
+      }
+      report_progress(end, nwrite, NULL);
+    }
+    mmt_free(back);
+  }
+  for(i = 0; i < nwrite; i++) {
     if(!tags[i])
       continue;
+    report_progress(i, nwrite, NULL);
 
     uint8_t b;
     int rc = pgm->write_byte_cached(pgm, p, mem, addr + i, buf[i]);
@@ -890,14 +925,7 @@ static int cmd_write(const PROGRAMMER *pgm, const AVRPART *p, int argc, const ch
     } else if(pgm->read_byte_cached(pgm, p, mem, addr + i, &b) < 0) {
       pmsg_error("(write) readback from %s failed\n", mem->desc);
     } else {                    // Read back byte b is now set
-      int bitmask = avr_mem_bitmask(p, mem, addr + i);
-
-      if((b & bitmask) != (buf[i] & bitmask)) {
-        pmsg_error("(write) verification error writing 0x%02x at 0x%05x cell=0x%02x", buf[i], addr + i, b);
-        if(bitmask != 0xff)
-          msg_error(" using bit mask 0x%02x", bitmask);
-        msg_error("\n");
-      }
+      write_check(p, mem, addr + i, buf[i], b);
     }
   }
   report_progress(1, 1, NULL);
@@ -981,16 +1009,14 @@ static int cmd_save(const PROGRAMMER *pgm, const AVRPART *p, int argc, const cha
   // Read memory from device/cache
   report_progress(0, 1, "Reading");
   for(int i = 0; i < n; i++) {
-    for(int j = seglist[i].addr; j < seglist[i].addr + seglist[i].len; j++) {
-      int rc = pgm->read_byte_cached(pgm, p, mem, j, mem->buf + j);
+    int beg = seglist[i].addr, end = beg + seglist[i].len - 1;
+    int digits = end < 16? 1: end < 256? 2: end < 65536? 4: 5;
 
-      if(rc < 0) {
-        report_progress(1, -1, NULL);
-        pmsg_error("(save) error reading %s address 0x%0*x of part %s\n",
-          mem->desc, j < 16? 1: j < 256? 2: j < 65536? 4: 5, j, p->desc);
-        return -1;
-      }
-      report_progress(j, nbytes, NULL);
+    if(seglist[i].len > 0 && avr_read_range_cached(pgm, p, mem, beg, seglist[i].len, mem->buf + beg) < 0) {
+      report_progress(1, -1, NULL);
+      pmsg_error("(save) error reading %s interval [0x%0*x, 0x%0*x] of part %s\n",
+        mem->desc, digits, beg, digits, end, p->desc);
+      return -1;
     }
   }
   report_progress(1, 1, NULL);
@@ -1296,11 +1322,14 @@ static int cmd_erase(const PROGRAMMER *pgm, const AVRPART *p, int argc, const ch
     }
 
     msg_info("[0x%04x, 0x%04x]; undo with abort\n", beg, end);
-    for(int addr = beg; addr <= end; addr++)
-      if(!pgm->readonly || !pgm->readonly(pgm, p, flm, addr))
-        if(pgm->write_byte_cached(pgm, p, flm, addr, 0xff) == -1)
-          return -1;
-    return 0;
+    // Write protected bytes are left alone
+    unsigned char *ff = mmt_malloc(end - beg + 1);
+
+    memset(ff, 0xff, end - beg + 1);
+    rc = avr_write_range_cached(pgm, p, flm, beg, end - beg + 1, ff);
+    mmt_free(ff);
+
+    return rc == LIBAVRDUDE_GENERAL_FAILURE? -1: 0;
   }
 
   if(rc) {
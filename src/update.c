@@ -98,6 +98,7 @@ UPDATE *dup_update(const UPDATE *upd) {
   memcpy(u, upd, sizeof *u);
   u->memstr = upd->memstr? mmt_strdup(upd->memstr): NULL;
   u->filename = mmt_strdup(upd->filename);
+  u->image = NULL;              // Preloaded input is not shared with copies
 
   return u;
 }
@@ -125,6 +126,7 @@ void free_update(UPDATE *u) {
   if(u) {
     mmt_free(u->memstr);
     mmt_free(u->filename);
+    fileio_free_image(u->image);
     memset(u, 0, sizeof *u);
     mmt_free(u);
   }
@@ -169,42 +171,28 @@ int memstats_mem(const AVRPART *p, const AVRMEM *mem, int size, Filestats *fsp)
   }
 
   ret.lastaddr = -1;
-  int firstset = 0, insection = 0;
-
-  // Scan all memory
-  for(int addr = 0; addr < mem->size;) {
-    int pageset = 0;
-
-    // Go page by page
-    for(int pgi = 0; pgi < pgsize; pgi++, addr++) {
-      if(mem->tags[addr] & TAG_ALLOCATED) {
-        if(!firstset) {
-          firstset = 1;
-          ret.firstaddr = addr;
-        }
-        ret.lastaddr = addr;
-        // Size can be smaller than tags suggest owing to flash trailing-0xff
-        if(addr < size) {
-          ret.nbytes++;
-          if(!pageset) {
-            pageset = 1;
-            ret.nfill += pgi;
-            ret.npages++;
-          }
-          if(!insection) {
-            insection = 1;
-            ret.nsections++;
-          }
-        } else {                // Now beyond size returned by input file read
-          ret.ntrailing++;
-          if(pageset)
-            ret.nfill++;
-        }
-      } else {                  // In a hole or beyond input file
-        insection = 0;
-        if(pageset)
-          ret.nfill++;
-      }
+
+  // Runs of allocated bytes give first and last address and, below size, the sections
+  for(int beg = 0, end; (beg = avr_tag_find(mem, beg, mem->size, 1)) < mem->size; beg = end) {
+    end = avr_tag_find(mem, beg, mem->size, 0);
+    if(ret.lastaddr < 0)
+      ret.firstaddr = beg;
+    ret.lastaddr = end - 1;
+    if(beg < size)
+      ret.nsections++;
+  }
+
+  // Size can be smaller than tags suggest owing to flash trailing-0xff
+  ret.ntrailing = avr_tag_count(mem, size, mem->size - size);
+
+  // Count page by page the bytes set below size and the gaps in pages that have any
+  for(int addr = 0; addr < size; addr += pgsize) {
+    int nset = avr_tag_count(mem, addr, addr + pgsize > size? size - addr: pgsize);
+
+    if(nset) {
+      ret.nbytes += nset;
+      ret.npages++;
+      ret.nfill += pgsize - nset;
     }
   }
 
@@ -460,6 +448,59 @@ int update_dryrun(const AVRPART *p, UPDATE *upd) {
   return ret;
 }
 
+/*
+ * Read the input file of a -U write or verify operation once beforehand so
+ * that do_op() takes its contents from upd->image, eg, when the same update
+ * is carried out for several targets. Files that an update_dryrun()-checked
+ * -U read or -T command might create are left to be read in turn. Return -1
+ * on error, 0 if the file was left alone and 1 if it was read.
+ */
+int update_preload(const AVRPART *p, UPDATE *upd) {
+  if(upd->cmdline || upd->image || (upd->op != DEVICE_WRITE && upd->op != DEVICE_VERIFY))
+    return 0;
+  if(upd->format != FMT_IMM) {
+    for(int i = 0; i < cx->upd_nfwritten; i++)
+      if(!cx->upd_wrote || str_eq(cx->upd_wrote[i], upd->filename))
+        return 0;
+    for(int i = 0; i < cx->upd_nterms; i++)
+      if(!cx->upd_termcmds || str_contains(cx->upd_termcmds[i], upd->filename) ||
+        str_eq(cx->upd_termcmds[i], "interactive terminal"))
+        return 0;
+  }
+
+  int op = upd->op == DEVICE_WRITE? FIO_READ: FIO_READ_FOR_VERIFY, size;
+  Memimage *img = fileio_new_image();
+
+  if(is_multimem(upd->memstr))
+    size = fileio_image(op, upd->filename, upd->format, p, img);
+  else {
+    AVRMEM *mem = avr_locate_mem(p, upd->memstr);
+
+    if(!mem) {                  // do_op() will skip the update
+      fileio_free_image(img);
+      return 0;
+    }
+    AVRMEM *tmp = avr_dup_mem(mem);
+
+    size = fileio_mem(op, upd->filename, upd->format, p, tmp, -1);
+    for(int i = 0, n; size >= 0 && (i = avr_tag_find(tmp, i, tmp->size, 1)) < tmp->size; i += n) {
+      n = avr_tag_find(tmp, i, tmp->size, 0) - i;
+      fileio_image_put(img, i, tmp->buf + i, n);
+    }
+    avr_free_mem(tmp);
+  }
+
+  if(size < 0) {
+    pmsg_error("reading from file %s failed\n", str_infilename(upd->filename));
+    fileio_free_image(img);
+    return -1;
+  }
+  upd->image = img;
+  upd->imagesize = size;
+
+  return 1;
+}
+
 static int update_avr_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
   const UPDATE *upd, enum updateflags flags, int size, int multiple) {
 
@@ -535,32 +576,63 @@ static int update_avr_write(const PROGRAMMER *pgm, const AVRPART *p, const AVRME
   return rc;                    // Highest memory address written plus 1
 }
 
+/*
+ * Verify mem against the device with checksums computed device-side by
+ * pgm->checksum() over each run of allocated bytes below size; return 1 if
+ * all checksums match and 0 if the programmer has no checksum hook, could not
+ * compute a checksum or if a checksum differs from that of mem->buf
+ */
+static int checksum_verify(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem, int size) {
+  if(!pgm->checksum)
+    return 0;
+
+  if(size > mem->size)
+    size = mem->size;
+  for(int beg = 0, end; (beg = avr_tag_find(mem, beg, size, 1)) < size; beg = end) {
+    end = avr_tag_find(mem, beg, size, 0);
+
+    uint32_t crc;
+
+    if(pgm->checksum(pgm, p, mem, beg, end - beg, &crc) < 0) {
+      pmsg_notice2("no device checksum for %s %s, reading it back\n", mem->desc, str_ccinterval(beg, end - 1));
+      return 0;
+    }
+    if(crc != avr_crc32(0, mem->buf + beg, end - beg)) {
+      pmsg_notice2("device checksum differs for %s %s, reading it back\n", mem->desc, str_ccinterval(beg, end - 1));
+      return 0;
+    }
+  }
+  pmsg_notice2("verified %s with device checksums\n", mem->desc);
+
+  return 1;
+}
+
 static int update_avr_verify(const PROGRAMMER *pgm, const AVRPART *p, const AVRMEM *mem,
   const UPDATE *upd, int size, const char *caption) {
 
   int retval = LIBAVRDUDE_GENERAL_FAILURE, pbar = (mem->size > 32 || verbose > 1) && update_progress;
   Filestats fs;
-  AVRPART *v = avr_dup_part(p);
   const char *m_name = avr_mem_name(p, mem);
 
   if(memstats_mem(p, mem, size, &fs) < 0)
     goto error;
 
   led_set(pgm, LED_VFY);
+  // Device checksums match? Otherwise compare allocated pages with the device as they are read
+  int rc = checksum_verify(pgm, p, mem, size);
+
   if(pbar)
     report_progress(0, 1, caption);
-  int rc = avr_read_mem(pgm, p, mem, v);
+  rc = rc? size: avr_read_verify_mem(pgm, p, mem, size);
 
   report_progress(1, 1, NULL);
-  if(rc < 0) {
-    pmsg_error("unable to read all of %s (rc = %d)\n", m_name, rc);
+  if(rc == LIBAVRDUDE_GENERAL_FAILURE) {
+    pmsg_error("%s verification mismatch\n", mem->desc);
     led_set(pgm, LED_ERR);
     goto error;
   }
-
-  rc = avr_verify_mem(pgm, p, v, mem, size);
   if(rc < 0) {
-    pmsg_error("%s verification mismatch\n", mem->desc);
+    pmsg_error("unable to read all of %s (rc = %d)\n", m_name, rc);
     led_set(pgm, LED_ERR);
     goto error;
   }
@@ -576,11 +648,10 @@ static int update_avr_verify(const PROGRAMMER *pgm, const AVRPART *p, const AVRM
 
 error:
   led_clr(pgm, LED_VFY);
-  avr_free_part(v);
   return retval;
 }
 
-static int update_mem_from_all(const UPDATE *upd, const AVRPART *p, const AVRMEM *m, const AVRMEM *all, int allsize) {
+static int update_mem_from_all(const UPDATE *upd, const AVRPART *p, const AVRMEM *m, const Memimage *all, int allsize) {
 
   const char *m_name = avr_mem_name(p, m);
   int off = fileio_mem_offset(p, m);
@@ -594,28 +665,74 @@ static int update_mem_from_all(const UPDATE *upd, const AVRPART *p, const AVRMEM
 
   if(allsize - off < size)      // Clip to available data in input
     size = allsize > off? allsize - off: 0;
-  if(is_memset(all->tags + off, 0, size)) // Nothing set? This memory was not present
+  if(!fileio_image_get(all, off, size, NULL, 0))    // Nothing set? This memory was not present
     size = 0;
   if(size == 0)
     pmsg_warning("%s has no data for %s, skipping ...\n", str_infilename(upd->filename), m_name);
 
-  memcpy(m->buf, all->buf + off, size);
-  memcpy(m->tags, all->tags + off, size);
+  memset(m->buf, 0xff, size);
+  avr_tag_range(m, 0, size, 0);
+  fileio_image_get(all, off, size, m, 0);
 
   return size;
 }
 
+// Same as memstats_mem() for a multi-memory image, which has a page size of 1
+static int memstats_image(const Memimage *img, int size, Filestats *fsp) {
+  Filestats ret = { 0 };
+
+  ret.lastaddr = -1;
+  for(int i = 0; i < img->n; i++) {
+    const Extent *x = img->ext + i;
+    int end = x->addr + x->len, n = (end < size? end: size) - (int) x->addr;
+
+    if(i == 0)
+      ret.firstaddr = x->addr;
+    ret.lastaddr = end - 1;
+    if(n > 0) {
+      ret.nbytes += n;
+      ret.npages += n;
+      ret.nsections++;
+    } else {
+      n = 0;
+    }
+    ret.ntrailing += x->len - n;
+  }
+
+  if(fsp)
+    *fsp = ret;
+
+  return LIBAVRDUDE_SUCCESS;
+}
+
+// Read the input file into mem or, for multi-memory updates, into the sparse image all
 static int update_all_from_file(const UPDATE *upd, const PROGRAMMER *pgm, const AVRPART *p,
-  const AVRMEM *all, const char *mem_desc, Filestats *fsp) {
+  const AVRMEM *mem, Memimage *all, const char *mem_desc, Filestats *fsp) {
   // On writing to the device trailing 0xff might be cut off
   int op = upd->op == DEVICE_WRITE? FIO_READ: FIO_READ_FOR_VERIFY;
-  int allsize = fileio_mem(op, upd->filename, upd->format, p, all, -1);
+  int allsize;
+
+  if(upd->image) {              // Input file was read beforehand by update_preload()
+    const Memimage *img = upd->image;
+
+    allsize = upd->imagesize;
+    if(all) {
+      for(int i = 0; i < img->n; i++)
+        fileio_image_put(all, img->ext[i].addr, img->ext[i].buf, img->ext[i].len);
+    } else {
+      memset(mem->buf, 0xff, mem->size);
+      avr_tag_range(mem, 0, mem->size, 0);
+      fileio_image_get(img, 0, mem->size, mem, 0);
+    }
+  } else
+    allsize = all? fileio_image(op, upd->filename, upd->format, p, all):
+      fileio_mem(op, upd->filename, upd->format, p, mem, -1);
 
   if(allsize < 0) {
     pmsg_error("reading from file %s failed\n", str_infilename(upd->filename));
     return -1;
   }
-  if(memstats_mem(p, all, allsize, fsp) < 0)
+  if((all? memstats_image(all, allsize, fsp): memstats_mem(p, mem, allsize, fsp)) < 0)
     return -1;
   pmsg_info(upd->op == DEVICE_WRITE?
     "reading %d byte%s for %s from input file %s\n":
@@ -628,8 +745,8 @@ static int update_all_from_file(const UPDATE *upd, const PROGRAMMER *pgm, const
 
 int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updateflags flags) {
   int retval = LIBAVRDUDE_GENERAL_FAILURE, rwvproblem = 0, rwvsoftfail = 0;
-  AVRMEM *mem, **umemlist = NULL, *m;
-  Segment *seglist = NULL;
+  AVRMEM *mem = NULL, **umemlist = NULL, *m;
+  Memimage *all = NULL;
   Filestats fs;
   const char *umstr = upd->memstr;
 
@@ -664,11 +781,10 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
       if((len = strlen(avr_mem_name(p, umemlist[i]))) > maxrlen)
         maxrlen = len;
 
-    seglist = mmt_malloc(ns*sizeof *seglist);
+    all = fileio_new_image();
   }
 
-  mem = umemlist? fileio_any_memory("any"): avr_locate_mem(p, umstr);
-  if(mem == NULL) {
+  if(!umemlist && !(mem = avr_locate_mem(p, umstr))) {
     pmsg_warning("skipping -U %s:... as memory not defined for part %s\n", umstr, p->desc);
     return LIBAVRDUDE_SOFTFAIL;
   }
@@ -706,7 +822,7 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
         imsg_warning("be read by %s; consider using :I :i or :s instead\n", progname);
       }
       pmsg_info("reading %s ...\n", mem_desc);
-      int nn = 0, nbytes = 0;
+      int nbytes = 0;
 
       for(int ii = 0; ii < ns; ii++) {
         m = umemlist[ii];
@@ -730,18 +846,15 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
           continue;
         }
         if(ret > 0) {
-          // Copy individual memory into multi memory
-          memcpy(mem->buf + off, m->buf, ret);
-          seglist[nn].addr = off;
-          seglist[nn].len = ret;
+          // Add individual memory as segment of multi-memory image
+          fileio_image_add(all, off, m->buf, ret);
           nbytes += ret;
-          nn++;
         }
       }
 
       pmsg_info("writing %d byte%s to output file %s\n", nbytes, str_plural(nbytes), str_outfilename(upd->filename));
-      if(nn)
-        rc = fileio_segments(FIO_WRITE, upd->filename, upd->format, p, mem, nn, seglist);
+      if(all->n)
+        rc = fileio_image(FIO_WRITE, upd->filename, upd->format, p, all);
       else
         pmsg_notice("empty memory, resulting file has no contents\n");
       cx->avr_disableffopt = dffo;
@@ -769,7 +882,7 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
 
   case DEVICE_WRITE:
     // Write the selected device memory/ies using data from a file
-    if((allsize = update_all_from_file(upd, pgm, p, mem, mem_desc, &fs)) < 0)
+    if((allsize = update_all_from_file(upd, pgm, p, mem, all, mem_desc, &fs)) < 0)
       goto error;
     if(umemlist) {
       for(int i = 0; i < ns; i++) {
@@ -778,7 +891,7 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
         if(mem_is_readonly(m) || (is_spm(pgm) && (mem_is_in_fuses(m) || mem_is_lock(m))))
           continue;
 
-        int ret, size = update_mem_from_all(upd, p, m, mem, allsize);
+        int ret, size = update_mem_from_all(upd, p, m, all, allsize);
 
         switch(size) {
         case LIBAVRDUDE_GENERAL_FAILURE:
@@ -812,13 +925,13 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
 
   case DEVICE_VERIFY:
     // Verify that the in memory file is the same as what is on the chip
-    if((allsize = update_all_from_file(upd, pgm, p, mem, mem_desc, &fs)) < 0)
+    if((allsize = update_all_from_file(upd, pgm, p, mem, all, mem_desc, &fs)) < 0)
       goto error;
     if(umemlist) {
       for(int i = 0; i < ns; i++) {
         m = umemlist[i];
 
-        int size = update_mem_from_all(upd, p, m, mem, allsize);
+        int size = update_mem_from_all(upd, p, m, all, allsize);
 
         switch(size) {
         case LIBAVRDUDE_GENERAL_FAILURE:
@@ -849,9 +962,8 @@ int do_op(const PROGRAMMER *pgm, const AVRPART *p, const UPDATE *upd, enum updat
 
 error:
   if(umemlist) {
-    avr_free_mem(mem);
+    fileio_free_image(all);
     mmt_free(umemlist);
-    mmt_free(seglist);
   }
   return retval;
 }
@@ -78,11 +78,29 @@ static void updi_physical_close(PROGRAMMER *pgm) {
   pgm->fd.ifd = -1;
 }
 
-static int updi_physical_send(const PROGRAMMER *pgm, unsigned char *buf, size_t len) {
+// Read back and discard the echo of bytes sent with updi_physical_send_deferred()
+static int updi_physical_recv_echo(const PROGRAMMER *pgm) {
+  unsigned char buf[256];
+  size_t len = updi_get_echo_pending(pgm);
+
+  updi_set_echo_pending(pgm, 0);
+  while(len > 0) {
+    size_t n = len > sizeof buf? sizeof buf: len;
+
+    if(serial_recv(&pgm->fd, buf, n) < 0) {
+      pmsg_debug("%s(): missing echo of %lu bytes\n", __func__, (unsigned long) len);
+      return -1;
+    }
+    len -= n;
+  }
+  return 0;
+}
+
+static int updi_physical_xmit(const PROGRAMMER *pgm, unsigned char *buf, size_t len, int defer) {
   size_t i;
   int rv;
 
-  pmsg_debug("sending %lu bytes [", (unsigned long) len);
+  pmsg_debug("sending %lu bytes%s [", (unsigned long) len, defer? " (echo deferred)": "");
   for(i = 0; i < len; i++) {
     msg_debug("0x%02x", buf[i]);
     if(i < len - 1) {
@@ -91,15 +109,42 @@ static int updi_physical_send(const PROGRAMMER *pgm, unsigned char *buf, size_t
   }
   msg_debug("]\n");
 
+  if(!defer && updi_get_echo_pending(pgm) && updi_physical_recv_echo(pgm) < 0) {
+    return -1;
+  }
   rv = serial_send(&pgm->fd, buf, len);
-  serial_recv(&pgm->fd, buf, len);
+  if(!defer) {
+    serial_recv(&pgm->fd, buf, len);
+  } else {
+    // Collect the echo of the previous deferred transfer while this one is on the line
+    if(updi_get_echo_pending(pgm) && updi_physical_recv_echo(pgm) < 0) {
+      return -1;
+    }
+    updi_set_echo_pending(pgm, len);
+  }
   return rv;
 }
 
+static int updi_physical_send(const PROGRAMMER *pgm, unsigned char *buf, size_t len) {
+  return updi_physical_xmit(pgm, buf, len, 0);
+}
+
+/*
+ * Send a transfer that expects no response without waiting for its echo;
+ * the echo is read back during the next transfer so that the host can
+ * prepare more data while the device is still busy with this one
+ */
+static int updi_physical_send_deferred(const PROGRAMMER *pgm, unsigned char *buf, size_t len) {
+  return updi_physical_xmit(pgm, buf, len, 1);
+}
+
 static int updi_physical_recv(const PROGRAMMER *pgm, unsigned char *buf, size_t len) {
   size_t i;
   int rv;
 
+  if(updi_get_echo_pending(pgm) && updi_physical_recv_echo(pgm) < 0) {
+    return -1;
+  }
   rv = serial_recv(&pgm->fd, buf, len);
   if(rv < 0) {
     pmsg_debug("%s(): programmer is not responding\n", __func__);
@@ -142,6 +187,7 @@ static int updi_physical_send_double_break(const PROGRAMMER *pgm) {
   serial_recv(&pgm->fd, buffer, 1);
 
   serial_drain(&pgm->fd, 0);
+  updi_set_echo_pending(pgm, 0);
 
   if(serial_setparams(&pgm->fd, pgm->baudrate? pgm->baudrate: 115200, SERIAL_8E2) < 0) {
     return -1;
@@ -372,6 +418,61 @@ int updi_link_ld_ptr_inc(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t
   return updi_physical_recv(pgm, buffer, size);
 }
 
+int updi_link_ld_bulk(const PROGRAMMER *pgm, uint32_t address, unsigned char *buffer, uint32_t size) {
+/*
+ * Read size bytes from address with one transfer and one response per block
+ * of up to 256 words: the first transfer sets the pointer with RSD on so that
+ * no ACK interrupts it, and each block is then a REPEAT of LD16 from ptr++.
+ * The half-duplex line does not allow queuing the next block before the
+ * device has answered the previous one.
+ */
+  unsigned char send_buffer[3 + 2 + 3 + 3 + 3 + 2], *sp;
+  int addr_size = updi_get_datalink_mode(pgm) == UPDI_LINK_MODE_24BIT? 3: 2;
+
+  pmsg_debug("LD bulk of %u bytes from 0x%06X\n", (unsigned int) size, address);
+  for(uint32_t off = 0; off < size;) {
+    uint32_t n = size - off > UPDI_MAX_REPEAT_SIZE << 1? UPDI_MAX_REPEAT_SIZE << 1: size - off;
+    int words = n > 1;
+    uint32_t count = words? n >> 1: 1;
+
+    n = words? count << 1: 1;
+    sp = send_buffer;
+    if(off == 0) {
+      *sp++ = UPDI_PHY_SYNC;
+      *sp++ = UPDI_STCS | UPDI_CS_CTRLA;
+      *sp++ = 0x0E;
+      *sp++ = UPDI_PHY_SYNC;
+      *sp++ = UPDI_STS | UPDI_ST | UPDI_PTR_ADDRESS | (addr_size == 3? UPDI_DATA_24: UPDI_DATA_16);
+      *sp++ = address & 0xFF;
+      *sp++ = (address >> 8) & 0xFF;
+      if(addr_size == 3) {
+        *sp++ = (address >> 16) & 0xFF;
+      }
+      *sp++ = UPDI_PHY_SYNC;
+      *sp++ = UPDI_STCS | UPDI_CS_CTRLA;
+      *sp++ = 0x06;
+    }
+    if(count > 1) {
+      *sp++ = UPDI_PHY_SYNC;
+      *sp++ = UPDI_REPEAT | UPDI_REPEAT_BYTE;
+      *sp++ = (count - 1) & 0xFF;
+    }
+    *sp++ = UPDI_PHY_SYNC;
+    *sp++ = UPDI_LD | UPDI_PTR_INC | (words? UPDI_DATA_16: UPDI_DATA_8);
+
+    if(updi_physical_send(pgm, send_buffer, sp - send_buffer) < 0) {
+      pmsg_debug("LD bulk send operation failed\n");
+      return -1;
+    }
+    if(updi_physical_recv(pgm, buffer + off, n) < 0) {
+      pmsg_debug("LD bulk recv operation failed at 0x%06X\n", (unsigned int) (address + off));
+      return -1;
+    }
+    off += n;
+  }
+  return size;
+}
+
 int updi_link_ld_ptr_inc16(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words) {
 /*
     def ld_ptr_inc16(self, words):
@@ -626,6 +727,49 @@ int updi_link_st_ptr_inc16_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uin
   return 0;
 }
 
+int updi_link_st_page_RSD(const PROGRAMMER *pgm, uint32_t address, unsigned char *buffer, uint16_t words) {
+/*
+ * Same as st_ptr() followed by st_ptr_inc16_RSD() but as one transfer: RSD
+ * is switched on first so that setting the pointer needs no ACK either, and
+ * the echo is read back only during the next transfer
+ */
+  int addr_size = updi_get_datalink_mode(pgm) == UPDI_LINK_MODE_24BIT? 3: 2;
+  unsigned int temp_buffer_size = 3 + 2 + addr_size + 3 + 2 + (words*2) + 3;
+  unsigned char *temp_buffer = mmt_malloc(temp_buffer_size), *tp = temp_buffer;
+  int rv;
+
+  pmsg_debug("ST16 page to 0x%06X with RSD, data length: 0x%03X\n", address, words*2);
+
+  *tp++ = UPDI_PHY_SYNC;
+  *tp++ = UPDI_STCS | UPDI_CS_CTRLA;
+  *tp++ = 0x0E;
+  *tp++ = UPDI_PHY_SYNC;
+  *tp++ = UPDI_STS | UPDI_ST | UPDI_PTR_ADDRESS | (addr_size == 3? UPDI_DATA_24: UPDI_DATA_16);
+  *tp++ = address & 0xFF;
+  *tp++ = (address >> 8) & 0xFF;
+  if(addr_size == 3) {
+    *tp++ = (address >> 16) & 0xFF;
+  }
+  *tp++ = UPDI_PHY_SYNC;
+  *tp++ = UPDI_REPEAT | UPDI_REPEAT_BYTE;
+  *tp++ = (words - 1) & 0xFF;
+  *tp++ = UPDI_PHY_SYNC;
+  *tp++ = UPDI_ST | UPDI_PTR_INC | UPDI_DATA_16;
+  memcpy(tp, buffer, words*2);
+  tp += words*2;
+  *tp++ = UPDI_PHY_SYNC;
+  *tp++ = UPDI_STCS | UPDI_CS_CTRLA;
+  *tp++ = 0x06;
+
+  rv = updi_physical_send_deferred(pgm, temp_buffer, temp_buffer_size);
+  mmt_free(temp_buffer);
+  if(rv < 0) {
+    pmsg_debug("unable to send page\n");
+    return -1;
+  }
+  return 0;
+}
+
 int updi_link_repeat(const PROGRAMMER *pgm, uint16_t repeats) {
 /*
     def repeat(self, repeats):
@@ -38,9 +38,11 @@ extern "C" {
   int updi_link_stcs(const PROGRAMMER *pgm, uint8_t address, uint8_t value);
   int updi_link_ld_ptr_inc(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t size);
   int updi_link_ld_ptr_inc16(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words);
+  int updi_link_ld_bulk(const PROGRAMMER *pgm, uint32_t address, unsigned char *buffer, uint32_t size);
   int updi_link_st_ptr_inc(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t size);
   int updi_link_st_ptr_inc16(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words);
   int updi_link_st_ptr_inc16_RSD(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t words, int blocksize);
+  int updi_link_st_page_RSD(const PROGRAMMER *pgm, uint32_t address, unsigned char *buffer, uint16_t words);
   int updi_link_repeat(const PROGRAMMER *pgm, uint16_t repeats);
   int updi_link_read_sib(const PROGRAMMER *pgm, unsigned char *buffer, uint16_t size);
   int updi_link_key(const PROGRAMMER *pgm, unsigned char *buffer, uint8_t size_type, uint16_t size);
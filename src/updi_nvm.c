@@ -133,6 +133,22 @@ int updi_nvm_write_flash(const PROGRAMMER *pgm, const AVRPART *p, uint32_t addre
   }
 }
 
+// Write size bytes of flash, a multiple of page_size bar the last page, in one go
+int updi_nvm_write_flash_pages(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
+  unsigned char *buffer, uint32_t size, uint16_t page_size) {
+
+  switch(updi_get_nvm_mode(pgm)) {
+  case UPDI_NVM_MODE_V2:
+    return updi_nvm_write_flash_pages_V2(pgm, p, address, buffer, size, page_size);
+  default:
+    // Variants with a page buffer need to wait for the page write before filling the buffer again
+    for(uint32_t off = 0; off < size; off += page_size)
+      if(updi_nvm_write_flash(pgm, p, address + off, buffer + off, size - off > page_size? page_size: size - off) < 0)
+        return -1;
+    return 0;
+  }
+}
+
 int updi_nvm_write_user_row(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
   unsigned char *buffer, uint16_t size) {
 
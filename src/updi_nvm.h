@@ -37,6 +37,8 @@ extern "C" {
   int updi_nvm_erase_user_row(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address, uint16_t size);
   int updi_nvm_write_flash(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
     unsigned char *buffer, uint16_t size);
+  int updi_nvm_write_flash_pages(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
+    unsigned char *buffer, uint32_t size, uint16_t page_size);
   int updi_nvm_write_user_row(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
     unsigned char *buffer, uint16_t size);
   int updi_nvm_write_boot_row(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
@@ -268,6 +268,45 @@ int updi_nvm_write_flash_V2(const PROGRAMMER *pgm, const AVRPART *p, uint32_t ad
   return nvm_write_V2(pgm, p, address, buffer, size, USE_WORD_ACCESS);
 }
 
+/*
+ * Write consecutive flash pages with one FLASH_WRITE command: this NVM variant
+ * has no page buffer, so the device stalls the UPDI bus while it programs,
+ * and NVM status needs polling only before and after the whole run of pages.
+ * Each page is a single transfer whose echo is read while the next is sent.
+ */
+int updi_nvm_write_flash_pages_V2(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
+  unsigned char *buffer, uint32_t size, uint16_t page_size) {
+
+  int status, rc = 0;
+
+  if(updi_nvm_wait_ready_V2(pgm, p) < 0) {
+    pmsg_error("updi_nvm_wait_ready_V2() failed\n");
+    return -1;
+  }
+  pmsg_debug("NVM write command\n");
+  if(updi_nvm_command_V2(pgm, p, UPDI_V2_NVMCTRL_CTRLA_FLASH_WRITE) < 0) {
+    pmsg_error("flash write command failed\n");
+    return -1;
+  }
+  for(uint32_t off = 0; off < size && rc >= 0; off += page_size) {
+    uint16_t len = size - off > page_size? page_size: size - off;
+
+    if((rc = updi_write_page_words(pgm, address + off, buffer + off, len)) < 0)
+      pmsg_error("write page words operation failed at 0x%06X\n", (unsigned int) (address + off));
+  }
+  status = updi_nvm_wait_ready_V2(pgm, p);
+  pmsg_debug("clear NVM command\n");
+  if(updi_nvm_command_V2(pgm, p, UPDI_V2_NVMCTRL_CTRLA_NOCMD) < 0) {
+    pmsg_error("command buffer erase failed\n");
+    return -1;
+  }
+  if(status < 0) {
+    pmsg_error("updi_nvm_wait_ready_V2() failed\n");
+    return -1;
+  }
+  return rc < 0? -1: 0;
+}
+
 int updi_nvm_write_user_row_V2(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
   unsigned char *buffer, uint16_t size) {
 /*
@@ -38,6 +38,8 @@ extern "C" {
     uint16_t size);
   int updi_nvm_write_flash_V2(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
     unsigned char *buffer, uint16_t size);
+  int updi_nvm_write_flash_pages_V2(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
+    unsigned char *buffer, uint32_t size, uint16_t page_size);
   int updi_nvm_write_user_row_V2(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
     unsigned char *buffer, uint16_t size);
   int updi_nvm_write_boot_row_V2(const PROGRAMMER *pgm, const AVRPART *p, uint32_t address,
@@ -165,6 +165,12 @@ int updi_read_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uin
   return updi_link_ld_ptr_inc(pgm, buffer, size);
 }
 
+// Read any number of bytes with as few serial round trips as possible
+int updi_read_data_bulk(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint32_t size) {
+  pmsg_debug("reading %u bytes in bulk from 0x%06X\n", (unsigned int) size, address);
+  return updi_link_ld_bulk(pgm, address, buffer, size);
+}
+
 int updi_write_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size) {
 /*
     def write_data(self, address, data):
@@ -302,3 +308,12 @@ int updi_write_data_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buff
   }
   return updi_link_st_ptr_inc16_RSD(pgm, buffer, size >> 1, -1);
 }
+
+// Same as updi_write_data_words() but in a single transfer whose echo is checked later
+int updi_write_page_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size) {
+  if(size < 2 || size > UPDI_MAX_REPEAT_SIZE << 1) {
+    pmsg_debug("invalid length\n");
+    return -1;
+  }
+  return updi_link_st_page_RSD(pgm, address, buffer, size >> 1);
+}
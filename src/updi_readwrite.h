@@ -38,9 +38,11 @@ extern "C" {
   int updi_read_byte(const PROGRAMMER *pgm, uint32_t address, uint8_t *value);
   int updi_write_byte(const PROGRAMMER *pgm, uint32_t address, uint8_t value);
   int updi_read_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
+  int updi_read_data_bulk(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint32_t size);
   int updi_write_data(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
   int updi_read_data_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
   int updi_write_data_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
+  int updi_write_page_words(const PROGRAMMER *pgm, uint32_t address, uint8_t *buffer, uint16_t size);
 
 #ifdef __cplusplus
 }
@@ -54,3 +54,11 @@ updi_rts_mode updi_get_rts_mode(const PROGRAMMER *pgm) {
 void updi_set_rts_mode(const PROGRAMMER *pgm, updi_rts_mode mode) {
   ((updi_state *) (pgm->cookie))->rts_mode = mode;
 }
+
+size_t updi_get_echo_pending(const PROGRAMMER *pgm) {
+  return ((updi_state *) (pgm->cookie))->echo_pending;
+}
+
+void updi_set_echo_pending(const PROGRAMMER *pgm, size_t len) {
+  ((updi_state *) (pgm->cookie))->echo_pending = len;
+}
@@ -69,6 +69,7 @@ typedef struct {
   updi_datalink_mode datalink_mode;
   updi_nvm_mode nvm_mode;
   updi_rts_mode rts_mode;
+  size_t echo_pending;          // Bytes sent whose echo has not been read back yet
 } updi_state;
 
 #ifdef __cplusplus
@@ -82,6 +83,8 @@ extern "C" {
   void updi_set_nvm_mode(const PROGRAMMER *pgm, updi_nvm_mode mode);
   updi_rts_mode updi_get_rts_mode(const PROGRAMMER *pgm);
   void updi_set_rts_mode(const PROGRAMMER *pgm, updi_rts_mode mode);
+  size_t updi_get_echo_pending(const PROGRAMMER *pgm);
+  void updi_set_echo_pending(const PROGRAMMER *pgm, size_t len);
 
 #ifdef __cplusplus
 }
@@ -545,12 +545,8 @@ static int urclock_flash_readhook(const PROGRAMMER *pgm, const AVRPART *p, const
   maxsize = ur.pfend+1;
 
   // Compute begin and length of first contiguous block in input
-  for(firstbeg=0; firstbeg < size; firstbeg++)
-    if(flm->tags[firstbeg] & TAG_ALLOCATED)
-      break;
-  for(firstlen=0; firstbeg+firstlen < size; firstlen++)
-    if(!(flm->tags[firstbeg+firstlen] & TAG_ALLOCATED))
-      break;
+  firstbeg = avr_tag_find(flm, 0, size, 1);
+  firstlen = avr_tag_find(flm, firstbeg, size, 0) - firstbeg;
 
   pmsg_notice2("%s %04d.%02d.%02d %02d.%02d meta %d boot %d\n", ur.filename,
     ur.yyyy, ur.mm, ur.dd, ur.hr, ur.mn, nmdata, ur.blend > ur.blstart? ur.blend-ur.blstart+1: 0);
@@ -718,10 +714,10 @@ nopatch:
       *p++ = ur.mcode;          // Save metadata code
 
       // Set tags so metadata get burned onto chip
-      memset(flm->tags + maxsize - nmdata, TAG_ALLOCATED, nmdata);
+      avr_tag_range(flm, maxsize - nmdata, nmdata, 1);
 
       if(ur.initstore)          // Zap the pgm store
-        memset(flm->tags + size, TAG_ALLOCATED, nfree);
+        avr_tag_range(flm, size, nfree, 1);
 
       size = maxsize;
     }
@@ -730,7 +726,7 @@ nopatch:
   // Storing no metadata? Still put a 0xff byte just below bootloader if there is space
   if(size < maxsize && nmdata == 0) {
     flm->buf[ur.pfend] = 0xff;
-    flm->tags[ur.pfend] = TAG_ALLOCATED;
+    avr_tag_set(flm, ur.pfend);
     size = ur.pfend+1;
   }
 
@@ -742,8 +738,8 @@ nopatch_nometa:
     if(ur_readEF(pgm, p, &devmcode, ur.pfend, 1, 'F') == 0) {
       int devnmeta=nmeta(devmcode, ur.uP.flashsize);
       for(int addr=ur.pfend+1-devnmeta; addr < ur.pfend+1; addr++) {
-        if(addr >= 0 && addr < flm->size && !(flm->tags[addr] & TAG_ALLOCATED)) {
-          flm->tags[addr] |= TAG_ALLOCATED;
+        if(addr >= 0 && addr < flm->size && !avr_tag_get(flm, addr)) {
+          avr_tag_set(flm, addr);
           flm->buf[addr] = 0xff;
         }
       }
@@ -752,18 +748,14 @@ nopatch_nometa:
 
   // Emulate chip erase if bootloader unable to: mark all bytes for upload on first -U flash:w:...
   if(ur.emulate_ce) {
-    for(int ai = 0; ai < maxsize; ai++)
-      flm->tags[ai] = TAG_ALLOCATED;
+    avr_tag_range(flm, 0, maxsize, 1);
     ur.emulate_ce = 0;
   }
 
 
   // Ensure that vector bootloaders have correct r/jmp at address 0
   if(ur.boothigh && ur.blstart && ur.vbllevel == 1) {
-    int rc, set=0;
-    for(int i=0; i < vecsz; i++)
-      if(flm->tags[i] & TAG_ALLOCATED)
-        set++;
+    int rc, set = avr_tag_count(flm, 0, vecsz);
 
 
     // Reset vector not programmed? Or -F? Ensure a jmp to bootloader
@@ -782,20 +774,20 @@ nopatch_nometa:
 
           // Mix with already set bytes
           for(int i=0; i < vecsz; i++)
-            if(!(flm->tags[i] & TAG_ALLOCATED))
+            if(!avr_tag_get(flm, i))
               flm->buf[i] = device[i];
         }
 
         if(reset2addr(flm->buf, vecsz, flm->size, &resetdest) < 0 || resetdest != ur.blstart) {
           for(int i=0; i < resetsize; i++) {
             flm->buf[i] = jmptoboot[i];
-            flm->tags[i] |= TAG_ALLOCATED;
+            avr_tag_set(flm, i);
           }
         }
       } else {                  // Flash not readable: patch reset vector unconditionally
         for(int i=0; i < resetsize; i++) {
           flm->buf[i] = jmptoboot[i];
-          flm->tags[i] |= TAG_ALLOCATED;
+          avr_tag_set(flm, i);
         }
       }
     } else if(firstbeg < vecsz) { // Double-check reset vector jumps to bootloader
@@ -826,9 +818,7 @@ nopatch_nometa:
 
       for(addr = 0; addr < maxsize; addr += pgsize) {
         // How many bytes are set in this effective page?
-        for(ai = addr, nset = 0; ai < addr + pgsize; ai++)
-          if(flm->tags[ai] & TAG_ALLOCATED)
-            nset++;
+        nset = avr_tag_count(flm, addr, pgsize);
 
         // Holes in this page that needs writing? read them in from the chip
         if(nset && nset != pgsize) {
@@ -840,15 +830,12 @@ nopatch_nometa:
             end = beg + ur.uP.pagesize;
 
             // Lowest address with unset byte (there might be none)
-            for(ai = beg; ai < end; ai++)
-              if(!(flm->tags[ai] & TAG_ALLOCATED))
-                break;
-            istart = ai;
+            istart = avr_tag_find(flm, beg, end, 0);
 
             if(istart < end) {
               // Highest address with unset byte
               for(ai = end - 1; ai >= istart; ai--)
-                if(!(flm->tags[ai] & TAG_ALLOCATED))
+                if(!avr_tag_get(flm, ai))
                   break;
               isize = ai - istart + 1;
 
@@ -859,8 +846,8 @@ nopatch_nometa:
                 pmsg_debug("padding [0x%04x, 0x%04x]\n", istart, istart+isize-1);
 
                 for(ai = istart; ai < istart + isize; ai++)
-                  if(!(flm->tags[ai] & TAG_ALLOCATED)) {
-                    flm->tags[ai] |= TAG_ALLOCATED;
+                  if(!avr_tag_get(flm, ai)) {
+                    avr_tag_set(flm, ai);
                     flm->buf[ai] = spc[ai-istart];
                   }
               } else {
@@ -879,15 +866,13 @@ nopatch_nometa:
   int ai, addr, nset;
 
   for(addr = 0; addr < maxsize; addr += pgsize) {
-    for(ai = addr, nset = 0; ai < addr + pgsize; ai++)
-      if(flm->tags[ai] & TAG_ALLOCATED)
-        nset++;
+    nset = avr_tag_count(flm, addr, pgsize);
 
     if(nset && nset != pgsize) { // Page has holes: fill them
       pmsg_debug("0xff padding page addr 0x%04d\n", addr);
-      for(ai = addr, nset = 0; ai < addr + pgsize; ai++)
-        if(!(flm->tags[ai] & TAG_ALLOCATED)) {
-          flm->tags[ai] |= TAG_ALLOCATED;
+      for(ai = addr; ai < addr + pgsize; ai++)
+        if(!avr_tag_get(flm, ai)) {
+          avr_tag_set(flm, ai);
           flm->buf[ai] = 0xff;
         }
     }